@@ -0,0 +1,1245 @@
+/*! @file app/bench.cpp
+ *  @brief Times the hot operations of Vec_t, Quat_t, DualQuat_t and
+ *  Matrix_t in scalar and batched form, the interpolation, packing and
+ *  culling kernels, the transform hierarchy, skinning, the render queue
+ *  sort, ray picking, mapped mesh files and mesh import, over several
+ *  data sizes; results, and frame capture round trips, are checked
+ *  against exact references before timing.
+ *
+ *  Usage: bench [-o file] [size...]. Each timing is printed and written
+ *  to the file (bench.tsv by default) as a tab-separated row of group,
+ *  operation, size, ns/op and elements/s, for comparison across builds. */
+
+#include "geometry.hpp"
+#include "quaternion.hpp"
+#include "dual_quaternion.hpp"
+#include "batch.hpp"
+#include "interpolation.hpp"
+#include "packed.hpp"
+#include "hierarchy.hpp"
+#include "skinning.hpp"
+#include "culling.hpp"
+#include "bvh.hpp"
+#include "matrix.hpp"
+#include "mapped.hpp"
+#include "importer.hpp"
+#include "capture.hpp"
+#include "queue.hpp"
+
+///@cond
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+///@endcond
+
+using std::cout;
+using std::endl;
+using std::setw;
+using std::vector;
+
+using namespace Geometry;
+
+static float unit(void) {
+	return float(rand()) / RAND_MAX * 2 - 1;
+}
+
+/* One timing, as written to the results file. */
+struct Row {
+	std::string group, name;
+	std::size_t size;
+	double ns;
+};
+static vector<Row> rows;
+/* Keeps the result of work that is otherwise unused. */
+static volatile double sink;
+static std::string group;
+static std::size_t size;
+
+/** @brief Starts a group of timings, printing its heading. */
+static void heading(const char *name, std::size_t n, const char *unit) {
+	group = name;
+	cout << name << " (" << n << " " << unit << ")" << endl;
+}
+
+/** @brief Runs fn over n elements for at least ~50ms, prints ns/op and
+ * records it under the current group and data size.
+ * @param name The row label
+ * @param n The number of elements per call of fn
+ * @param fn The workload */
+template<typename F>
+static double measure(const char *name, std::size_t n, F const& fn) {
+	using Clock = std::chrono::steady_clock;
+	fn();
+	std::size_t reps = 0;
+	auto t0 = Clock::now(), t1 = t0;
+	do {
+		fn();
+		reps++;
+		t1 = Clock::now();
+	} while(t1 - t0 < std::chrono::milliseconds(50));
+	double ns = std::chrono::duration<double, std::nano>(t1 - t0).count()
+		/ (double(reps) * n);
+	cout << "  " << std::left << setw(36) << name << std::right
+		<< std::fixed << std::setprecision(2) << setw(8) << ns
+		<< " ns/op" << endl;
+	rows.push_back({group, name, size, ns});
+	return ns;
+}
+
+/** @brief The nearest hit of a ray by testing every triangle. */
+static Hit scan(vector<Vec_t<float>> const& v, Ray const& r) {
+	Hit hit;
+	auto const &o = r.origin, &d = r.direction;
+	for(unsigned k = 0; 3*k < v.size(); k++) {
+		auto e1 = v[3*k+1] - v[3*k], e2 = v[3*k+2] - v[3*k];
+		Vec_t<float> p = {d.y*e2.z - d.z*e2.y, d.z*e2.x - d.x*e2.z,
+			d.x*e2.y - d.y*e2.x}, s = o - v[3*k];
+		float det = e1.x*p.x + e1.y*p.y + e1.z*p.z;
+		if(std::abs(det) < 1e-12f) continue;
+		float u = (s.x*p.x + s.y*p.y + s.z*p.z) / det;
+		Vec_t<float> q = {s.y*e1.z - s.z*e1.y, s.z*e1.x - s.x*e1.z,
+			s.x*e1.y - s.y*e1.x};
+		float w = (d.x*q.x + d.y*q.y + d.z*q.z) / det,
+			t = (e2.x*q.x + e2.y*q.y + e2.z*q.z) / det;
+		if(u >= 0 && w >= 0 && u + w <= 1 && t >= 0 && t < hit.t)
+			hit = {k, t, u, w};
+	}
+	return hit;
+}
+
+/** @brief True if the padding of a component past n is still zero. */
+static bool padding_zero(Simd::Array const& a, std::size_t n) {
+	for(std::size_t i = n; i < a.size(); i++)
+		if(a[i] != 0) return false;
+	return true;
+}
+static bool padding_zero(VecBatch const& b) {
+	auto n = b.size();
+	return padding_zero(b.x, n) && padding_zero(b.y, n)
+		&& padding_zero(b.z, n);
+}
+static bool padding_zero(QuatBatch const& b) {
+	auto n = b.size();
+	return padding_zero(b.w, n) && padding_zero(b.x, n)
+		&& padding_zero(b.y, n) && padding_zero(b.z, n);
+}
+static bool padding_zero(DualQuatBatch const& b) {
+	return padding_zero(b.u) && padding_zero(b.v);
+}
+
+/* The elements every group starts from, drawn once per data size. */
+struct Data {
+	std::size_t n;
+	vector<Vec_t<float>> vs;
+	/* Rotations and rigid transforms, and each one's successor. */
+	vector<Quat_t<float>> qs, qe;
+	vector<DualQuat_t<float>> dqs, de;
+	/* Interpolation parameters in [0, 1], padded for the batches. */
+	Simd::Array ts;
+	/* Small triangles around the view of Window::draw. */
+	vector<Vec_t<float>> tris;
+
+	Data(std::size_t n): n(n), vs(n), qs(n), qe(n), dqs(n), de(n),
+			ts(Simd::padded(n)), tris(3*n) {
+		for(std::size_t i = 0; i < n; i++) {
+			vs[i] = {unit(), unit(), unit()};
+			qs[i] = rotation(3.f * unit(), normalize(vs[i]));
+			Quat_t<float> t = {0, unit(), unit(), unit()};
+			dqs[i] = {qs[i], 0.5f * (t * qs[i])};
+			ts[i] = (unit() + 1) / 2;
+		}
+		for(std::size_t i = 0; i < n; i++) {
+			qe[i] = qs[(i + 1) % n];
+			de[i] = dqs[(i + 1) % n];
+		}
+		for(std::size_t i = 0; i < n; i++) {
+			Vec_t<float> c = {12 * unit(), 12 * unit(), 12 * unit()};
+			for(unsigned j = 0; j < 3; j++)
+				tris[3*i+j] = {c.x + unit() / 4, c.y + unit() / 4,
+					c.z + unit() / 4};
+		}
+	}
+};
+
+/** @brief The projection of Window::draw at 16:9. */
+static Matrix_t<float> projection(void) {
+	float asp = 16.f / 9, depth = 1 - 10.f;
+	return {1 / asp, 0, 0, 0, 0, 1, 0, 0,
+		0, 0, 11 / depth, -1, 0, 0, 20 / depth, 0};
+}
+
+/** @brief Checks then times the vector products and normalization.
+ * @return Nonzero if a check failed */
+static int vectors(Data const& d) {
+	auto n = d.n;
+	auto const& vs = d.vs;
+	vector<Vec_t<float>> out(n);
+	VecBatch va(vs.begin(), vs.end()), vb(vs.begin() + 1, vs.end()), vo;
+	Simd::Array fs;
+	unsigned wrong = 0;
+	// Products with the successor, and refined reciprocal roots
+	dot(va, vb, fs);
+	cross(va, vb, vo);
+	if(fs.size() != Simd::padded(n - 1) || !padding_zero(fs, n - 1)
+			|| vo.size() != n - 1 || !padding_zero(vo))
+		wrong++;
+	for(std::size_t i = 0; i + 1 < n; i++)
+		if(!nearZero(fs[i] - dot(vs[i], vs[i+1]))
+				|| !near(vo[i], vs[i] * vs[i+1]))
+			wrong++;
+	magnitude(va, fs);
+	normalize(va, vo);
+	for(std::size_t i = 0; i < n; i++)
+		if(!near(vo[i], normalize(vs[i]), 1 << 18)
+				|| !nearZero(fs[i] - magnitude(vs[i]), 1 << 18))
+			wrong++;
+	if(wrong) {
+		cout << wrong << " vector products differ from the references"
+			<< endl;
+		return 1;
+	}
+
+	heading("Vectors", n, "vectors");
+	vector<float> fv(n);
+	measure("dot(Vec_t, Vec_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			fv[i] = dot(vs[i], out[i]);
+	});
+	measure("cross(Vec_t, Vec_t, Vec_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			out[i] = cross(vs[i], out[i], vs[(i + 1) % n]);
+	});
+	measure("normalize(Vec_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			out[i] = normalize(vs[i]);
+	});
+	measure("dot(VecBatch, VecBatch)", n, [&] { dot(va, vb, fs); });
+	measure("cross(VecBatch, VecBatch)", n, [&] { cross(va, vb, vo); });
+	measure("magnitude(VecBatch)", n, [&] { magnitude(va, fs); });
+	measure("normalize(VecBatch)", n, [&] { normalize(va, vo); });
+	return 0;
+}
+
+/** @brief Checks then times quaternion products and normalization.
+ * @return Nonzero if a check failed */
+static int quaternions(Data const& d) {
+	auto n = d.n;
+	auto const& vs = d.vs;
+	auto const& qs = d.qs;
+	auto const& qe = d.qe;
+	unsigned wrong = 0;
+	// Fused chains against their steps
+	for(std::size_t i = 0; i < n; i++) {
+		auto const &a = qs[i], &b = qe[i];
+		Quat_t<float> ab{a*b}, mid{(a + b)/2.f}, s = a ^ vs[i];
+		if(!near(rotate(ab, vs[i]), rotate(a, rotate(b, vs[i])))
+				|| !near(rotate(Quat_t<float>{a*b*a}, vs[i]),
+					rotate(ab, rotate(a, vs[i])))
+				|| !nearZero(dot(a*b, ab) - 1)
+				|| !near(normalize(a*b), ab)
+				|| !nearZero((a ^ vs[i]).x - s.x)
+				|| !near(mid, Quat_t<float>{(a.w + b.w)/2, (a.x + b.x)/2,
+					(a.y + b.y)/2, (a.z + b.z)/2}))
+			wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " results differ from the operators" << endl;
+		return 1;
+	}
+
+	/* Batched products of unequal sizes, with junk in the padding of the
+	 * shorter input: the results take the shorter size, and their
+	 * padding stays zero. */
+	std::size_t m = n - n / 4;
+	QuatBatch qa(qs.begin(), qs.end()), qz(qe.begin(), qe.end()),
+		bs(qs.begin(), qs.begin() + m), qo;
+	for(std::size_t i = m; i < bs.w.size(); i++) bs.w[i] = 1;
+	multiply(qa, bs, qo);
+	if(qo.size() != m || !padding_zero(qo)) wrong++;
+	for(std::size_t i = 0; i < m; i++)
+		if(!near(qo[i], Quat_t<float>{qs[i] * qs[i]})) wrong++;
+	conjugate(bs, qo);
+	normalize(qa, qa);
+	if(!padding_zero(qo) || !padding_zero(qa)) wrong++;
+	for(std::size_t i = 0; i < n; i++)
+		if((i < m && !(qo[i] == Quat_t<float>{*qs[i]}))
+				|| !near(qa[i], normalize(qs[i]), 1 << 16))
+			wrong++;
+	if(wrong) {
+		cout << wrong << " batched products differ from the operators"
+			<< endl;
+		return 1;
+	}
+
+	// Renormalization of every third entry
+	vector<Quat_t<float>> qd(qs);
+	for(std::size_t i = 0; i < n; i += 3)
+		qd[i] = {qd[i].w * 1.001f, qd[i].x * 1.001f,
+			qd[i].y * 1.001f, qd[i].z * 1.001f};
+	QuatBatch qn(qd.begin(), qd.end());
+	std::size_t drifted = (n + 2) / 3;
+	if(renormalize(qn) != drifted || renormalize(qd.data(), n) != drifted
+			|| renormalize(qn))
+		wrong++;
+	for(std::size_t i = 0; i < n; i++) {
+		if(!near(qn[i], qs[i], 1 << 16) || !near(qd[i], qs[i], 1 << 16))
+			wrong++;
+		// Entries within tolerance are left exactly as they were
+		if(i % 3 && !(qn[i] == qs[i])) wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " normalized values differ from the references"
+			<< endl;
+		return 1;
+	}
+
+	heading("Quaternions", n, "products");
+	vector<Quat_t<float>> qm(n);
+	measure("operator*(Quat_t, Quat_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			qm[i] = qs[i] * qe[i];
+	});
+	measure("normalize(Quat_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			qm[i] = normalize(qs[i]);
+	});
+	measure("multiply(QuatBatch, QuatBatch)", n,
+		[&] { multiply(qa, qz, qo); });
+	measure("normalize(QuatBatch)", n, [&] { normalize(qa, qo); });
+	measure("conjugate(QuatBatch)", n, [&] { conjugate(qa, qo); });
+	measure("renormalize(QuatBatch), settled", n,
+		[&] { renormalize(qn); });
+	return 0;
+}
+
+/** @brief Checks then times dual quaternion products and normalization.
+ * @return Nonzero if a check failed */
+static int dual_quaternions(Data const& d) {
+	auto n = d.n;
+	auto const& vs = d.vs;
+	auto const& dqs = d.dqs;
+	auto const& de = d.de;
+	unsigned wrong = 0;
+	// The sandwich of a point, and fused chains against their steps
+	for(std::size_t i = 0; i < n; i++) {
+		DualQuat_t<float> p = {1._r, {0, vs[i].x, vs[i].y, vs[i].z}},
+			s = dqs[i] * p * DualQuat_t<float>{*dqs[i].u, -*dqs[i].v},
+			sd{dqs[i] * de[i]};
+		if(!near(transform(dqs[i], vs[i]),
+				Vec_t<float>{s.v.x, s.v.y, s.v.z})
+				|| !near(transform(sd, vs[i]),
+					transform(dqs[i], transform(de[i], vs[i]))))
+			wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " results differ from the operators" << endl;
+		return 1;
+	}
+
+	std::size_t m = n - n / 4;
+	DualQuatBatch da(dqs.begin(), dqs.end()), dz(de.begin(), de.end()),
+		bs(de.begin(), de.begin() + m), dout;
+	for(std::size_t i = m; i < bs.u.w.size(); i++) bs.v.x[i] = 1;
+	multiply(da, bs, dout);
+	if(dout.size() != m || !padding_zero(dout)) wrong++;
+	for(std::size_t i = 0; i < m; i++) {
+		DualQuat_t<float> ref{dqs[i] * de[i]};
+		if(!near(dout[i].u, ref.u) || !near(dout[i].v, ref.v)) wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " batched products differ from the operators"
+			<< endl;
+		return 1;
+	}
+
+	// Renormalization of every third entry
+	vector<DualQuat_t<float>> dd(dqs);
+	for(std::size_t i = 0; i < n; i += 3) {
+		auto &u = dd[i].u;
+		u = {u.w * 1.001f, u.x * 1.001f, u.y * 1.001f, u.z * 1.001f};
+		dd[i].v.w += 0.001f;
+	}
+	DualQuatBatch dn(dd.begin(), dd.end());
+	std::size_t drifted = (n + 2) / 3;
+	if(renormalize(dn) != drifted || renormalize(dd.data(), n) != drifted
+			|| renormalize(dd.data(), n))
+		wrong++;
+	for(std::size_t i = 0; i < n; i++) {
+		auto const &a = dn[i], &b = dd[i];
+		if(std::abs(dot(a.u, a.v)) > 1e-5f || std::abs(dot(b.u, b.v)) > 1e-5f
+				|| !near(a.u, dqs[i].u, 1 << 16) || !near(b.v, a.v, 1 << 16))
+			wrong++;
+		// Entries within tolerance are left exactly as they were
+		if(i % 3 && !(dd[i].v == dqs[i].v)) wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " normalized values differ from the references"
+			<< endl;
+		return 1;
+	}
+
+	heading("Dual quaternions", n, "products");
+	vector<DualQuat_t<float>> dm(n);
+	measure("operator*(DualQuat_t, DualQuat_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			dm[i] = dqs[i] * de[i];
+	});
+	measure("multiply(DualQuatBatch x2)", n,
+		[&] { multiply(da, dz, dout); });
+	measure("renormalize(DualQuatBatch), settled", n,
+		[&] { renormalize(dn); });
+	measure("renormalize(DualQuat_t*), settled", n,
+		[&] { renormalize(dd.data(), n); });
+	measure("renormalize(DualQuat_t*), drifted", n, [&] {
+		for(std::size_t i = 0; i < n; i += 3) dd[i].u.w *= 1.001f;
+		renormalize(dd.data(), n);
+	});
+	return 0;
+}
+
+/** @brief Checks then times matrix products, inverses and transforms.
+ * @return Nonzero if a check failed */
+static int matrices(Data const& d) {
+	auto n = d.n;
+	auto const& vs = d.vs;
+	vector<Vec_t<float>> out(n);
+	vector<Matrix_t<float>> ms(n), mn(n), mo(n);
+	for(std::size_t i = 0; i < n; i++)
+		for(unsigned j = 0; j < 16; j++) ms[i][j] = unit();
+	for(std::size_t i = 0; i < n; i++) mn[i] = ms[(i + 1) % n];
+	unsigned wrong = 0;
+	// Random matrices are projective, where the general inverse's upper
+	// 3x3 is no inverse of the upper 3x3
+	for(std::size_t i = 0; i < n; i++) {
+		Transform_t<float> cached(ms[i]);
+		cached.inverse();
+		if(!(cached.normal() == ms[i].normal())) wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " cached normal matrices differ" << endl;
+		return 1;
+	}
+	// Bulk products and transforms against the generic forms
+	product(ms.data(), mn.data(), mo.data(), n);
+	for(std::size_t i = 0; i < n; i++) {
+		auto ref = product<float, float>(ms[i], mn[i]);
+		for(unsigned j = 0; j < 16; j++)
+			if(!nearZero(mo[i][j] - ref[j])) wrong++;
+	}
+	VecBatch vb(vs.begin(), vs.end()), ob;
+	transform(ms[0], vs.data(), out.data(), n);
+	transform(ms[0], vb, ob);
+	if(!padding_zero(ob)) wrong++;
+	for(std::size_t i = 0; i < n; i++) {
+		auto ref = vs[i] * ms[0];
+		if(!near(out[i], ref) || !near(ob[i], ref)) wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " bulk products differ from the references"
+			<< endl;
+		return 1;
+	}
+
+	heading("Matrices", n, "elements");
+	measure("product<float>(Matrix_t, Matrix_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			mo[i] = product<float, float>(ms[i], mn[i]);
+	});
+	measure("product(Matrix_t, Matrix_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			mo[i] = product(ms[i], mn[i]);
+	});
+	measure("product(Matrix_t*, Matrix_t*)", n,
+		[&] { product(ms.data(), mn.data(), mo.data(), n); });
+	measure("Matrix_t::inverse", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			mo[i] = ms[i].inverse();
+	});
+	measure("operator*(Vec_t, Matrix_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			out[i] = vs[i] * ms[0];
+	});
+	measure("transform(Matrix_t, Vec_t*)", n,
+		[&] { transform(ms[0], vs.data(), out.data(), n); });
+	Simd::Array hv(Simd::padded(4 * n)), ho(Simd::padded(4 * n));
+	for(std::size_t i = 0; i < 4 * n; i++) hv[i] = unit();
+	measure("transform(Matrix_t, float*)", n,
+		[&] { transform(ms[0], hv.data(), ho.data(), n); });
+	measure("transform(Matrix_t, VecBatch)", n,
+		[&] { transform(ms[0], vb, ob); });
+	return 0;
+}
+
+/** @brief Checks then times the rotation of vectors.
+ * @return Nonzero if a check failed */
+static int rotations(Data const& d) {
+	auto n = d.n;
+	auto const& vs = d.vs;
+	auto const& qs = d.qs;
+	vector<Vec_t<float>> out(n);
+	unsigned wrong = 0;
+	for(std::size_t i = 0; i < n; i++) {
+		Quat_t<float> s = qs[i] ^ vs[i];
+		if(!near(rotate(qs[i], vs[i]), Vec_t<float>{s.x, s.y, s.z}))
+			wrong++;
+	}
+	// Batches of unequal sizes, with junk in the padding of the shorter
+	std::size_t m = n - n / 4;
+	QuatBatch qb(qs.begin(), qs.end());
+	VecBatch vb(vs.begin(), vs.end()), bw(vs.begin(), vs.begin() + m),
+		bx, by, ob;
+	for(std::size_t i = m; i < bw.x.size(); i++) bw.x[i] = 1;
+	sandwich(qb, bw, bx);
+	rotate(qb, bw, by);
+	if(bx.size() != m || by.size() != m
+			|| !padding_zero(bx) || !padding_zero(by))
+		wrong++;
+	for(std::size_t i = 0; i < m; i++) {
+		Quat_t<float> s = qs[i] ^ vs[i];
+		if(!near(bx[i], Vec_t<float>{s.x, s.y, s.z})
+				|| !near(by[i], rotate(qs[i], vs[i])))
+			wrong++;
+	}
+	sandwich(qs[0], vb, bx);
+	rotate(qs[0], vb, by);
+	if(!padding_zero(bx) || !padding_zero(by)) wrong++;
+	for(std::size_t i = 0; i < n; i++)
+		if(!near(bx[i], by[i]) || !near(by[i], rotate(qs[0], vs[i])))
+			wrong++;
+	if(wrong) {
+		cout << wrong << " rotations differ from the operators" << endl;
+		return 1;
+	}
+
+	heading("Rotation", n, "vectors");
+	measure("operator^(Quat_t, Vec_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++) {
+			Quat_t<float> s = qs[i] ^ vs[i];
+			out[i] = {s.x, s.y, s.z};
+		}
+	});
+	measure("rotate(Quat_t, Vec_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			out[i] = rotate(qs[i], vs[i]);
+	});
+	measure("sandwich(QuatBatch, VecBatch)", n,
+		[&] { sandwich(qb, vb, ob); });
+	measure("rotate(QuatBatch, VecBatch)", n,
+		[&] { rotate(qb, vb, ob); });
+	measure("sandwich(Quat_t, VecBatch)", n,
+		[&] { sandwich(qs[0], vb, ob); });
+	measure("rotate(Quat_t, VecBatch)", n,
+		[&] { rotate(qs[0], vb, ob); });
+	return 0;
+}
+
+/** @brief Checks then times rigid transforms of points, and skinning.
+ * @return Nonzero if a check failed */
+static int rigid(Data const& d) {
+	auto n = d.n;
+	auto const& vs = d.vs;
+	auto const& dqs = d.dqs;
+	vector<Vec_t<float>> out(n);
+	unsigned wrong = 0;
+	// Batched rigid transforms against the scalar form, padding included
+	QuatBatch ub(n), db(n);
+	for(std::size_t i = 0; i < n; i++) {
+		ub.set(i, dqs[i].u);
+		db.set(i, dqs[i].v);
+	}
+	VecBatch vb(vs.begin(), vs.end()), ob, oc;
+	transform(ub, db, vb, ob);
+	transform(dqs[0], vb, oc);
+	if(!padding_zero(ob) || !padding_zero(oc)) wrong++;
+	for(std::size_t i = 0; i < n; i++)
+		if(!near(ob[i], transform(dqs[i], vs[i]))
+				|| !near(oc[i], transform(dqs[0], vs[i])))
+			wrong++;
+	if(wrong) {
+		cout << wrong << " batched transforms differ from transform()"
+			<< endl;
+		return 1;
+	}
+
+	// Skinning against the scalar blend of the same bones, half of them
+	// negated so that alignment to the first influence matters
+	vector<DualQuat_t<float>> bones(dqs);
+	for(std::size_t i = 0; i < n; i++)
+		bones.push_back({-dqs[i].u, -dqs[i].v});
+	Model::Skin skin(n);
+	vector<DualQuat_t<float>> blends(n);
+	for(std::size_t i = 0; i < n; i++) {
+		unsigned b[4], count = 1 + i % 4;
+		float w[4];
+		DualQuat_t<float> acc = {0._r, 0._r};
+		for(unsigned k = 0; k < count; k++) {
+			b[k] = unsigned(k ? rand() % (2 * n) : i);
+			w[k] = .25f + unit() * unit();
+			auto const &q = bones[b[k]];
+			float s = dot(bones[b[0]].u, q.u) < 0 ? -w[k] : w[k];
+			acc = {acc.u + s * q.u, acc.v + s * q.v};
+		}
+		float len = acc.u.magnitude();
+		blends[i] = {acc.u / len, acc.v / len};
+		skin.set(i, vs[i], normalize(vs[(i + 1) % n]), b, w, count);
+	}
+	VecBatch skinned, skinned_normals;
+	Model::skin(skin, bones.data(), skinned, skinned_normals);
+	for(std::size_t i = 0; i < n; i++)
+		if(!near(skinned[i], transform(blends[i], vs[i]), 1 << 16)
+				|| !near(skinned_normals[i], transform(DualQuat_t<float>{
+					blends[i].u, 0._r}, normalize(vs[(i + 1) % n])), 1 << 16))
+			wrong++;
+	if(wrong) {
+		cout << wrong << " skinned vertices differ from transform()" << endl;
+		return 1;
+	}
+
+	heading("Rigid transform", n, "points");
+	measure("operator^(DualQuat_t, DualQuat_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++) {
+			DualQuat_t<float> p = {1._r, {0, vs[i].x, vs[i].y, vs[i].z}},
+				s = dqs[i] ^ p;
+			out[i] = {s.v.x, s.v.y, s.v.z};
+		}
+	});
+	measure("transform(DualQuat_t, Vec_t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			out[i] = transform(dqs[i], vs[i]);
+	});
+	measure("transform(QuatBatch x2, VecBatch)", n,
+		[&] { transform(ub, db, vb, ob); });
+	measure("transform(DualQuat_t, VecBatch)", n,
+		[&] { transform(dqs[0], vb, ob); });
+	measure("skin(Skin, DualQuat_t*), 1-4 bones", n,
+		[&] { Model::skin(skin, bones.data(), skinned, skinned_normals); });
+	return 0;
+}
+
+/** @brief Checks then times interpolation between consecutive elements,
+ * against scalar forms evaluated in double; the tolerance of slerp_fast
+ * is its bound.
+ * @return Nonzero if a check failed */
+static int interpolation(Data const& d) {
+	auto n = d.n;
+	auto const& qs = d.qs;
+	auto const& qe = d.qe;
+	auto const& dqs = d.dqs;
+	auto const& de = d.de;
+	auto const& ts = d.ts;
+	QuatBatch qa(qs.begin(), qs.end()), qz(qe.begin(), qe.end()), qo(n);
+	DualQuatBatch da(dqs.begin(), dqs.end()), dz(de.begin(), de.end()),
+		dout(n);
+	unsigned wrong = 0;
+	nlerp(qa, qz, ts, qo);
+	if(!padding_zero(qo)) wrong++;
+	for(std::size_t i = 0; i < n; i++) {
+		Quat_t<double> l, r;
+		l = qs[i]; r = qe[i];
+		if(!near(qo[i], nlerp(l, r, ts[i]), 1 << 16)) wrong++;
+	}
+	slerp(qa, qz, ts, qo);
+	if(!padding_zero(qo)) wrong++;
+	for(std::size_t i = 0; i < n; i++) {
+		Quat_t<double> l, r;
+		l = qs[i]; r = qe[i];
+		auto ref = slerp(l, r, ts[i]);
+		if(!near(qo[i], ref, 1 << 16)) wrong++;
+		if(!near(slerp_fast(qs[i], qe[i], ts[i]), ref, 2000)) wrong++;
+	}
+	slerp_fast(qa, qz, ts, qo);
+	if(!padding_zero(qo)) wrong++;
+	for(std::size_t i = 0; i < n; i++) {
+		Quat_t<double> l, r;
+		l = qs[i]; r = qe[i];
+		if(!near(qo[i], slerp(l, r, ts[i]), 2000)) wrong++;
+	}
+	sclerp(da, dz, ts, dout);
+	if(!padding_zero(dout)) wrong++;
+	for(std::size_t i = 0; i < n; i++) {
+		DualQuat_t<double> l, r, ref;
+		l = dqs[i]; r = de[i];
+		ref = sclerp(l, r, ts[i]);
+		if(!near(dout[i].u, ref.u, 1 << 16)
+				|| !near(dout[i].v, ref.v, 1 << 16))
+			wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " interpolants differ from the references" << endl;
+		return 1;
+	}
+
+	heading("Interpolation", n, "pairs");
+	vector<Quat_t<float>> qi(n);
+	vector<DualQuat_t<float>> di(n);
+	measure("slerp(Quat_t x2, t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			qi[i] = slerp(qs[i], qe[i], ts[i]);
+	});
+	measure("slerp_fast(Quat_t x2, t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			qi[i] = slerp_fast(qs[i], qe[i], ts[i]);
+	});
+	measure("sclerp(DualQuat_t x2, t)", n, [&] {
+		for(std::size_t i = 0; i < n; i++)
+			di[i] = sclerp(dqs[i], de[i], ts[i]);
+	});
+	measure("nlerp(QuatBatch x2, t)", n,
+		[&] { nlerp(qa, qz, ts, qo); });
+	measure("slerp(QuatBatch x2, t)", n,
+		[&] { slerp(qa, qz, ts, qo); });
+	measure("slerp_fast(QuatBatch x2, t)", n,
+		[&] { slerp_fast(qa, qz, ts, qo); });
+	measure("sclerp(DualQuatBatch x2, t)", n,
+		[&] { sclerp(da, dz, ts, dout); });
+	return 0;
+}
+
+/** @brief Checks then times round trips through packed storage, within
+ * the documented bounds.
+ * @return Nonzero if a check failed */
+static int packing(Data const& d) {
+	auto n = d.n;
+	auto const& vs = d.vs;
+	auto const& qs = d.qs;
+	auto const& dqs = d.dqs;
+	vector<Quat32> q32(n);
+	vector<Quat48> q48(n);
+	vector<DualQuat96> d96(n);
+	vector<Quat_t<float>> qp(n);
+	vector<DualQuat_t<float>> dp(n);
+	float step = translation_step(dqs.data(), n);
+	unsigned wrong = 0;
+	encode(qs.data(), q32.data(), n);
+	decode(q32.data(), qp.data(), n);
+	for(std::size_t i = 0; i < n; i++)
+		if(!near(qp[i], qs[i], 400) && !near(qp[i], -qs[i], 400)) wrong++;
+	encode(qs.data(), q48.data(), n);
+	decode(q48.data(), qp.data(), n);
+	for(std::size_t i = 0; i < n; i++)
+		if(!near(qp[i], qs[i], 1 << 13) && !near(qp[i], -qs[i], 1 << 13))
+			wrong++;
+	encode(dqs.data(), d96.data(), n, step);
+	decode(d96.data(), dp.data(), n, step);
+	for(std::size_t i = 0; i < n; i++)
+		if(!near(transform(dp[i], vs[i]), transform(dqs[i], vs[i]), 1000))
+			wrong++;
+	if(wrong) {
+		cout << wrong << " round trips exceed their bounds" << endl;
+		return 1;
+	}
+
+	heading("Packed storage", n, "elements");
+	measure("encode(Quat_t, Quat32)", n,
+		[&] { encode(qs.data(), q32.data(), n); });
+	measure("decode(Quat32, Quat_t)", n,
+		[&] { decode(q32.data(), qp.data(), n); });
+	measure("encode(Quat_t, Quat48)", n,
+		[&] { encode(qs.data(), q48.data(), n); });
+	measure("decode(Quat48, Quat_t)", n,
+		[&] { decode(q48.data(), qp.data(), n); });
+	measure("encode(DualQuat_t, DualQuat96)", n,
+		[&] { encode(dqs.data(), d96.data(), n, step); });
+	measure("decode(DualQuat96, DualQuat_t)", n,
+		[&] { decode(d96.data(), dp.data(), n, step); });
+	return 0;
+}
+
+/** @brief Checks a random forest against composing every path from the
+ * root, then times its updates.
+ * @return Nonzero if a check failed */
+static int hierarchy(Data const& d) {
+	auto n = d.n;
+	auto const& dqs = d.dqs;
+	Model::Hierarchy tree;
+	vector<unsigned> up(n);
+	vector<DualQuat_t<float>> dp(n);
+	for(std::size_t i = 0; i < n; i++) {
+		up[i] = i && rand() % 16 ? unsigned(rand() % i) : tree.none;
+		tree.add(dqs[i], up[i]);
+	}
+	tree.update();
+	for(std::size_t i = 0; i < n / 64; i++)
+		tree.set(unsigned(rand() % n), dqs[rand() % n]);
+	tree.update();
+	unsigned wrong = 0;
+	for(std::size_t i = 0; i < n; i++) {
+		if(up[i] == tree.none) dp[i] = tree.local(i);
+		else dp[i] = dp[up[i]] * tree.local(i);
+		if(!near(tree.world(i).u, dp[i].u, 1 << 14)
+				|| !near(tree.world(i).v, dp[i].v, 1 << 14))
+			wrong++;
+	}
+	if(wrong) {
+		cout << wrong << " world transforms differ from the paths" << endl;
+		return 1;
+	}
+
+	heading("Hierarchy", n, "nodes, per node set");
+	measure("Hierarchy::update, all set", n, [&] {
+		for(unsigned i = 0; i < n; i++) tree.set(i, tree.local(i));
+		tree.update();
+	});
+	// Late nodes of a random forest have the small subtrees of most nodes
+	measure("Hierarchy::update, 16 set", 16, [&] {
+		for(unsigned i = 0; i < 16; i++) {
+			unsigned j = unsigned(n - 1 - i * 7919 % (n / 2 + 1));
+			tree.set(j, tree.local(j));
+		}
+		tree.update();
+	});
+	return 0;
+}
+
+/** @brief Checks then times culling against the view of Window::draw,
+ * over a scene around it.
+ * @return Nonzero if a check failed */
+static int culling(Data const& d) {
+	auto n = d.n;
+	Frustum view(projection());
+	VecBatch centers(n), lo(n), hi(n);
+	Simd::Array radii(Simd::padded(n));
+	for(std::size_t i = 0; i < n; i++) {
+		Vec_t<float> c = {12 * unit(), 12 * unit(), 12 * unit()},
+			e = {unit() + 1, unit() + 1, unit() + 1};
+		centers.set(i, c);
+		radii[i] = (unit() + 1) / 2;
+		lo.set(i, {c.x - e.x, c.y - e.y, c.z - e.z});
+		hi.set(i, {c.x + e.x, c.y + e.y, c.z + e.z});
+	}
+	vector<unsigned> seen(n);
+	unsigned wrong = 0;
+	std::size_t count = cull(view, centers, radii, seen.data()), k = 0;
+	for(std::size_t i = 0; i < n; i++)
+		if(view.visible(centers[i], radii[i]))
+			if(k >= count || seen[k++] != i) wrong++;
+	if(k != count) wrong++;
+	count = cull(view, lo, hi, seen.data());
+	k = 0;
+	for(std::size_t i = 0; i < n; i++)
+		if(view.visible(lo[i], hi[i]))
+			if(k >= count || seen[k++] != i) wrong++;
+	if(k != count) wrong++;
+	if(wrong) {
+		cout << wrong << " culled indices differ from the scalar tests"
+			<< endl;
+		return 1;
+	}
+
+	heading("Culling", n, "volumes");
+	measure("Frustum::visible(sphere)", n, [&] {
+		std::size_t k = 0;
+		for(std::size_t i = 0; i < n; i++)
+			if(view.visible(centers[i], radii[i])) seen[k++] = unsigned(i);
+	});
+	measure("cull(Frustum, spheres)", n,
+		[&] { cull(view, centers, radii, seen.data()); });
+	measure("Frustum::visible(box)", n, [&] {
+		std::size_t k = 0;
+		for(std::size_t i = 0; i < n; i++)
+			if(view.visible(lo[i], hi[i])) seen[k++] = unsigned(i);
+	});
+	measure("cull(Frustum, boxes)", n,
+		[&] { cull(view, lo, hi, seen.data()); });
+	return 0;
+}
+
+/* Exposes the sort of the render queue, which submit only issues. */
+struct Sorter: View::RenderQueue {
+	using RenderQueue::sort;
+	/** @brief The keys and item indices in their current order. */
+	vector<std::pair<std::uint64_t, std::uint32_t>> order(void) const {
+		vector<std::pair<std::uint64_t, std::uint32_t>> out;
+		for(auto const& e : m_order) out.push_back({e.key, e.index});
+		return out;
+	}
+};
+
+/** @brief Checks the order of the render queue against a stable sort of
+ * the same keys, over few states as in a scene, with depths out of range
+ * or at 1 and names wider than their bits, then times both.
+ * @return Nonzero if a check failed */
+static int render_queue(Data const& d) {
+	using View::RenderQueue;
+	using gl::GLuint;
+	auto n = d.n;
+	vector<RenderQueue::Item> items(n);
+	vector<std::pair<std::uint64_t, std::uint32_t>> keys(n);
+	Sorter queue;
+	unsigned wrong = 0;
+	for(std::size_t i = 0; i < n; i++) {
+		auto &item = items[i];
+		item.program = GLuint(1 + rand() % 4);
+		item.vao = GLuint(1 + rand() % 16);
+		item.material = unsigned(rand() % 64);
+		item.depth = i % 7 ? (unit() + 1) / 2 : i % 14 ? 1.f : 1.5f * unit();
+		// Only the low bits of wider names are in the key
+		auto masked = item;
+		if(!(i % 5)) {
+			item.program += GLuint(1 + rand() % 4) << queue.program_bits;
+			item.vao += GLuint(1 + rand() % 4) << queue.vao_bits;
+			item.material += unsigned(1 + rand() % 4) << queue.material_bits;
+		}
+		auto level = item;
+		level.depth = 0;
+		auto key = queue.key(item);
+		unsigned bits = queue.depth_bits;
+		if(key != queue.key(masked)
+				|| key >> bits != queue.key(level) >> bits)
+			wrong++;
+		keys[i] = {key, std::uint32_t(i)};
+		queue.push(item);
+	}
+	auto first = [] (std::pair<std::uint64_t, std::uint32_t> const& l,
+			std::pair<std::uint64_t, std::uint32_t> const& r) {
+		return l.first < r.first;
+	};
+	auto sorted = keys;
+	std::stable_sort(sorted.begin(), sorted.end(), first);
+	queue.sort();
+	if(wrong || queue.order() != sorted) {
+		cout << wrong << " queued keys differ from a stable sort" << endl;
+		return 1;
+	}
+
+	heading("Render queue", n, "draws");
+	measure("RenderQueue::push", n, [&] {
+		queue.clear();
+		for(auto const& item : items) queue.push(item);
+	});
+	measure("RenderQueue::sort", n, [&] { queue.sort(); });
+	measure("std::stable_sort of the keys", n, [&] {
+		sorted = keys;
+		std::stable_sort(sorted.begin(), sorted.end(), first);
+	});
+	return 0;
+}
+
+/** @brief Checks then times picking of the triangles through a pixel
+ * grid of the view.
+ * @return Nonzero if a check failed */
+static int picking(Data const& d) {
+	auto n = d.n;
+	auto tris = d.tris;
+	Bvh bvh(tris.data(), n);
+	auto unview = projection().inverse();
+	unsigned side = 64;
+	vector<Ray> rays;
+	for(unsigned j = 0; j < side; j++)
+		for(unsigned i = 0; i < side; i++)
+			rays.push_back(unproject(unview, (2 * i + 1.f) / side - 1,
+				1 - (2 * j + 1.f) / side));
+	vector<Hit> hits(rays.size());
+	auto same = [] (Hit const& l, Hit const& r) {
+		return bool(l) == bool(r) && (!l || l.triangle == r.triangle
+			|| std::abs(l.t - r.t) <= 1e-4f * r.t);
+	};
+	unsigned wrong = 0, found = 0;
+	for(unsigned pass = 0; pass < 2; pass++) {
+		bvh.intersect(rays.data(), hits.data(), rays.size());
+		// A sample of rays, as the scan is quadratic in the data size
+		for(std::size_t i = 0; i < rays.size(); i += 1 + n / 4096) {
+			auto ref = scan(tris, rays[i]);
+			found += bool(ref);
+			if(!same(bvh.intersect(rays[i]), ref) || !same(hits[i], ref))
+				wrong++;
+		}
+		// Move every triangle and check again through the refit tree
+		for(auto &v : tris) v = {v.x + unit() / 8, v.y, v.z - unit() / 8};
+		bvh.refit(tris.data());
+	}
+	if(wrong || !found) {
+		cout << wrong << " picks differ from the linear scan" << endl;
+		return 1;
+	}
+	// Points at infinity, where w is 0, unproject to rays that miss
+	auto unseen = unview;
+	for(unsigned j = 0; j < 4; j++) unseen[4*j+3] = 0;
+	auto lost = unproject(unseen, .25f, -.5f);
+	Hit lost_hit;
+	bvh.intersect(&lost, &lost_hit, 1);
+	for(auto c : {lost.origin.x, lost.origin.y, lost.origin.z,
+			lost.direction.x, lost.direction.y, lost.direction.z})
+		if(!std::isfinite(c)) wrong++;
+	if(wrong || lost_hit || bvh.intersect(lost)) {
+		cout << "A ray through infinity was not a miss" << endl;
+		return 1;
+	}
+
+	heading("Picking", n, "triangles, per ray");
+	measure("Bvh::build", n, [&] { bvh.build(tris.data(), n); });
+	measure("Bvh::refit", n, [&] { bvh.refit(tris.data()); });
+	measure("Bvh::intersect(Ray)", rays.size(), [&] {
+		for(std::size_t i = 0; i < rays.size(); i++)
+			hits[i] = bvh.intersect(rays[i]);
+	});
+	measure("Bvh::intersect(Ray, n)", rays.size(),
+		[&] { bvh.intersect(rays.data(), hits.data(), rays.size()); });
+	measure("linear scan", 16, [&] {
+		for(std::size_t i = 0; i < 16; i++)
+			hits[i] = scan(tris, rays[i * 97]);
+	});
+	return 0;
+}
+
+/** @brief Checks the triangles written as a mesh file and mapped back in
+ * place, and files with bad extents, then times both.
+ * @return Nonzero if a check failed */
+static int mesh_files(Data const& d) {
+	auto const& tris = d.tris;
+	const char *mesh_path = "bench.mesh";
+	vector<float> flat(4 * tris.size());
+	vector<std::uint32_t> order(tris.size());
+	for(std::size_t i = 0; i < tris.size(); i++) {
+		flat[4*i] = tris[i].x;
+		flat[4*i+1] = tris[i].y;
+		flat[4*i+2] = tris[i].z;
+		flat[4*i+3] = 1;
+		order[i] = std::uint32_t(i);
+	}
+	if(!Streams::MeshFile::write(mesh_path, flat.data(), tris.size(),
+			order.data(), order.size())) {
+		cout << "Could not write " << mesh_path << endl;
+		return 1;
+	}
+	{
+		Streams::MeshFile mesh(mesh_path);
+		auto lo = tris[0], hi = lo;
+		for(auto const& v : tris) {
+			lo = {std::min(lo.x, v.x), std::min(lo.y, v.y),
+				std::min(lo.z, v.z)};
+			hi = {std::max(hi.x, v.x), std::max(hi.y, v.y),
+				std::max(hi.z, v.z)};
+		}
+		if(!mesh || mesh.vertex_count() != tris.size()
+				|| mesh.index_count() != order.size()
+				|| memcmp(mesh.vertices(), flat.data(), flat.size() * 4)
+				|| memcmp(mesh.indices(), order.data(), order.size() * 4)
+				|| !near(mesh.lo(), lo) || !near(mesh.hi(), hi)) {
+			cout << "The mapped mesh differs from the written one" << endl;
+			remove(mesh_path);
+			return 1;
+		}
+	}
+	{
+		// Section extents whose end wraps past 2^64 must not validate
+		Streams::MeshFile::Header h;
+		std::fstream file(mesh_path,
+				std::ios::in | std::ios::out | std::ios::binary);
+		file.read(reinterpret_cast<char*>(&h), sizeof h);
+		auto good = h;
+		h.index_offset = ~std::uint64_t(0) - 63;
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(&h), sizeof h);
+		file.flush();
+		bool wrapped = bool(Streams::MeshFile(mesh_path));
+		h = good;
+		h.vertices = ~std::uint32_t(0);
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(&h), sizeof h);
+		file.close();
+		if(wrapped || Streams::MeshFile(mesh_path)) {
+			cout << "A mesh file with bad extents was mapped" << endl;
+			remove(mesh_path);
+			return 1;
+		}
+	}
+
+	heading("Mesh files", tris.size(), "vertices, from the page cache");
+	measure("MeshFile::write", tris.size(), [&] {
+		Streams::MeshFile::write(mesh_path, flat.data(), tris.size(),
+			order.data(), order.size());
+	});
+	measure("MeshFile::MeshFile", tris.size(), [&] {
+		Streams::MeshFile mesh(mesh_path);
+		sink = sink + mesh.vertex_count();
+	});
+	measure("MeshFile::MeshFile, read through", tris.size(), [&] {
+		Streams::MeshFile mesh(mesh_path);
+		auto v = mesh.vertices();
+		float sum = 0;
+		// One float per 4 KiB page
+		for(std::size_t i = 0; i < 4 * std::size_t(mesh.vertex_count());
+				i += 1024)
+			sum += v[i];
+		sink = sink + sum;
+	});
+	remove(mesh_path);
+	return 0;
+}
+
+/** @brief Checks then times the import of the triangles as OBJ and as
+ * binary PLY, each vertex written twice.
+ * @return Nonzero if a check failed */
+static int importer(Data const& d) {
+	auto const& tris = d.tris;
+	std::string obj, ply;
+	char line[64];
+	for(unsigned copy = 0; copy < 2; copy++)
+		for(auto const& v : tris) {
+			snprintf(line, sizeof line, "v %.9g %.9g %.9g\n", v.x, v.y, v.z);
+			obj += line;
+		}
+	for(std::size_t k = 0; k < 2 * tris.size(); k += 3) {
+		snprintf(line, sizeof line, "f %zu %zu %zu\n", k + 1, k + 2, k + 3);
+		obj += line;
+	}
+	const std::uint16_t one = 1;
+	ply = std::string("ply\nformat ") + (*reinterpret_cast<const char*>(&one)
+			? "binary_little_endian" : "binary_big_endian")
+		+ " 1.0\nelement vertex "
+		+ std::to_string(2 * tris.size()) + "\nproperty float x\n"
+		"property float y\nproperty float z\nelement face "
+		+ std::to_string(2 * tris.size() / 3) + "\nproperty list uchar "
+		"uint vertex_indices\nend_header\n";
+	for(unsigned copy = 0; copy < 2; copy++)
+		for(auto const& v : tris)
+			ply.append(reinterpret_cast<const char*>(&v.x), 3 * sizeof(float));
+	for(std::uint32_t k = 0; k < 2 * tris.size(); k += 3) {
+		std::uint32_t face[] = {k, k + 1, k + 2};
+		ply += char(3);
+		ply.append(reinterpret_cast<const char*>(face), sizeof face);
+	}
+	for(auto const *text : {&obj, &ply}) {
+		Streams::Importer mesh(text->data(), text->size());
+		auto const& v = mesh.vertices();
+		auto const& idx = mesh.indices();
+		bool good = mesh && mesh.read() == 2 * tris.size()
+			&& mesh.vertex_count() <= tris.size()
+			&& idx.size() == 2 * tris.size();
+		for(std::size_t k = 0; good && k < tris.size(); k++)
+			good = idx[k] == idx[k + tris.size()] && near(tris[k],
+					Vec_t<float>{v[4*idx[k]], v[4*idx[k]+1], v[4*idx[k]+2]});
+		if(!good) {
+			cout << "The imported mesh differs from the written one" << endl;
+			return 1;
+		}
+	}
+
+	heading("Importer", 2 * tris.size(), "vertices read, half merged");
+	measure("parse_float", 3 * tris.size(), [&] {
+		float x, sum = 0;
+		// Past "v " for the first number, past ' ' for the others
+		for(auto p = obj.data(), end = p + obj.size(); *p == 'v'; p++)
+			for(unsigned k = 0; k < 3; k++) {
+				p = Streams::parse_float(p + (k ? 1 : 2), end, x);
+				sum += x;
+			}
+		sink = sink + sum;
+	});
+	measure("strtof", 3 * tris.size(), [&] {
+		float sum = 0;
+		char *p = &obj[0];
+		for(; *p == 'v'; p++)
+			for(unsigned k = 0; k < 3; k++) sum += strtof(p + 1, &p);
+		sink = sink + sum;
+	});
+	measure("Importer::Importer, OBJ", 2 * tris.size(), [&] {
+		Streams::Importer mesh(obj.data(), obj.size());
+		sink = sink + mesh.vertex_count();
+	});
+	measure("Importer::Importer, binary PLY", 2 * tris.size(), [&] {
+		Streams::Importer mesh(ply.data(), ply.size());
+		sink = sink + mesh.vertex_count();
+	});
+	return 0;
+}
+
+/** @brief Checks captured frames read back through key-only, short and
+ * long key intervals; frames change a little at a time, except one
+ * entirely. Capture is bound by the disk, so it is not timed.
+ * @return Nonzero if a check failed */
+static int capture(Data const&) {
+	const char *capture_path = "bench.cap";
+	unsigned cw = 37, ch = 23, n_frames = 12;
+	vector<vector<unsigned char>> frames(n_frames);
+	for(unsigned f = 0; f < n_frames; f++) {
+		auto &rgba = frames[f];
+		if(f && f != n_frames / 2) {
+			rgba = frames[f-1];
+			for(unsigned k = 0; k < 8; k++)
+				rgba[rand() % rgba.size()] ^= 1 + rand() % 255;
+		} else {
+			rgba.resize(cw * ch * 4);
+			for(auto &c : rgba) c = (unsigned char) rand();
+		}
+	}
+	for(unsigned keys : {1, 3, 100}) {
+		bool good;
+		{
+			Streams::Capture capture(capture_path,
+				Streams::Capture::Format::raw,
+				Streams::Capture::Policy::block, 4, keys);
+			for(unsigned f = 0; f < n_frames; f++)
+				capture.push(frames[f].data(), cw, ch, f);
+			capture.close();
+			good = capture.written() == n_frames && !capture.dropped();
+		}
+		Streams::CaptureReader reader(capture_path);
+		vector<unsigned char> rgba;
+		unsigned w, h, frame, f = 0;
+		for(; good && reader.next(rgba, w, h, frame); f++)
+			good = f < n_frames && frame == f && w == cw && h == ch
+				&& rgba == frames[f];
+		if(!good || f != n_frames) {
+			cout << "The captured frames differ with key interval " << keys
+				<< endl;
+			remove(capture_path);
+			return 1;
+		}
+	}
+	remove(capture_path);
+	return 0;
+}
+
+/** @brief Checks then times every group over n elements, stopping at the
+ * first group whose check fails.
+ * @return Nonzero if any check failed */
+static int run(std::size_t n) {
+	size = n;
+	Data d(n);
+	for(auto group : {vectors, quaternions, dual_quaternions, matrices,
+			rotations, rigid, interpolation, packing, hierarchy, culling,
+			render_queue, picking, mesh_files, importer, capture})
+		if(int err = group(d)) return err;
+	return 0;
+}
+
+int main(int argc, const char *argv[]) {
+	const char *file = "bench.tsv";
+	vector<std::size_t> sizes;
+	for(int i = 1; i < argc; i++) {
+		if(!strcmp(argv[i], "-o") && i + 1 < argc) file = argv[++i];
+		else sizes.push_back(std::size_t(atol(argv[i])));
+	}
+	// Within L1, within the last level cache, and well beyond it
+	if(sizes.empty()) sizes = {1 << 10, 1 << 14, 1 << 18};
+	for(auto n : sizes) {
+		if(!n) {
+			cout << "Sizes must be positive" << endl;
+			return 1;
+		}
+		if(int err = run(n)) return err;
+	}
+
+	std::ofstream dest(file);
+	dest << "group\toperation\tsize\tns_per_op\telements_per_s\n";
+	for(auto const& row : rows)
+		dest << row.group << '\t' << row.name << '\t' << row.size << '\t'
+			<< row.ns << '\t' << 1e9 / row.ns << '\n';
+	if(!dest) {
+		cout << "Could not write " << file << endl;
+		return 1;
+	}
+	cout << "Wrote " << rows.size() << " timings to " << file << endl;
+}
@@ -8,6 +8,7 @@
 #include "dual_quaternion.hpp"
 #include "matrix.hpp"
 #include "streams.hpp"
+#include "tables.hpp"
 
 ///@cond
 #include <iostream>
@@ -66,19 +67,29 @@ ostream& matrices(ostream& dest) {
 }
 
 ostream& quaternions(ostream& dest) {
-	std::vector<Quatf> basis = {1._r, 1._i, 1._j, 1._k};
+	auto const& basis = Tables::quat_basis<float>;
 	{
+		// Computed during compilation; only printed here
+		auto const& products = Tables::quat_products<float>;
+		static_assert(products[4*1 + 2] == Quatf(1._k),
+			"The product table should be a constant expression.");
+		constexpr auto i = Tables::quat_basis<float>[1],
+			j = Tables::quat_basis<float>[2],
+			k = Tables::quat_basis<float>[3];
+		static_assert(Quatf{(i*j + k)/2.f} == k
+			&& dot(i*j, k) == 1 && (i ^ Vec_t<float>{1,0,0}).x == 1,
+			"Fused expressions should be constant expressions.");
 		Paster paster;
-		for(auto const& y : basis) {
+		for(unsigned y = 0; y < 4; y++) {
 			ostringstream col;
-			for(auto const& x : basis)
-				col << x*y << '\n';
+			for(unsigned x = 0; x < 4; x++)
+				col << products[4*x + y] << '\n';
 			paster << ' ' << col << ' ';
 		}
 		dest << "Quaternion product...\n";
 		border(dest, paster);
 	} {
-		Vec_t<float> x = {1,0,0}, y = {0,1,0}, z = {0,0,1};
+		constexpr Vec_t<float> x = {1,0,0};
 
 		static_assert(is_same<decltype(rotation(M_PI, x)),
 			Quat_t<double>>::value, "The quaternion should contain "
@@ -90,10 +101,10 @@ ostream& quaternions(ostream& dest) {
 		// specified! Convention, if not control, is due.
 
 		Paster paster;
-		float deg90 = M_PI/2;
-		auto x90 = rotation(deg90, x),
-			 y90 = rotation(deg90, y),
-			 z90 = rotation(deg90, z);
+		auto const& turns = Tables::quarter_turns<float>;
+		static_assert(turns[0] == Constant::rotation(float(M_PI/2), x),
+			"Rotations should be constant expressions.");
+		auto x90 = turns[0], y90 = turns[1], z90 = turns[2];
 		auto header = column(ostringstream(), "", x90, y90, z90),
 			 bar = repeat(ostringstream(), "", 1, " | ", 3);
 		paster << header;
@@ -112,17 +123,14 @@ ostream& quaternions(ostream& dest) {
 
 ostream& dual_quaternions(ostream& dest) {
 	{
-		auto z = 0._r, r = 1._r,
-			 i = 1._i, j = 1._j, k = 1._k;
-		std::vector<DualQuat_t<float>> basis =
-			{{r, z}, {i, z}, {j, z}, {k, z},
-			 {z, r}, {z, i}, {z, j}, {z, k}};
+		auto r = 1._r, i = 1._i, j = 1._j, k = 1._k;
 		{
+			auto const& products = Tables::dual_products<float>;
 			Paster paster;
 			for(auto j = 0; j < 8; j++) {
 				ostringstream col;
 				for(auto i = 0; i < 8; i++) {
-					col << " " << basis[i]*basis[j] << " \n";
+					col << " " << products[8*i + j] << " \n";
 				}
 				paster << col;
 			}
@@ -132,8 +140,9 @@ ostream& dual_quaternions(ostream& dest) {
 		}
 		{
 			Paster paster;
-			DualQuat_t<float> rot = {rotation<float>(M_PI,
-				Vec_t<float>{0,0,1}), 0._r}, trans = {1._r, 1._k},
+			constexpr DualQuat_t<float> rot = {
+				Constant::rotation<float>(M_PI, Vec_t<float>{0,0,1}), 0._r},
+				trans = {1._r, 1._k},
 				transrot = trans*rot, rottrans = rot*trans,
 				screw = rot+trans;
 			std::vector<DualQuat_t<float>>
@@ -5,10 +5,17 @@
  *  proofs of concepts before integration into the appropriate module. */
 
 ///@cond
+#include <cerrno>
 #include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 #include <SDL.h>
 ///@endcond
 
@@ -17,11 +24,25 @@
 #include "glsl.hpp"
 #include "streams.hpp"
 #include "stopwatch.hpp"
+#include "capture.hpp"
+#include "mesh.hpp"
 
 #include "geometry.hpp"
 #include "model.hpp"
 
-bool run(std::ostream &dest, int n_frames) {
+/** @brief Runs the main loop.
+ * @param dest The destination of the performance report
+ * @param n_frames The number of frames to draw when headless
+ * @param rate The target frame rate, or zero to run uncapped
+ * @param interval The swap interval, or zero to pace without vsync
+ * @param headless True to draw offscreen into a hidden window
+ * @param snapshot Where to write the last frame read back as a binary
+ * PPM, e.g. as a golden image, or empty to discard frames
+ * @param capture The destination of every frame read back, if any
+ * @return True if and only if the loop ended with a quit signal */
+bool run(std::ostream &dest, int n_frames, double rate, int interval,
+		bool headless, std::string const& snapshot,
+		Streams::Capture *capture) {
 	using namespace View;
 	using namespace Shaders;
 	using std::setw;
@@ -30,13 +51,17 @@ bool run(std::ostream &dest, int n_frames) {
 
 	unsigned w = 640, h = 480;
 	auto asp = float(w)/h;
-	Window win("Title", w, h, SDL_WINDOW_RESIZABLE, {
+	Window win("Title", w, h, SDL_WINDOW_RESIZABLE
+			| (headless ? SDL_WINDOW_HIDDEN : 0), {
 		{GLCTX(PROFILE_MASK), GLCTX(PROFILE_CORE)},
 		{GLCTX(MAJOR_VERSION), 3}, {GLCTX(MINOR_VERSION), 3},
 		{SDL_GL_DOUBLEBUFFER, 1}, {SDL_GL_DEPTH_SIZE, 24}
 	});
 
 	if(!win.validate()) return dest << win, false;
+	win.m_pacer.rate(rate);
+	if(interval && !win.swap_interval(interval))
+		dest << "Swap interval " << interval << " is unsupported\n";
 
 	Streams::Cutter c0(GLSL_VERT), c1(GLSL_FRAG);
 	Program<GL_VERTEX_SHADER, GL_FRAGMENT_SHADER> p {c0, c1};
@@ -44,23 +69,101 @@ bool run(std::ostream &dest, int n_frames) {
 		return dest << "Could not build shader\n" << p.info(), false;
 
 	p.use();
-	auto id_mvp = p.uniform("mvp");
-	if(id_mvp == -1)
-		return dest << "MVP uniform not found!\n", false;
+	if(p.block("Frame") == GL_INVALID_INDEX)
+		return dest << "Frame uniform block not found!\n", false;
+	win.m_program = p;
+
+	// A ring of small triangles in front of the quad, in one instanced draw
+	// queued with the quad
+	Streams::Cutter c2(GLSL_INSTANCED_VERT);
+	Program<GL_VERTEX_SHADER, GL_FRAGMENT_SHADER> pi {c2, c1};
+	if(!pi.build())
+		return dest << "Could not build instanced shader\n" << pi.info(),
+			false;
+	static const float tri_vertices[] = {
+		-.1f, -.1f, 0, 1,
+		+.1f, -.1f, 0, 1,
+		   0, +.1f, 0, 1
+	};
+	static const GLuint tri_indices[] = {0, 1, 2};
+	Mesh tri(tri_vertices, 3, tri_indices, 3);
+	RenderQueue::Item ring_item;
+	ring_item.program = pi;
+	std::vector<Geometry::Matrix_t<float>> ring(12,
+		Geometry::Matrix_t<float>::identity());
+	for(unsigned i = 0; i < ring.size(); i++) {
+		auto t = 2 * M_PI * i / ring.size();
+		// Translations take the last column, as in the Frame block's mvp
+		ring[i][12] = float(.75 * std::cos(t));
+		ring[i][13] = float(.75 * std::sin(t));
+		ring[i][14] = -1.5f;
+	}
+	std::size_t drawn = 0;
+	win.m_draw = [&] {
+		if(tri.draw(win.m_queue, ring_item, win.stream(), ring.data(),
+				ring.size()))
+			drawn += ring.size();
+	};
+
+	// The sink copies only the rows of the latest frame it is handed
+	std::vector<unsigned char> last;
+	GLsizei last_w = 0, last_h = 0;
+	win.m_record = capture != nullptr;
+	if(snapshot.size() || capture)
+		win.m_readback.sink([&] (unsigned char const *rgba,
+				GLsizei width, GLsizei height, unsigned frame) {
+			// The writer thread encodes; a full queue follows its policy
+			if(capture) capture -> push(rgba, width, height, frame);
+			if(snapshot.empty()) return;
+			last.assign(rgba, rgba + std::size_t(width) * height * 4);
+			last_w = width;
+			last_h = height;
+		});
 
 	FSignal res;
-	unsigned frame = 0, interval = 60;
+	unsigned frame = 0, report = 60;
 
 	dest << std::setprecision(4);
 	auto watch = stopwatch(&perf_rate<float>);
 	while(watch.start(), res = win.validate()) {
-		res = win.draw(frame, id_mvp);
+		res = win.draw(frame);
 		watch.pause();
-		if(!(frame % interval))
-			dest << watch << endl;
+		if(!(frame % report))
+			dest << watch << ", CPU ms: " << std::chrono::duration<double,
+					std::milli>(win.m_pacer.busy()).count()
+				<< ", " << win.m_gpu << ", missed " << win.m_pacer.missed()
+				<< " of " << win.m_pacer.frames() << " frames, "
+				<< win.m_calls.filtered << " of " << win.m_calls.issued
+				+ win.m_calls.filtered << " state calls filtered" << endl;
 		frame++;
+		if(headless && frame >= unsigned(n_frames)) {
+			res = {FSignal::Code::quit};
+			break;
+		}
+	}
+	win.m_draw = nullptr;
+	dest << "\nWindow exited; " << res << '\n' << win
+		<< "Drew " << drawn << " instances\n";
+	if(headless || capture) {
+		win.m_readback.flush();
+		dest << "\nRead back " << win.m_readback.delivered() << " frames";
+	}
+	if(capture) {
+		capture -> close();
+		dest << "\nCaptured " << capture -> written() << " frames, dropped "
+			<< capture -> dropped();
+	}
+	if(snapshot.size()) {
+		std::ofstream out(snapshot, std::ios::binary);
+		out << "P6\n" << last_w << ' ' << last_h << "\n255\n";
+		// PPM rows run top to bottom, GL rows bottom to top
+		for(auto y = last_h; y-- > 0;)
+			for(GLsizei x = 0; x < last_w; x++)
+				out.write(reinterpret_cast<const char*>(
+					&last[(std::size_t(y) * last_w + x) * 4]), 3);
+		if(!last_w || !out)
+			return dest << "\nCould not write " << snapshot << '\n', false;
 	}
-	dest << "\nWindow exited; " << res << '\n' << win;
 	return res.error == FSignal::Code::quit;
 }
 
@@ -75,6 +178,68 @@ int main(int argc, const char *argv[]) {
 	int n_frames = 20,
 		mods_in = SDL_INIT_VIDEO,
 		mods_err, mods_out, run_out;
+	// Frames are paced to 60 Hz unless uncapped or left to vsync
+	double rate = 60;
+	int interval = 0;
+	// Headless runs draw offscreen as fast as possible by default
+	bool headless = false, paced = false;
+	std::string snapshot, capture_path;
+	// Captures drop frames the writer cannot keep up with by default
+	auto format = Streams::Capture::Format::raw;
+	auto policy = Streams::Capture::Policy::drop_newest;
+	unsigned keys = 1;
+	for(int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		// Numbers must fill the rest of the argument and be in range
+		const char *value = argv[i] + arg.find('=') + 1;
+		char *end = nullptr;
+		errno = 0;
+		if(arg == "--headless") headless = true;
+		else if(arg.compare(0, 9, "--frames=") == 0) {
+			long l = std::strtol(value, &end, 10);
+			if(end == value || *end || errno || l < 0 || l > INT_MAX) {
+				cout << "Frames must be a count, not " << value << endl;
+				return 1;
+			}
+			n_frames = int(l);
+		}
+		else if(arg.compare(0, 11, "--snapshot=") == 0)
+			snapshot = arg.substr(11);
+		else if(arg.compare(0, 10, "--capture=") == 0)
+			capture_path = arg.substr(10);
+		else if(arg == "--capture-ppm")
+			format = Streams::Capture::Format::ppm;
+		else if(arg.compare(0, 15, "--capture-keys=") == 0) {
+			long l = std::strtol(value, &end, 10);
+			if(end == value || *end || errno || l < 1 || l > UINT_MAX) {
+				cout << "Key intervals must be positive, not " << value
+					<< endl;
+				return 1;
+			}
+			keys = unsigned(l);
+		}
+		else if(arg == "--capture-block")
+			policy = Streams::Capture::Policy::block;
+		else if(arg == "--capture-drop-oldest")
+			policy = Streams::Capture::Policy::drop_oldest;
+		else if(arg == "--uncapped") rate = 0, paced = true;
+		else if(arg == "--vsync") interval = 1;
+		else if(arg.compare(0, 7, "--rate=") == 0) {
+			rate = std::strtod(value, &end);
+			if(end == value || *end || errno || !(rate >= 0)
+					|| rate == HUGE_VAL) {
+				cout << "Rates must be zero or positive, not " << value
+					<< endl;
+				return 1;
+			}
+			paced = true;
+		}
+	}
+	if(headless) {
+		if(!paced) rate = 0;
+		// No display is needed; an existing choice of driver is kept
+		SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+	}
 
 	if(!(mods_in &= SDL_INIT_EVERYTHING))
 		cout << "# Deferring SDL init." << endl;
@@ -97,7 +262,12 @@ int main(int argc, const char *argv[]) {
 	} else {
 		cout << "done.\n# Beginning test..." << endl;
 		auto t0 = std::chrono::system_clock::now();
-		run_out = run(cout, 30);
+		std::unique_ptr<Streams::Capture> capture;
+		if(capture_path.size())
+			capture.reset(new Streams::Capture(capture_path, format, policy,
+				8, keys));
+		run_out = run(cout, n_frames, rate, interval, headless, snapshot,
+			capture.get());
 		duration<float> dt = std::chrono::system_clock::now() - t0;
 		cout << "# Test " << (run_out ? "passed" : "failed") << " after "
 			<< dt.count() << " seconds." << endl;
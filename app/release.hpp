@@ -9,6 +9,10 @@
 #define GLSL_VERT GLSL_ROOT "default.vert"
 #endif
 
+#ifndef GLSL_INSTANCED_VERT
+#define GLSL_INSTANCED_VERT GLSL_ROOT "instanced.vert"
+#endif
+
 #ifndef GLSL_FRAG
 #define GLSL_FRAG GLSL_ROOT "default.frag"
 #endif
@@ -0,0 +1,189 @@
+/*! @file include/batch.hpp
+ *  @brief Structure-of-arrays vectors and quaternions with SIMD kernels */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "geometry.hpp"
+#include "quaternion.hpp"
+#include "dual_quaternion.hpp"
+#include "simd.hpp"
+
+///@cond
+#include <iterator>
+///@endcond
+
+namespace Geometry {
+
+	/** @brief Structure-of-arrays counterpart of Vec_t<float>; each
+	 * component is an aligned array padded with zeros to Simd::block. */
+	struct VecBatch;
+	/** @brief Structure-of-arrays counterpart of Quat_t<float>; each
+	 * component is an aligned array padded with zeros to Simd::block. */
+	struct QuatBatch;
+	/** @brief Structure-of-arrays counterpart of DualQuat_t<float>, kept
+	 * as batches of its real and dual parts. */
+	struct DualQuatBatch;
+
+	struct VecBatch {
+		Simd::Array x, y, z;
+
+		std::size_t size(void) const;
+		void resize(std::size_t n);
+		Vec_t<float> operator[](std::size_t i) const;
+		void set(std::size_t i, Vec_t<float> const& v);
+
+		VecBatch(std::size_t n = 0);
+		template<typename IT>
+		VecBatch(IT p0, IT p1): VecBatch(std::distance(p0, p1)) {
+			for(std::size_t i = 0; p0 != p1; ++p0, ++i) set(i, *p0);
+		}
+	protected:
+		std::size_t count = 0;
+	};
+
+	struct QuatBatch {
+		Simd::Array w, x, y, z;
+
+		std::size_t size(void) const;
+		void resize(std::size_t n);
+		Quat_t<float> operator[](std::size_t i) const;
+		void set(std::size_t i, Quat_t<float> const& q);
+
+		QuatBatch(std::size_t n = 0);
+		template<typename IT>
+		QuatBatch(IT p0, IT p1): QuatBatch(std::distance(p0, p1)) {
+			for(std::size_t i = 0; p0 != p1; ++p0, ++i) set(i, *p0);
+		}
+	protected:
+		std::size_t count = 0;
+	};
+
+	struct DualQuatBatch {
+		QuatBatch u, v;
+
+		std::size_t size(void) const;
+		void resize(std::size_t n);
+		DualQuat_t<float> operator[](std::size_t i) const;
+		void set(std::size_t i, DualQuat_t<float> const& q);
+
+		DualQuatBatch(std::size_t n = 0);
+		template<typename IT>
+		DualQuatBatch(IT p0, IT p1): DualQuatBatch(std::distance(p0, p1)) {
+			for(std::size_t i = 0; p0 != p1; ++p0, ++i) set(i, *p0);
+		}
+	};
+
+	/** @brief Element-wise product, matching the quaternion operator*.
+	 * @param l The left factors
+	 * @param r The right factors
+	 * @param dest The products, resized to the shorter input (may alias) */
+	void multiply(QuatBatch const& l, QuatBatch const& r, QuatBatch& dest);
+	/** @brief Element-wise product of rigid transforms, (a, b)(c, d) =
+	 * (ac, ad + bc), matching the dual quaternion operator*.
+	 * @param l The left factors
+	 * @param r The right factors
+	 * @param dest The products, resized to the shorter input (may alias) */
+	void multiply(DualQuatBatch const& l, DualQuatBatch const& r,
+			DualQuatBatch& dest);
+	/** @brief Element-wise conjugate, matching unary operator* on Quat_t. */
+	void conjugate(QuatBatch const& src, QuatBatch& dest);
+	/** @brief Element-wise sandwich product q v q*, matching the vector
+	 * part of operator^(Quat_t, Vec_t); q need not be a unit quaternion.
+	 * @param q The rotations (scaled by their squared magnitudes)
+	 * @param v The vectors to conjugate
+	 * @param dest The results, resized to the shorter input (may alias v) */
+	void sandwich(QuatBatch const& q, VecBatch const& v, VecBatch& dest);
+	/** @brief Sandwich product of a single quaternion with each vector. */
+	void sandwich(Quat_t<float> const& q, VecBatch const& v, VecBatch& dest);
+	/** @brief Element-wise dot products, matching dot(Vec_t, Vec_t).
+	 * @param l The left vectors
+	 * @param r The right vectors
+	 * @param dest The products, resized to Simd::padded of the shorter
+	 * input, with zero padding */
+	void dot(VecBatch const& l, VecBatch const& r, Simd::Array& dest);
+	/** @brief Element-wise cross products, matching operator*(Vec_t, Vec_t).
+	 * @param l The left vectors
+	 * @param r The right vectors
+	 * @param dest The products, resized to the shorter input (may alias) */
+	void cross(VecBatch const& l, VecBatch const& r, VecBatch& dest);
+	/** @brief Element-wise magnitudes, from a reciprocal square root
+	 * estimate refined by one Newton step (within a few ulps).
+	 * @param src The vectors
+	 * @param dest The magnitudes, resized to Simd::padded(src.size()) */
+	void magnitude(VecBatch const& src, Simd::Array& dest);
+	/** @brief Element-wise magnitudes, as for VecBatch. */
+	void magnitude(QuatBatch const& src, Simd::Array& dest);
+	/** @brief Element-wise normalization by the refined reciprocal square
+	 * root; zero vectors are left zero. */
+	void normalize(VecBatch const& src, VecBatch& dest);
+	/** @brief Element-wise normalization by the refined reciprocal square
+	 * root; zero quaternions are left zero. */
+	void normalize(QuatBatch const& src, QuatBatch& dest);
+
+	/**
+	 * @brief Restores unit length to the rotations that products have let
+	 * drift, leaving the rest, and the memory holding them, untouched.
+	 * @param q The rotations, renormalized in place
+	 * @param tolerance The largest accepted | |q|^2 - 1 |
+	 * @return The number of rotations renormalized; zeros are skipped
+	 */
+	std::size_t renormalize(QuatBatch &q, float tolerance = 1e-5f);
+	/** @brief Restores unit real parts and orthogonal dual parts (u.v = 0)
+	 * where either is off by more than the tolerance, as for QuatBatch. */
+	std::size_t renormalize(DualQuatBatch &dq, float tolerance = 1e-5f);
+	/** @brief Renormalizes n rotations in place, as for QuatBatch. */
+	std::size_t renormalize(Quat_t<float> *q, std::size_t n,
+			float tolerance = 1e-5f);
+	/** @brief Renormalizes n rigid transforms in place, such as the local
+	 * transforms of a hierarchy, as for DualQuatBatch. */
+	std::size_t renormalize(DualQuat_t<float> *dq, std::size_t n,
+			float tolerance = 1e-5f);
+
+	/** @brief Element-wise rotation by unit quaternions, matching rotate().
+	 * @param q The rotations, which must be normalized
+	 * @param v The vectors to rotate
+	 * @param dest The results, resized to the shorter input (may alias v) */
+	void rotate(QuatBatch const& q, VecBatch const& v, VecBatch& dest);
+	/** @brief Rotation of each vector by a single unit quaternion. */
+	void rotate(Quat_t<float> const& q, VecBatch const& v, VecBatch& dest);
+	/** @brief Element-wise rigid transform, matching transform(); the dual
+	 * quaternions are split into their real and dual parts.
+	 * @param u The rotations, which must be normalized
+	 * @param v The dual parts, tu/2 for each translation t
+	 * @param p The points to transform
+	 * @param dest The results, resized to the shortest input (may alias p) */
+	void transform(QuatBatch const& u, QuatBatch const& v,
+			VecBatch const& p, VecBatch& dest);
+	/** @brief Rigid transform of each point by a single dual quaternion. */
+	void transform(DualQuat_t<float> const& dq,
+			VecBatch const& p, VecBatch& dest);
+
+	/** @brief The lane kernel of rotate() over batches: with t = 2 u x v,
+	 * v + w t + u x t, in place for a lane of vectors. */
+	inline void rotate(Simd::Lane qw, Simd::Lane qx, Simd::Lane qy,
+			Simd::Lane qz, Simd::Lane &vx, Simd::Lane &vy, Simd::Lane &vz) {
+		auto two = Simd::Lane::broadcast(2),
+			 tx = two * (qy*vz - qz*vy),
+			 ty = two * (qz*vx - qx*vz),
+			 tz = two * (qx*vy - qy*vx);
+		auto ox = vx + qw*tx + (qy*tz - qz*ty),
+			 oy = vy + qw*ty + (qz*tx - qx*tz),
+			 oz = vz + qw*tz + (qx*ty - qy*tx);
+		vx = ox; vy = oy; vz = oz;
+	}
+	/** @brief The lane kernel of transform() over batches, for kernels
+	 * that form their own dual quaternions, such as skinning: rotate by
+	 * u, then add the translation t = 2 vec(v u*), in place. */
+	inline void transform(Simd::Lane uw, Simd::Lane ux, Simd::Lane uy,
+			Simd::Lane uz, Simd::Lane vw, Simd::Lane vx, Simd::Lane vy,
+			Simd::Lane vz, Simd::Lane &px, Simd::Lane &py, Simd::Lane &pz) {
+		auto two = Simd::Lane::broadcast(2);
+		rotate(uw, ux, uy, uz, px, py, pz);
+		px = px + two * (uw*vx - vw*ux + uy*vz - uz*vy);
+		py = py + two * (uw*vy - vw*uy + uz*vx - ux*vz);
+		pz = pz + two * (uw*vz - vw*uz + ux*vy - uy*vx);
+	}
+}
+
+#endif
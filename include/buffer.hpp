@@ -0,0 +1,111 @@
+/*! @file include/buffer.hpp
+ *  @brief Streaming vertex buffers written by the CPU every frame */
+
+#ifndef BUFFER_HPP
+#define BUFFER_HPP
+
+#include "view.hpp"
+
+namespace View {
+
+	/** @brief Tests for a feature of the current context.
+	 * @param major The major version making the feature core
+	 * @param minor The minor version making the feature core
+	 * @param extension The extension providing it in earlier versions
+	 * @return True if the context has the version or the extension */
+	bool supports(GLint major, GLint minor, const char *extension);
+
+	/**
+	 * @brief RAII vertex array and vertex buffer for geometry rewritten
+	 * every frame, handed out as sub-allocations of a ring.
+	 *
+	 * The ring is split into one region per frame in flight. Each region
+	 * is fenced when its frame ends and waited on only when the ring comes
+	 * back around to it, so the CPU writes while the GPU reads the regions
+	 * of earlier frames. With GL 4.4 or ARB_buffer_storage the buffer is
+	 * mapped once, persistently and coherently; otherwise each slice is
+	 * mapped unsynchronized, which the fences make safe. Either way the
+	 * driver neither copies the data nor waits for the GPU on a write.
+	 *
+	 * GL objects are created on first use, so that a stream can be a member
+	 * of an object that creates the context, such as Window.
+	 */
+	struct StreamBuffer {
+		/** @brief The number of frames the GPU may lag behind the CPU. */
+		static constexpr unsigned frames = 3;
+
+		/** @brief Writable memory for a run of vertices of one frame. */
+		struct Slice {
+			/** @brief Where to write the vertices; valid until commit(). */
+			void *data = nullptr;
+			/** @brief The byte offset of the slice in the buffer. */
+			GLintptr offset = 0;
+			/** @brief The byte size of the slice. */
+			GLsizeiptr size = 0;
+			/** @brief The index of the first vertex, for draw calls taking
+			 * a first or base vertex with attributes set from offset 0. */
+			GLint first = 0;
+			explicit operator bool(void) const { return data; }
+		};
+
+		/** @brief The vertex array holding the attributes of the buffer. */
+		GLuint vao(void);
+		/** @brief The vertex buffer. */
+		GLuint vbo(void);
+		/** @brief True if the buffer is mapped persistently. */
+		bool persistent(void);
+		/** @brief The byte capacity of each frame's region. */
+		GLsizeiptr region(void) const;
+
+		/** @brief Describes an attribute of the vertices in the buffer,
+		 * with offsets relative to the start of the buffer.
+		 * @param index The attribute location
+		 * @param size The number of components
+		 * @param type The type of each component
+		 * @param stride The byte size of each vertex
+		 * @param offset The byte offset of the attribute in each vertex */
+		void attribute(GLuint index, GLint size, GLenum type,
+				GLsizei stride, GLsizeiptr offset = 0);
+		/** @brief Uploads indices shared by every frame into an element
+		 * buffer bound to the vertex array, for draw calls taking a base
+		 * vertex and an index offset of 0.
+		 * @param indices The indices, relative to a slice's first vertex
+		 * @param count The number of indices */
+		void elements(GLuint const *indices, GLsizeiptr count);
+
+		/**
+		 * @brief Allocates vertices from the region of the current frame,
+		 * first waiting for the GPU to release the region if it is the
+		 * first allocation of the frame.
+		 * @param count The number of vertices
+		 * @param stride The byte size of each vertex
+		 * @return The slice, aligned to the stride so that its first vertex
+		 * is an index; empty if the region is full or mapping failed
+		 */
+		Slice allocate(GLsizeiptr count, GLsizei stride);
+		/** @brief Publishes the slice to the GPU after writing it; the
+		 * slice must be committed before the next allocation.
+		 * @return False if the data was lost, e.g. to a mode change */
+		bool commit(Slice &slice);
+		/** @brief Ends the frame; fences its region if it was written and
+		 * moves on to the region of the next frame. */
+		void fence(void);
+
+		StreamBuffer(GLsizeiptr capacity);
+		StreamBuffer(StreamBuffer const&) = delete;
+		StreamBuffer& operator=(StreamBuffer const&) = delete;
+		virtual ~StreamBuffer(void);
+	protected:
+		void create(void);
+
+		GLsizeiptr m_capacity, m_head = 0;
+		GLuint m_vao = 0, m_vbo = 0, m_ibo = 0;
+		bool m_persistent = false, m_waited = false;
+		unsigned m_frame = 0;
+		/* The base of the persistent mapping. */
+		char *m_map = nullptr;
+		GLsync m_fences[frames] = {};
+	};
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*! @file include/bvh.hpp
+ *  @brief Bounding volume hierarchy over triangles for ray picking */
+
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include "geometry.hpp"
+#include "matrix.hpp"
+
+///@cond
+#include <cstddef>
+#include <limits>
+#include <vector>
+///@endcond
+
+namespace Geometry {
+
+	/** @brief The points origin + t direction for t >= 0. */
+	struct Ray {
+		Vec_t<float> origin, direction;
+	};
+
+	/** @brief The nearest intersection found along a ray. */
+	struct Hit {
+		/** @brief The triangle index, or none for a miss. */
+		unsigned triangle = ~0u;
+		/** @brief The ray parameter and the barycentric coordinates of the
+		 * hit, which is (1-u-v) v0 + u v1 + v v2. */
+		float t = std::numeric_limits<float>::infinity(), u = 0, v = 0;
+		explicit operator bool(void) const { return triangle != ~0u; }
+	};
+
+	/**
+	 * @brief The ray through a point of the viewport.
+	 * @param inverse The inverse of the model-view-projection, applied as
+	 * v*m as in Window::draw
+	 * @param x The horizontal normalized device coordinate, in [-1, 1]
+	 * @param y The vertical normalized device coordinate, up from -1
+	 * @return The ray from the near plane towards the far plane, in the
+	 * space the model-view-projection maps from; a ray that misses
+	 * everything if either end is at or near infinity
+	 */
+	Ray unproject(Matrix_t<float> const& inverse, float x, float y);
+
+	/**
+	 * @brief A bounding volume hierarchy over triangles, built by the
+	 * surface area heuristic over binned centroids.
+	 *
+	 * Nodes are stored depth-first, each left child directly after its
+	 * parent, so that refit() is one backward pass over the nodes. The
+	 * triangles are copied in leaf order as a vertex and two edges, the
+	 * form the intersection test consumes.
+	 */
+	struct Bvh {
+		static constexpr unsigned none = ~0u;
+
+		/** @brief The number of triangles. */
+		std::size_t size(void) const;
+		/** @brief Builds the hierarchy.
+		 * @param vertices Three vertices per triangle
+		 * @param n The number of triangles */
+		void build(Vec_t<float> const *vertices, std::size_t n);
+		/** @brief Recomputes every bound after the vertices moved, keeping
+		 * the tree; cheap per frame, but queries slow down as motion
+		 * drifts from the layout the tree was built for.
+		 * @param vertices The triangles passed to build, in the same order */
+		void refit(Vec_t<float> const *vertices);
+		/** @brief The nearest intersection of one ray. */
+		Hit intersect(Ray const& ray) const;
+		/** @brief The nearest intersections of n rays, traversed together
+		 * a SIMD lane at a time; coherent rays such as those through
+		 * neighbouring pixels share most of their traversal. */
+		void intersect(Ray const *rays, Hit *hits, std::size_t n) const;
+
+		Bvh(void) = default;
+		Bvh(Vec_t<float> const *vertices, std::size_t n);
+	protected:
+		/* A leaf when count is nonzero, holding the triangles from start;
+		 * otherwise the children are the next node and the one at start. */
+		struct Node {
+			Vec_t<float> lo, hi;
+			unsigned start, count;
+		};
+		struct Triangle {
+			Vec_t<float> v0, e1, e2;
+		};
+
+		unsigned split(std::vector<unsigned> &order, Vec_t<float> const *c,
+				Vec_t<float> const *lo, Vec_t<float> const *hi,
+				unsigned begin, unsigned end, unsigned depth);
+
+		std::vector<Node> m_nodes;
+		std::vector<Triangle> m_triangles;
+		/* The input index of each stored triangle. */
+		std::vector<unsigned> m_order;
+	};
+}
+
+#endif
@@ -0,0 +1,130 @@
+/*! @file include/capture.hpp
+ *  @brief Frame capture to disk on a writer thread */
+
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+///@cond
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+///@endcond
+
+namespace Streams {
+
+	/**
+	 * @brief Records RGBA8 frames, handed over by the render loop, through
+	 * a bounded queue to a writer thread that encodes them to disk.
+	 *
+	 * The render loop only copies each frame into a recycled buffer; what
+	 * happens when the queue is full is up to the policy. Frames are
+	 * written either as a sequence of PPM images or as one raw stream:
+	 * an 8-byte signature, "RGBACAP1", then per frame five native 32-bit
+	 * words (frame number, width, height, kind, payload size) and the
+	 * payload. A key frame (kind 0) holds the pixels as given, bottom row
+	 * first; a delta frame (kind 1) holds the bytes that differ from the
+	 * previous frame XOR that frame, as runs of a skipped byte count, a
+	 * literal byte count and the literal bytes. Still scenes thus take a
+	 * few bytes per frame. CaptureReader decodes the stream.
+	 */
+	struct Capture {
+		/** @brief What push() does when the queue is full. */
+		enum class Policy {
+			/** @brief Waits for the writer; lossless, but stalls. */
+			block,
+			/** @brief Drops the frame being pushed. */
+			drop_newest,
+			/** @brief Drops the oldest frame waiting in the queue. */
+			drop_oldest
+		};
+		/** @brief The encoding of frames on disk. */
+		enum class Format {
+			/** @brief One stream, optionally delta-compressed. */
+			raw,
+			/** @brief One binary PPM per frame, named by the path
+			 * followed by a six-digit frame number and ".ppm". */
+			ppm
+		};
+
+		/** @brief True while frames can be written. */
+		explicit operator bool(void) const;
+		/** @brief Copies a frame into the queue.
+		 * @param rgba Tightly packed RGBA8 rows, bottom row first
+		 * @param w The width in pixels
+		 * @param h The height in pixels
+		 * @param frame The frame number
+		 * @return False if the frame was dropped */
+		bool push(unsigned char const *rgba, unsigned w, unsigned h,
+				unsigned frame);
+		/** @brief Writes every queued frame and stops the writer. */
+		void close(void);
+
+		/** @brief The number of frames written, dropped, and waiting. */
+		unsigned written(void) const;
+		unsigned dropped(void) const;
+		std::size_t backlog(void) const;
+
+		/** @brief Opens the destination and starts the writer.
+		 * @param path The raw file, or the prefix of the PPM files
+		 * @param format The encoding
+		 * @param policy The handling of a full queue
+		 * @param depth The most frames waiting to be written
+		 * @param keys The key frame interval of a raw stream, with delta
+		 * frames between key frames; 1 writes key frames only */
+		Capture(std::string const& path, Format format = Format::raw,
+				Policy policy = Policy::drop_newest, std::size_t depth = 8,
+				unsigned keys = 1);
+		Capture(Capture const&) = delete;
+		Capture& operator=(Capture const&) = delete;
+		virtual ~Capture(void);
+	protected:
+		struct Frame {
+			std::vector<unsigned char> rgba;
+			unsigned width, height, frame;
+		};
+		void run(void);
+		bool write(Frame const& f);
+		bool write_ppm(Frame const& f);
+
+		std::string m_path;
+		Format m_format;
+		Policy m_policy;
+		std::size_t m_depth;
+		unsigned m_keys, m_written = 0, m_dropped = 0, m_since_key = 0;
+		bool m_closed = false, m_good = true;
+		std::ofstream m_out;
+		/* The previous frame written, for deltas, and the encoding. */
+		std::vector<unsigned char> m_previous, m_encoded;
+		unsigned m_prev_w = 0, m_prev_h = 0;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_ready, m_space;
+		std::deque<Frame> m_queue;
+		std::vector<std::vector<unsigned char>> m_free;
+		std::thread m_writer;
+	};
+
+	/** @brief Decodes the raw stream written by Capture. */
+	struct CaptureReader {
+		/** @brief True until the end of the stream or a malformed frame. */
+		explicit operator bool(void) const;
+		/** @brief Decodes the next frame.
+		 * @param rgba The destination, resized to the frame
+		 * @return False at the end of the stream or on error */
+		bool next(std::vector<unsigned char> &rgba, unsigned &w,
+				unsigned &h, unsigned &frame);
+
+		CaptureReader(std::string const& path);
+	protected:
+		std::ifstream m_in;
+		std::vector<unsigned char> m_previous, m_payload;
+		bool m_good;
+	};
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*! @file include/constant.hpp
+ *  @brief Constant-expression replacements for the math.h functions used
+ *  by the geometry core */
+
+#ifndef CONSTANT_HPP
+#define CONSTANT_HPP
+
+namespace Geometry {
+	namespace Constant {
+
+		constexpr long double pi = 3.141592653589793238462643383279502884L;
+
+		/** @brief Reduces an angle to [-pi, pi] by whole turns; angles of
+		 * 2^62 turns or more have no fraction of a turn left, and reduce
+		 * to 0, and NaN stays NaN. */
+		constexpr long double turns(long double x) {
+			constexpr long double most = 4611686018427387904.L;
+			long double k = x / (2 * pi);
+			// The conversion is only defined within the range of long long
+			if(!(k > -most && k < most)) return k == k ? 0 : x;
+			long long n = (long long)(k < 0 ? k - .5L : k + .5L);
+			return x - n * 2 * pi;
+		}
+
+		/* Taylor series over the reduced angle; for |x| <= pi the first
+		 * omitted term is below 1e-20, past the precision of long double. */
+		constexpr long double sine(long double x) {
+			x = turns(x);
+			long double x2 = x*x, term = x, sum = x;
+			for(unsigned i = 1; i < 18; i++) {
+				term *= -x2 / ((2*i) * (2*i + 1));
+				sum += term;
+			}
+			return sum;
+		}
+		constexpr long double cosine(long double x) {
+			x = turns(x);
+			long double x2 = x*x, term = 1, sum = 1;
+			for(unsigned i = 1; i < 18; i++) {
+				term *= -x2 / ((2*i - 1) * (2*i));
+				sum += term;
+			}
+			return sum;
+		}
+
+		/** @brief Sine usable in constant expressions.
+		 * @tparam T The domain and range
+		 * @param t The angle in radians */
+		template<typename T>
+		constexpr T sin(T const& t) { return T(sine(t)); }
+		/** @brief Cosine usable in constant expressions. */
+		template<typename T>
+		constexpr T cos(T const& t) { return T(cosine(t)); }
+
+		/** @brief Square root usable in constant expressions by Newton's
+		 * method; negative inputs give zero rather than NaN.
+		 * @tparam T The domain and range */
+		template<typename T>
+		constexpr T sqrt(T const& t) {
+			long double x = t, r = x > 1 ? x : 1;
+			if(!(x > 0)) return T(0);
+			// Decreases monotonically from above until it converges
+			for(;;) {
+				long double next = (r + x / r) / 2;
+				if(!(next < r)) return T(r);
+				r = next;
+			}
+		}
+	}
+}
+
+#endif
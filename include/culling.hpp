@@ -0,0 +1,61 @@
+/*! @file include/culling.hpp
+ *  @brief View frustum planes and batched visibility tests */
+
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include "geometry.hpp"
+#include "matrix.hpp"
+#include "batch.hpp"
+
+///@cond
+#include <cstddef>
+///@endcond
+
+namespace Geometry {
+
+	/**
+	 * @brief The six planes bounding the volume a projection keeps, each
+	 * as (a, b, c, d) with a unit normal facing inward, so that a point p
+	 * is inside when a p.x + b p.y + c p.z + d >= 0. Tests against the
+	 * planes alone are conservative: a volume outside the frustum but
+	 * straddling two planes near a corner is kept.
+	 */
+	struct Frustum {
+		/* front and back are the near and far planes, named apart from
+		 * Geometry::near. */
+		enum : unsigned { left, right, bottom, top, front, back, count };
+		float planes[count][4];
+
+		/** @brief A sphere that may be inside.
+		 * @param c The center
+		 * @param r The radius */
+		bool visible(Vec_t<float> const& c, float r) const;
+		/** @brief An axis-aligned box that may be inside.
+		 * @param lo The least corner
+		 * @param hi The greatest corner */
+		bool visible(Vec_t<float> const& lo, Vec_t<float> const& hi) const;
+
+		/** @brief Extracts the planes from the rows of clip space.
+		 * @param m A projection or model-view-projection applied as v*m,
+		 * as uploaded untransposed by Window::draw; the planes are in the
+		 * space of v */
+		Frustum(Matrix_t<float> const& m);
+	};
+
+	/** @brief Writes the indices of the spheres that may be visible.
+	 * @param f The frustum
+	 * @param centers The centers of the spheres
+	 * @param radii The radii, padded like centers
+	 * @param visible Room for centers.size() indices, written in order
+	 * @return The number of indices written */
+	std::size_t cull(Frustum const& f, VecBatch const& centers,
+			Simd::Array const& radii, unsigned *visible);
+	/** @brief Writes the indices of the boxes that may be visible.
+	 * @param lo The least corners of the boxes
+	 * @param hi The greatest corners, as many as lo */
+	std::size_t cull(Frustum const& f, VecBatch const& lo,
+			VecBatch const& hi, unsigned *visible);
+}
+
+#endif
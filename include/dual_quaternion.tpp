@@ -6,61 +6,30 @@
 
 namespace Geometry {
 	template<typename X>
-	Quat_t<X> DualQuat_t<X>::operator[](unsigned i) const {
+	constexpr Quat_t<X> DualQuat_t<X>::operator[](unsigned i) const {
 		return i ? v : u;
 	}
 	template<typename X> template<typename R>
-	DualQuat_t<X> DualQuat_t<X>::operator=(DualQuat_t<R> const& r) {
+	constexpr DualQuat_t<X> DualQuat_t<X>::operator=(DualQuat_t<R> const& r) {
 		u = r.u; v = r.v;
 		return *this;
 	}
-	template<typename X>
-	DualQuat_t<X> DualQuat_t<X>::operator*(void) const {
-		return {*u, *v};
-	}
-	template<typename X>
-	DualQuat_t<X> DualQuat_t<X>::operator-(void) const {
-		return {-u, -v};
-	}
-	template<typename X> template<typename R, typename XR>
-	DualQuat_t<XR> DualQuat_t<X>::operator+(DualQuat_t<R> const& r) const {
-		return {u + r.u, v + r.v};
-	}
-	template<typename X> template<typename R, typename XR>
-	DualQuat_t<XR> DualQuat_t<X>::operator-(DualQuat_t<R> const& r) const {
-		return {u - r.u, v - r.v};
-	}
 	template<typename X> template<typename R>
-	bool DualQuat_t<X>::operator==(DualQuat_t<R> const& r) const {
+	constexpr bool DualQuat_t<X>::operator==(DualQuat_t<R> const& r) const {
 		return u == r.u && v == r.v;
 	}
-	template<typename X> template<typename R, typename XR>
-	DualQuat_t<XR> DualQuat_t<X>::operator/(R const& r) const {
-		return {u/r, v/r};
-	}
 	template<typename L, typename R, typename LR>
-	LR dot(DualQuat_t<L> const& l, DualQuat_t<R> const& r) {
+	constexpr LR dot(DualQuat_t<L> const& l, DualQuat_t<R> const& r) {
 		return dot(l.u, r.u) + dot(l.v, r.v);
 	}
 	template<typename L, typename R, typename LR>
-	DualQuat_t<LR> operator*(DualQuat_t<L> const& l, DualQuat_t<R> const& r) {
-		return {l.u*r.u, l.u*r.v + l.v*r.u};
-	}
-	template<typename L, typename R, typename LR>
-	DualQuat_t<LR> operator*(DualQuat_t<L> const& l, Quat_t<R> const& r) {
-		return {l.u*r, l.v*r};
-	}
-	template<typename L, typename R, typename LR>
-	DualQuat_t<LR> operator*(L const& l, DualQuat_t<R> const& r) {
-		return {l*r.u, l*r.v};
-	}
-	template<typename L, typename R, typename LR>
-	DualQuat_t<LR> operator^(DualQuat_t<L> const& l, DualQuat_t<R> const& r) {
-		return DualQuat_t<LR>{l.u*r.u, l.u*r.v + l.v*r.u} * *l;
-	}
-	template<typename L, typename R, typename LR>
-	DualQuat_t<LR> operator^(DualQuat_t<L> const& l, Quat_t<R> const& r) {
-		return DualQuat_t<LR>{l.u*r, l.v*r} * *l;
+	constexpr Vec_t<LR> transform(DualQuat_t<L> const& l,
+			Vec_t<R> const& r) {
+		auto const &u = l.u, &v = l.v;
+		auto p = rotate(u, r);
+		return {LR(p.x + 2 * (u.w*v.x - v.w*u.x + u.y*v.z - u.z*v.y)),
+			LR(p.y + 2 * (u.w*v.y - v.w*u.y + u.z*v.x - u.x*v.z)),
+			LR(p.z + 2 * (u.w*v.z - v.w*u.z + u.x*v.y - u.y*v.x))};
 	}
 }
 
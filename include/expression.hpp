@@ -0,0 +1,224 @@
+/*! @file include/expression.hpp
+ *  @brief Expression templates fusing quaternion and dual quaternion
+ *  chains into one evaluation per conversion */
+
+#ifndef EXPRESSION_HPP
+#define EXPRESSION_HPP
+
+#include "geometry.hpp"
+
+///@cond
+#include <type_traits>
+///@endcond
+
+namespace Geometry {
+	namespace Expr {
+		/* Sums, differences, negations, conjugates, scales and quotients
+		 * are component-wise, so a chain of them is read one component at
+		 * a time straight from its leaves, with no temporaries; a quotient
+		 * becomes a scale by one reciprocal in floating point. Products
+		 * and sandwiches read every component of their operands, so each
+		 * is evaluated once, into a value, before the components of the
+		 * operations around it are read. */
+		struct Sum;
+		struct Difference;
+		struct Negate;
+		struct Conjugate;
+		struct Scale;
+		struct Quotient;
+		struct Product;
+		struct Sandwich;
+		/* The right operand of unary operations. */
+		struct None {};
+
+		/** @brief The value type of an operand of N components. */
+		template<unsigned N, typename X>
+		using Value = std::conditional_t<N == 4, Quat_t<X>, DualQuat_t<X>>;
+	}
+
+	/**
+	 * @brief A quaternion or dual quaternion operation deferred until the
+	 * node is converted to Quat_t or DualQuat_t, e.g. a*b*c or (a+b)/n.
+	 *
+	 * Quat_t and DualQuat_t operands are held by const reference and
+	 * nested nodes by value, so a node must not outlive the expression
+	 * that made it: assign it to a Quat_t or a DualQuat_t, not to auto.
+	 * @tparam OP The operation tag from Expr
+	 * @tparam L The left operand: a reference to a leaf, a node or a scalar
+	 * @tparam R The right operand, or Expr::None
+	 */
+	template<typename OP, typename L, typename R>
+	struct Node {
+		using result = typename OP::template Result<std::decay_t<L>,
+			std::decay_t<R>>;
+		/** @brief The component type of the value. */
+		using type = typename result::type;
+		/** @brief 4 for a quaternion, 8 for a dual quaternion. */
+		static constexpr unsigned size = result::size;
+		/** @brief Quat_t or DualQuat_t, as the node converts to. */
+		using value_type = Expr::Value<size, type>;
+
+		L l;
+		R r;
+
+		/** @brief A component, w, x, y, z of the real part then of the
+		 * dual part; for component-wise operations only. */
+		constexpr type operator[](unsigned i) const;
+	};
+
+	namespace Expr {
+		/** @brief The number of components of an operand, 4, 8, or 0 for
+		 * anything but quaternions, dual quaternions and their nodes;
+		 * also their component type and how a node holds them. */
+		template<typename T>
+		struct Traits {
+			static constexpr unsigned size = 0;
+		};
+		template<typename X>
+		struct Traits<Quat_t<X>> {
+			static constexpr unsigned size = 4;
+			using type = X;
+			using held = Quat_t<X> const&;
+		};
+		template<typename X>
+		struct Traits<DualQuat_t<X>> {
+			static constexpr unsigned size = 8;
+			using type = X;
+			using held = DualQuat_t<X> const&;
+		};
+		template<typename OP, typename L, typename R>
+		struct Traits<Node<OP, L, R>> {
+			static constexpr unsigned size = Node<OP, L, R>::size;
+			using type = typename Node<OP, L, R>::type;
+			using held = Node<OP, L, R>;
+		};
+		template<typename T>
+		using Type = typename Traits<T>::type;
+		template<typename T>
+		using Held = typename Traits<T>::held;
+
+		template<typename T>
+		struct Is_node: std::false_type {};
+		template<typename OP, typename L, typename R>
+		struct Is_node<Node<OP, L, R>>: std::true_type {};
+
+		/* True if the operands take a sum or a difference. */
+		template<typename L, typename R>
+		using Alike = std::integral_constant<bool,
+			Traits<L>::size && Traits<L>::size == Traits<R>::size>;
+		/* True if the operands take a product or a sandwich; a quaternion
+		 * right of a dual quaternion is taken as its real part. */
+		template<typename L, typename R>
+		using Multiplies = std::integral_constant<bool, Traits<L>::size
+			&& (Traits<R>::size == Traits<L>::size || Traits<R>::size == 4)>;
+
+		/* Replaces every product and sandwich in a tree by its value,
+		 * leaving the component-wise nodes to be read; leaves and scalars
+		 * pass through. */
+		template<typename X>
+		constexpr Quat_t<X> const& prepare(Quat_t<X> const& q);
+		template<typename X>
+		constexpr DualQuat_t<X> const& prepare(DualQuat_t<X> const& q);
+		template<typename S>
+		constexpr std::enable_if_t<std::is_arithmetic<S>::value, S>
+		prepare(S const& s);
+		constexpr None prepare(None const& n);
+		template<typename OP, typename L, typename R>
+		constexpr auto prepare(Node<OP, L, R> const& n);
+		template<typename T>
+		using Prepared = decltype(prepare(std::declval<T const&>()));
+
+		/* The value of a prepared operand; a leaf is not copied. */
+		template<typename X>
+		constexpr Quat_t<X> const& value(Quat_t<X> const& q);
+		template<typename X>
+		constexpr DualQuat_t<X> const& value(DualQuat_t<X> const& q);
+		template<typename OP, typename L, typename R>
+		constexpr Value<Node<OP, L, R>::size, typename Node<OP, L, R>::type>
+		value(Node<OP, L, R> const& n);
+
+		/* A component of a prepared operand. */
+		template<typename X>
+		constexpr X at(Quat_t<X> const& q, unsigned i);
+		template<typename X>
+		constexpr X at(DualQuat_t<X> const& q, unsigned i);
+		template<typename OP, typename L, typename R>
+		constexpr typename Node<OP, L, R>::type
+		at(Node<OP, L, R> const& n, unsigned i);
+
+		/* Converts the components of a value. */
+		template<typename X, typename Y>
+		constexpr Quat_t<X> convert(Quat_t<Y> const& q);
+		template<typename X, typename Y>
+		constexpr DualQuat_t<X> convert(DualQuat_t<Y> const& q);
+
+		/** @brief Evaluates a node once; a leaf passes through. */
+		template<typename X>
+		constexpr Quat_t<X> const& evaluate(Quat_t<X> const& q);
+		template<typename X>
+		constexpr DualQuat_t<X> const& evaluate(DualQuat_t<X> const& q);
+		template<typename OP, typename L, typename R>
+		constexpr Value<Node<OP, L, R>::size, typename Node<OP, L, R>::type>
+		evaluate(Node<OP, L, R> const& n);
+	}
+
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Alike<L, R>::value,
+		Node<Expr::Sum, Expr::Held<L>, Expr::Held<R>>>
+	operator+(L const& l, R const& r);
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Alike<L, R>::value,
+		Node<Expr::Difference, Expr::Held<L>, Expr::Held<R>>>
+	operator-(L const& l, R const& r);
+	template<typename E>
+	constexpr std::enable_if_t<bool(Expr::Traits<E>::size),
+		Node<Expr::Negate, Expr::Held<E>, Expr::None>>
+	operator-(E const& e);
+	/// @brief The conjugate; of both parts, for a dual quaternion.
+	template<typename E>
+	constexpr std::enable_if_t<bool(Expr::Traits<E>::size),
+		Node<Expr::Conjugate, Expr::Held<E>, Expr::None>>
+	operator*(E const& e);
+	/// @brief Scales each component.
+	template<typename L, typename R>
+	constexpr std::enable_if_t<std::is_arithmetic<L>::value
+		&& Expr::Traits<R>::size, Node<Expr::Scale, L, Expr::Held<R>>>
+	operator*(L const& l, R const& r);
+	/// @brief Divides each component, by one reciprocal in floating point.
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Traits<L>::size
+		&& std::is_arithmetic<R>::value,
+		Node<Expr::Quotient, Expr::Held<L>, R>>
+	operator/(L const& l, R const& r);
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Multiplies<L, R>::value,
+		Node<Expr::Product, Expr::Held<L>, Expr::Held<R>>>
+	operator*(L const& l, R const& r);
+	/// @brief The 'conjugacy' or 'sandwich product', A^B := ABA*, in
+	/// closed form without the product AB or its cancelling terms; a lone
+	/// quaternion B right of a dual quaternion A is taken as B + e0.
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Multiplies<L, R>::value,
+		Node<Expr::Sandwich, Expr::Held<L>, Expr::Held<R>>>
+	operator^(L const& l, R const& r);
+	/// @brief The sandwich product of a pure quaternion, A^v := AvA*; it
+	/// ends a chain, so the result is a value, e.g. for (q ^ v).x.
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Traits<L>::size == 4,
+		Quat_t<COMBINE(Expr::Type<L>,*,R)>>
+	operator^(L const& l, Vec_t<R> const& r);
+
+	/// @brief The dot product of operands of which at least one is a node,
+	/// each evaluated once.
+	template<typename L, typename R>
+	constexpr std::enable_if_t<(Expr::Is_node<L>::value
+		|| Expr::Is_node<R>::value) && Expr::Alike<L, R>::value,
+		COMBINE(Expr::Type<L>,*,Expr::Type<R>)>
+	dot(L const& l, R const& r);
+	/// @brief Normalizes the value of a node, evaluated once.
+	template<typename OP, typename L, typename R>
+	Expr::Value<Node<OP, L, R>::size, typename Node<OP, L, R>::type>
+	normalize(Node<OP, L, R> const& n);
+}
+
+#endif
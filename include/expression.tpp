@@ -0,0 +1,372 @@
+/*! @file include/expression.tpp
+ *  @brief Implementation for include/expression.hpp */
+
+#ifndef EXPRESSION_TPP
+#define EXPRESSION_TPP
+
+namespace Geometry {
+	namespace Expr {
+		/* Makes a component-wise node of prepared operands. */
+		template<typename OP, typename L, typename R>
+		constexpr Node<OP, Prepared<L>, Prepared<R>>
+		lazy(L const& l, R const& r) {
+			return {Expr::prepare(l), Expr::prepare(r)};
+		}
+
+		struct Sum {
+			template<typename L, typename R>
+			struct Result {
+				static constexpr unsigned size = Traits<L>::size;
+				using type = COMBINE(Type<L>,+,Type<R>);
+			};
+			template<typename L, typename R>
+			static constexpr auto at(L const& l, R const& r, unsigned i) {
+				return Expr::at(l, i) + Expr::at(r, i);
+			}
+			template<typename L, typename R>
+			static constexpr auto prepare(L const& l, R const& r) {
+				return lazy<Sum>(l, r);
+			}
+		};
+		struct Difference {
+			template<typename L, typename R>
+			struct Result {
+				static constexpr unsigned size = Traits<L>::size;
+				using type = COMBINE(Type<L>,-,Type<R>);
+			};
+			template<typename L, typename R>
+			static constexpr auto at(L const& l, R const& r, unsigned i) {
+				return Expr::at(l, i) - Expr::at(r, i);
+			}
+			template<typename L, typename R>
+			static constexpr auto prepare(L const& l, R const& r) {
+				return lazy<Difference>(l, r);
+			}
+		};
+		struct Negate {
+			template<typename L, typename R>
+			struct Result {
+				static constexpr unsigned size = Traits<L>::size;
+				using type = Type<L>;
+			};
+			template<typename L>
+			static constexpr auto at(L const& l, None const&, unsigned i) {
+				return -Expr::at(l, i);
+			}
+			template<typename L>
+			static constexpr auto prepare(L const& l, None const& r) {
+				return lazy<Negate>(l, r);
+			}
+		};
+		/* Negates every component but the real ones, w of u and of v. */
+		struct Conjugate {
+			template<typename L, typename R>
+			struct Result {
+				static constexpr unsigned size = Traits<L>::size;
+				using type = Type<L>;
+			};
+			template<typename L>
+			static constexpr auto at(L const& l, None const&, unsigned i) {
+				return i % 4 ? -Expr::at(l, i) : Expr::at(l, i);
+			}
+			template<typename L>
+			static constexpr auto prepare(L const& l, None const& r) {
+				return lazy<Conjugate>(l, r);
+			}
+		};
+		/* A scalar left of an operand. */
+		struct Scale {
+			template<typename L, typename R>
+			struct Result {
+				static constexpr unsigned size = Traits<R>::size;
+				using type = COMBINE(L,*,Type<R>);
+			};
+			template<typename L, typename R>
+			static constexpr auto at(L const& l, R const& r, unsigned i) {
+				return l * Expr::at(r, i);
+			}
+			template<typename L, typename R>
+			static constexpr auto prepare(L const& l, R const& r) {
+				return lazy<Scale>(l, r);
+			}
+		};
+		/* An operand over a scalar; prepared as a scale by the reciprocal
+		 * when the quotient is floating point. */
+		struct Quotient {
+			template<typename L, typename R>
+			struct Result {
+				static constexpr unsigned size = Traits<L>::size;
+				using type = COMBINE(Type<L>,/,R);
+			};
+			template<typename L, typename R>
+			static constexpr auto at(L const& l, R const& r, unsigned i) {
+				return Expr::at(l, i) / r;
+			}
+			template<typename L, typename R>
+			static constexpr auto prepare(L const& l, R const& r) {
+				using LR = typename Result<L, R>::type;
+				return prepare(l, r, std::is_floating_point<LR>{});
+			}
+			template<typename L, typename R>
+			static constexpr auto prepare(L const& l, R const& r,
+					std::true_type) {
+				using LR = typename Result<L, R>::type;
+				return lazy<Scale>(LR(1) / LR(r), l);
+			}
+			template<typename L, typename R>
+			static constexpr auto prepare(L const& l, R const& r,
+					std::false_type) {
+				return lazy<Quotient>(l, r);
+			}
+		};
+		/* The Hamilton product; of dual quaternions, (a, b)(c, d) is
+		 * (ac, ad + bc), and a lone quaternion c is taken as (c, 0). */
+		struct Product {
+			template<typename L, typename R>
+			struct Result {
+				static constexpr unsigned size = Traits<L>::size;
+				using type = COMBINE(Type<L>,*,Type<R>);
+			};
+			template<typename L, typename R>
+			static constexpr auto prepare(L const& l, R const& r) {
+				return apply(Expr::value(Expr::prepare(l)),
+					Expr::value(Expr::prepare(r)));
+			}
+			template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+			static constexpr Quat_t<LR> apply(Quat_t<L> const& l,
+					Quat_t<R> const& r) {
+				return {
+					LR(l.w * r.w - l.x * r.x - l.y * r.y - l.z * r.z),
+					LR(l.w * r.x + l.x * r.w + l.y * r.z - l.z * r.y),
+					LR(l.w * r.y - l.x * r.z + l.y * r.w + l.z * r.x),
+					LR(l.w * r.z + l.x * r.y - l.y * r.x + l.z * r.w)
+				};
+			}
+			template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+			static constexpr DualQuat_t<LR> apply(DualQuat_t<L> const& l,
+					DualQuat_t<R> const& r) {
+				return {apply(l.u, r.u), apply(l.u, r.v) + apply(l.v, r.u)};
+			}
+			template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+			static constexpr DualQuat_t<LR> apply(DualQuat_t<L> const& l,
+					Quat_t<R> const& r) {
+				return {apply(l.u, r), apply(l.v, r)};
+			}
+		};
+		struct Sandwich {
+			template<typename L, typename R>
+			struct Result {
+				static constexpr unsigned size = Traits<L>::size;
+				using type = COMBINE(Type<L>,*,Type<R>);
+			};
+			template<typename L, typename R>
+			static constexpr auto prepare(L const& l, R const& r) {
+				return apply(Expr::value(Expr::prepare(l)),
+					Expr::value(Expr::prepare(r)));
+			}
+			/* q v q* = (w^2 - u.u) v + 2 (u.v) u + 2w (u x v), exact for
+			 * any q. */
+			template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+			static constexpr Quat_t<LR> apply(Quat_t<L> const& l,
+					Vec_t<R> const& r) {
+				LR uv = l.x*r.x + l.y*r.y + l.z*r.z,
+				   a = l.w*l.w - (l.x*l.x + l.y*l.y + l.z*l.z),
+				   b = uv + uv, c = l.w + l.w;
+				return {LR(0),
+					LR(a*r.x + b*l.x + c*(l.y*r.z - l.z*r.y)),
+					LR(a*r.y + b*l.y + c*(l.z*r.x - l.x*r.z)),
+					LR(a*r.z + b*l.z + c*(l.x*r.y - l.y*r.x))};
+			}
+			/* The real part of q r q* is |q|^2 r.w. */
+			template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+			static constexpr Quat_t<LR> apply(Quat_t<L> const& l,
+					Quat_t<R> const& r) {
+				auto s = apply(l, Vec_t<R>{r.x, r.y, r.z});
+				s.w = LR(l.magnitude2() * r.w);
+				return s;
+			}
+			/* With A = (a, b) and a lone quaternion r, ABA* expands to
+			 * (a r a*, (a r) b* + b (r a*)), sharing a r between both
+			 * parts. */
+			template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+			static constexpr DualQuat_t<LR> apply(DualQuat_t<L> const& l,
+					Quat_t<R> const& r) {
+				auto ar = Product::apply(l.u, r);
+				return {Product::apply(ar, Quat_t<L>(*l.u)),
+					Product::apply(ar, Quat_t<L>(*l.v))
+						+ Product::apply(l.v,
+							Product::apply(r, Quat_t<L>(*l.u)))};
+			}
+			/* B = (r, s) adds a s a* to the dual part. */
+			template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+			static constexpr DualQuat_t<LR> apply(DualQuat_t<L> const& l,
+					DualQuat_t<R> const& r) {
+				DualQuat_t<LR> out = apply(l, r.u);
+				out.v = out.v + apply(l.u, r.v);
+				return out;
+			}
+		};
+
+		template<typename X>
+		constexpr Quat_t<X> const& prepare(Quat_t<X> const& q) {
+			return q;
+		}
+		template<typename X>
+		constexpr DualQuat_t<X> const& prepare(DualQuat_t<X> const& q) {
+			return q;
+		}
+		template<typename S>
+		constexpr std::enable_if_t<std::is_arithmetic<S>::value, S>
+		prepare(S const& s) {
+			return s;
+		}
+		constexpr None prepare(None const& n) {
+			return n;
+		}
+		template<typename OP, typename L, typename R>
+		constexpr auto prepare(Node<OP, L, R> const& n) {
+			return OP::prepare(n.l, n.r);
+		}
+
+		template<typename X>
+		constexpr Quat_t<X> const& value(Quat_t<X> const& q) {
+			return q;
+		}
+		template<typename X>
+		constexpr DualQuat_t<X> const& value(DualQuat_t<X> const& q) {
+			return q;
+		}
+		/* Reads each component of a prepared node once. */
+		template<typename N>
+		constexpr Quat_t<typename N::type> materialize(N const& n,
+				std::integral_constant<unsigned, 4>) {
+			return {n[0], n[1], n[2], n[3]};
+		}
+		template<typename N>
+		constexpr DualQuat_t<typename N::type> materialize(N const& n,
+				std::integral_constant<unsigned, 8>) {
+			return {{n[0], n[1], n[2], n[3]}, {n[4], n[5], n[6], n[7]}};
+		}
+		template<typename OP, typename L, typename R>
+		constexpr Value<Node<OP, L, R>::size, typename Node<OP, L, R>::type>
+		value(Node<OP, L, R> const& n) {
+			return materialize(n, std::integral_constant<unsigned,
+				Node<OP, L, R>::size>{});
+		}
+
+		template<typename X>
+		constexpr X at(Quat_t<X> const& q, unsigned i) {
+			return q[i];
+		}
+		template<typename X>
+		constexpr X at(DualQuat_t<X> const& q, unsigned i) {
+			return i < 4 ? q.u[i] : q.v[i - 4];
+		}
+		template<typename OP, typename L, typename R>
+		constexpr typename Node<OP, L, R>::type
+		at(Node<OP, L, R> const& n, unsigned i) {
+			return n[i];
+		}
+
+		template<typename X, typename Y>
+		constexpr Quat_t<X> convert(Quat_t<Y> const& q) {
+			return {X(q.w), X(q.x), X(q.y), X(q.z)};
+		}
+		template<typename X, typename Y>
+		constexpr DualQuat_t<X> convert(DualQuat_t<Y> const& q) {
+			return {convert<X>(q.u), convert<X>(q.v)};
+		}
+
+		template<typename X>
+		constexpr Quat_t<X> const& evaluate(Quat_t<X> const& q) {
+			return q;
+		}
+		template<typename X>
+		constexpr DualQuat_t<X> const& evaluate(DualQuat_t<X> const& q) {
+			return q;
+		}
+		template<typename OP, typename L, typename R>
+		constexpr Value<Node<OP, L, R>::size, typename Node<OP, L, R>::type>
+		evaluate(Node<OP, L, R> const& n) {
+			return Expr::value(Expr::prepare(n));
+		}
+	}
+
+	template<typename OP, typename L, typename R>
+	constexpr typename Node<OP, L, R>::type
+	Node<OP, L, R>::operator[](unsigned i) const {
+		return type(OP::at(l, r, i));
+	}
+
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Alike<L, R>::value,
+		Node<Expr::Sum, Expr::Held<L>, Expr::Held<R>>>
+	operator+(L const& l, R const& r) {
+		return {l, r};
+	}
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Alike<L, R>::value,
+		Node<Expr::Difference, Expr::Held<L>, Expr::Held<R>>>
+	operator-(L const& l, R const& r) {
+		return {l, r};
+	}
+	template<typename E>
+	constexpr std::enable_if_t<bool(Expr::Traits<E>::size),
+		Node<Expr::Negate, Expr::Held<E>, Expr::None>>
+	operator-(E const& e) {
+		return {e, {}};
+	}
+	template<typename E>
+	constexpr std::enable_if_t<bool(Expr::Traits<E>::size),
+		Node<Expr::Conjugate, Expr::Held<E>, Expr::None>>
+	operator*(E const& e) {
+		return {e, {}};
+	}
+	template<typename L, typename R>
+	constexpr std::enable_if_t<std::is_arithmetic<L>::value
+		&& Expr::Traits<R>::size, Node<Expr::Scale, L, Expr::Held<R>>>
+	operator*(L const& l, R const& r) {
+		return {l, r};
+	}
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Traits<L>::size
+		&& std::is_arithmetic<R>::value,
+		Node<Expr::Quotient, Expr::Held<L>, R>>
+	operator/(L const& l, R const& r) {
+		return {l, r};
+	}
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Multiplies<L, R>::value,
+		Node<Expr::Product, Expr::Held<L>, Expr::Held<R>>>
+	operator*(L const& l, R const& r) {
+		return {l, r};
+	}
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Multiplies<L, R>::value,
+		Node<Expr::Sandwich, Expr::Held<L>, Expr::Held<R>>>
+	operator^(L const& l, R const& r) {
+		return {l, r};
+	}
+	template<typename L, typename R>
+	constexpr std::enable_if_t<Expr::Traits<L>::size == 4,
+		Quat_t<COMBINE(Expr::Type<L>,*,R)>>
+	operator^(L const& l, Vec_t<R> const& r) {
+		return Expr::Sandwich::apply(Expr::evaluate(l), r);
+	}
+
+	template<typename L, typename R>
+	constexpr std::enable_if_t<(Expr::Is_node<L>::value
+		|| Expr::Is_node<R>::value) && Expr::Alike<L, R>::value,
+		COMBINE(Expr::Type<L>,*,Expr::Type<R>)>
+	dot(L const& l, R const& r) {
+		return dot(Expr::evaluate(l), Expr::evaluate(r));
+	}
+	template<typename OP, typename L, typename R>
+	Expr::Value<Node<OP, L, R>::size, typename Node<OP, L, R>::type>
+	normalize(Node<OP, L, R> const& n) {
+		auto x = Expr::evaluate(n);
+		return x / magnitude(x);
+	}
+}
+
+#endif
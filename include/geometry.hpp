@@ -24,30 +24,31 @@ namespace Geometry {
 
 	template<typename> struct Quat_t;
 	template<typename> struct DualQuat_t;
+	template<typename, typename, typename> struct Node;
 
 	template<typename X>
 	struct Vec_t {
 		X x, y, z;
-		X operator[](unsigned char r) const;
+		constexpr X operator[](unsigned char r) const;
 
-		//X magnitude2(void) const;
-		//X magnitude(void) const;
-		//Vec_t<X> normalize(void) const;
+		constexpr X magnitude2(void) const;
+		X magnitude(void) const;
+		Vec_t<X> normalize(void) const;
 
 		template<typename R>
-		bool operator==(Vec_t<R> const& r) const;
+		constexpr bool operator==(Vec_t<R> const& r) const;
 
 		template<typename R, typename XR = COMBINE(X,-,R)>
-		Vec_t<XR> operator-(Vec_t<R> const& r) const;
+		constexpr Vec_t<XR> operator-(Vec_t<R> const& r) const;
 
 		template<typename R, typename XR = COMBINE(X,/,R)>
-		Vec_t<XR> operator/(R const& r) const;
+		constexpr Vec_t<XR> operator/(R const& r) const;
 	};
 
 	template<typename X>
-	X magnitude2(X const& x);
+	constexpr auto magnitude2(X const& x) -> decltype(dot(x, x));
 	template<typename X>
-	X magnitude(X const& x);
+	auto magnitude(X const& x) -> decltype(dot(x, x));
 	template<typename X>
 	X normalize(X const& x);
 
@@ -64,7 +65,8 @@ namespace Geometry {
 	template<typename R, typename S = R, typename T = S,
 		typename RS = COMBINE(R,-,S), typename ST = COMBINE(T,-,S),
 		typename RST = COMBINE(RS,*,ST)>
-	Vec_t<RST> cross(Vec_t<R> const& l, Vec_t<S> const& c, Vec_t<T> const& r);
+	constexpr Vec_t<RST> cross(Vec_t<R> const& l,
+			Vec_t<S> const& c, Vec_t<T> const& r);
 
 	/**
 	 * @brief The dot or inner product of two vectors.
@@ -75,14 +77,14 @@ namespace Geometry {
 	 */
 	template<typename L, typename R = L,
 		typename LR = COMBINE(L,*,R)>
-	Vec_t<LR> dot(Vec_t<L> const& l, Vec_t<R> const& r);
+	constexpr LR dot(Vec_t<L> const& l, Vec_t<R> const& r);
 
 	template<typename L, typename R, typename LR = COMBINE(L,*,R)>
-	Vec_t<LR> operator*(Vec_t<L> const& l, Vec_t<R> const& r);
+	constexpr Vec_t<LR> operator*(Vec_t<L> const& l, Vec_t<R> const& r);
 	template<typename L, typename R, typename LR = COMBINE(L,*,R)>
-	Vec_t<LR> operator*(Vec_t<R> const& l, L const& r);
+	constexpr Vec_t<LR> operator*(Vec_t<R> const& l, L const& r);
 	template<typename L, typename R, typename LR = COMBINE(L,*,R)>
-	Vec_t<LR> operator*(L const& l, Vec_t<R> const& r);
+	constexpr Vec_t<LR> operator*(L const& l, Vec_t<R> const& r);
 
 	/**
 	 * @brief Fuzzy comparison to zero (avoids division due to aliasing)
@@ -93,7 +95,7 @@ namespace Geometry {
 	 * multiplication with the given or default proximity
 	 */
 	template<typename L>
-	bool nearZero(L const& l, unsigned prox = TOLERANCE);
+	constexpr bool nearZero(L const& l, unsigned prox = TOLERANCE);
 	/**
 	 * @brief Rounds to zero by fuzzy comparison
 	 * @tparam T The domain of the value to round
@@ -102,7 +104,7 @@ namespace Geometry {
 	 * @return A copy of t, or zero if t is within prox of zero
 	 */
 	template<typename T>
-	T roundNearZero(T const& t, unsigned prox = TOLERANCE);
+	constexpr T roundNearZero(T const& t, unsigned prox = TOLERANCE);
 	/**
 	 * @brief Fuzzy comparison of multidimensional values
 	 * @tparam L Type of the subject with magnitude method
@@ -6,12 +6,12 @@
 
 namespace Geometry {
 	template<typename X>
-	X magnitude2(X const& x) {
+	constexpr auto magnitude2(X const& x) -> decltype(dot(x, x)) {
 		return dot(x, x);
 	}
 	template<typename X>
-	X magnitude(X const& x) {
-		return X(sqrt(magnitude2(x)));
+	auto magnitude(X const& x) -> decltype(dot(x, x)) {
+		return decltype(dot(x, x))(sqrt(magnitude2(x)));
 	}
 	template<typename X>
 	X normalize(X const& x) {
@@ -19,7 +19,7 @@ namespace Geometry {
 	}
 
 	template<typename X>
-	X Vec_t<X>::operator[](unsigned char r) const {
+	constexpr X Vec_t<X>::operator[](unsigned char r) const {
 		switch(r) {
 			case 'i': case 'x': return x;
 			case 'j': case 'y': return y;
@@ -27,10 +27,9 @@ namespace Geometry {
 			default: return 0;
 		}
 	}
-	/*template<typename X>
-	X Vec_t<X>::magnitude2(void) const {
-		return dot(*this, *this);
-		//return x*x + y*y + z*z;
+	template<typename X>
+	constexpr X Vec_t<X>::magnitude2(void) const {
+		return x*x + y*y + z*z;
 	}
 	template<typename X>
 	X Vec_t<X>::magnitude(void) const {
@@ -39,48 +38,47 @@ namespace Geometry {
 	template<typename X>
 	Vec_t<X> Vec_t<X>::normalize(void) const {
 		return *this / magnitude();
-	}*/
+	}
 	template<typename X>
 	template<typename R, typename XR>
-	Vec_t<XR> Vec_t<X>::operator-(Vec_t<R> const& r) const {
+	constexpr Vec_t<XR> Vec_t<X>::operator-(Vec_t<R> const& r) const {
 		return {x-r.x, y-r.y, z-r.z};
 	}
 	template<typename X>
 	template<typename R>
-	bool Vec_t<X>::operator==(Vec_t<R> const& r) const {
+	constexpr bool Vec_t<X>::operator==(Vec_t<R> const& r) const {
 		return x == r.x && y == r.y && z == r.z;
 	}
 	template<typename X>
 	template<typename R, typename XR>
-	Vec_t<XR> Vec_t<X>::operator/(R const& r) const {
+	constexpr Vec_t<XR> Vec_t<X>::operator/(R const& r) const {
 		return {x/r, y/r, z/r};
 	}
 
 	template<typename R, typename S, typename T,
 		typename RS, typename ST, typename RST>
-	Vec_t<RST> cross(Vec_t<R> const& l,
+	constexpr Vec_t<RST> cross(Vec_t<R> const& l,
 			Vec_t<S> const& c, Vec_t<T> const& r) {
 		return (l-c)*(r-c);
 	}
-	template<typename L, typename R = L,
-		typename LR = COMBINE(L,*,R)>
-	Vec_t<LR> dot(Vec_t<L> const& l, Vec_t<R> const& r) {
+	template<typename L, typename R, typename LR>
+	constexpr LR dot(Vec_t<L> const& l, Vec_t<R> const& r) {
 		return l.x*r.x + l.y*r.y + l.z*r.z;
 	}
 
 
 	template<typename L, typename R, typename LR>
-	Vec_t<LR> operator*(Vec_t<L> const& l, Vec_t<R> const& r) {
+	constexpr Vec_t<LR> operator*(Vec_t<L> const& l, Vec_t<R> const& r) {
 		return {LR(l.y * r.z - l.z * r.y),
 			LR(l.z * r.x - l.x * r.z),
 			LR(l.x * r.y - l.y * r.x)};
 	}
 	template<typename L, typename R, typename LR>
-	Vec_t<LR> operator*(Vec_t<R> const& l, L const& r) {
+	constexpr Vec_t<LR> operator*(Vec_t<R> const& l, L const& r) {
 		return {l.x*r, l.y*r, l.z*r};
 	}
 	template<typename L, typename R, typename LR>
-	Vec_t<LR> operator*(L const& l, Vec_t<R> const& r) {
+	constexpr Vec_t<LR> operator*(L const& l, Vec_t<R> const& r) {
 		return r * l;
 	}
 
@@ -93,7 +91,7 @@ namespace Geometry {
 	 * multiplication with the given or default proximity
 	 */
 	template<typename L>
-	bool nearZero(L const& l, unsigned prox) {
+	constexpr bool nearZero(L const& l, unsigned prox) {
 		auto lp = l * prox;
 		return lp >= -1 && lp <= 1;
 	}
@@ -105,7 +103,7 @@ namespace Geometry {
 	 * @return A copy of t, or zero if t is within prox of zero
 	 */
 	template<typename T>
-	T roundNearZero(T const& t, unsigned prox) {
+	constexpr T roundNearZero(T const& t, unsigned prox) {
 		return nearZero(t, prox) ? T(0) : t;
 	}
 	/**
@@ -5,6 +5,7 @@
 #define GLSL_HPP
 
 #include "view.hpp"
+#include "state.hpp"
 
 namespace View {
 	namespace Shaders {
@@ -44,6 +45,16 @@ namespace View {
 		/** @brief Returns the log associated with the deduced object. */
 		std::string queryInfo(GLuint id);
 
+		/** @brief The uniform buffer binding point of every block with the
+		 * given name, in every program; assigned on first use.
+		 * @param name The block name, e.g. Frame
+		 * @return The binding point, shared across programs */
+		GLuint blockBinding(std::string const& name);
+		/** @brief Binds each active uniform block of a linked program to
+		 * the shared binding point of its name.
+		 * @return The number of blocks bound */
+		GLint bindBlocks(GLuint id);
+
 
 		/** @brief RAII shader alloc/source/compile/dealloc */
 		struct Shader {
@@ -70,16 +81,23 @@ namespace View {
 			Shader shaders[N] = {{E0}, {EN}...};
 			const GLenum types[N] = {E0, EN...};
 			GLint uniform(const GLchar *name) const;
+			/** @brief The index of a uniform block, or GL_INVALID_INDEX;
+			 * build() binds blocks to their shared binding points. */
+			GLuint block(const GLchar *name) const;
 			operator GLuint(void) const;
 			Shader& operator[](unsigned index);
 			Shader const& operator[](unsigned index) const;
 			bool build(void) const;
 			std::string info(void) const;
+			/** @brief Makes the program current unless it already is; the
+			 * link status is queried once, not on every use. */
 			bool use(void) const;
 			template<typename T0, typename... TN>
 			Program(T0 const& t0, TN const&... tn):
 				Shader(), shaders{Shader(E0, t0), Shader(EN, tn)...} {}
 			// TODO detach shaders from destructor?
+		protected:
+			mutable bool m_linked = false;
 		};
 	}
 }
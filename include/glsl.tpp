@@ -11,6 +11,10 @@ namespace View {
 			return glGetUniformLocation(m_id, name);
 		}
 		template<GLenum E0, GLenum... EN>
+		GLuint Program<E0, EN...>::block(const GLchar *name) const {
+			return glGetUniformBlockIndex(m_id, name);
+		}
+		template<GLenum E0, GLenum... EN>
 		Program<E0, EN...>::operator GLuint(void) const {
 			return m_id;
 		}
@@ -39,8 +43,9 @@ namespace View {
 			}
 			glLinkProgram(m_id);
 			// TODO detach on link failure?
-			if(!programAssertIv(m_id, GL_LINK_STATUS, GLint(GL_TRUE)))
-				return false;
+			m_linked = programAssertIv(m_id, GL_LINK_STATUS, GLint(GL_TRUE));
+			if(!m_linked) return false;
+			bindBlocks(m_id);
 			glValidateProgram(m_id);
 			return programAssertIv(m_id,
 				GL_VALIDATE_STATUS, GLint(GL_TRUE));
@@ -54,9 +59,10 @@ namespace View {
 		}
 		template<GLenum E0, GLenum... EN>
 		bool Program<E0, EN...>::use(void) const {
-			if(!programAssertIv(m_id, GL_LINK_STATUS, GLint(GL_TRUE)))
+			if(!m_linked && !(m_linked = programAssertIv(m_id,
+					GL_LINK_STATUS, GLint(GL_TRUE))))
 				return false;
-			glUseProgram(m_id);
+			State::current().program(m_id);
 			return true;
 		}
 	}
@@ -0,0 +1,71 @@
+/*! @file include/hierarchy.hpp
+ *  @brief Parent/child rigid transforms in flat arrays, updated lazily */
+
+#ifndef HIERARCHY_HPP
+#define HIERARCHY_HPP
+
+#include "model.hpp"
+#include "dual_quaternion.hpp"
+
+///@cond
+#include <vector>
+///@endcond
+
+namespace Model {
+	using Geometry::DualQuat_t;
+
+	/**
+	 * @brief A forest of rigid transforms, where each node's world transform
+	 * is its parent's world transform times its local transform.
+	 *
+	 * Nodes are named by the order they were added in, which is
+	 * topological since parents come first. Storage is kept in depth-first
+	 * order instead, so that every subtree is one contiguous run whose
+	 * parents precede their children. An update walks only the runs under
+	 * nodes changed since the last update, once each, so a frame costs the
+	 * size of the changed subtrees rather than the size of the scene.
+	 * Adding nodes re-lays the arrays out on the next update.
+	 */
+	struct Hierarchy: ModelBase<Hierarchy> {
+		/** @brief The parent of a root. */
+		static constexpr unsigned none = ~0u;
+
+		/** @brief The number of nodes. */
+		std::size_t size(void) const;
+		/** @brief Adds a node, dirty until the next update.
+		 * @param local The transform relative to the parent
+		 * @param parent An existing node, or none for a new root
+		 * @return The new node */
+		unsigned add(DualQuat_t<float> const& local, unsigned parent = none);
+		/** @brief The parent of node i, or none. */
+		unsigned parent(unsigned i) const;
+		/** @brief The transform of node i relative to its parent. */
+		DualQuat_t<float> const& local(unsigned i) const;
+		/** @brief Replaces the local transform of node i, marking its
+		 * subtree for the next update. */
+		void set(unsigned i, DualQuat_t<float> const& local);
+		/** @brief The world transform of node i as of the last update. */
+		DualQuat_t<float> const& world(unsigned i) const;
+		/** @brief Recomputes the world transforms of changed subtrees.
+		 * @return True if and only if any world transform was recomputed */
+		bool update(void);
+	protected:
+		/* Sorts the slots depth-first, given that parents precede their
+		 * children, and recomputes every world transform. */
+		void layout(void);
+
+		/* By node: the storage slot and the parent node. */
+		std::vector<unsigned> m_slot, m_up;
+		/* By slot: the parent slot (or none), the end of the subtree, the
+		 * transforms, and whether the slot is already queued. */
+		std::vector<unsigned> m_parent, m_end;
+		std::vector<DualQuat_t<float>> m_local, m_world;
+		std::vector<bool> m_dirty;
+		/* The slots set since the last update. */
+		std::vector<unsigned> m_changed;
+		/* Set when nodes were appended out of depth-first order. */
+		bool m_stale = false;
+	};
+}
+
+#endif
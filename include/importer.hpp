@@ -0,0 +1,88 @@
+/*! @file include/importer.hpp
+ *  @brief Parallel import of OBJ and PLY meshes */
+
+#ifndef IMPORTER_HPP
+#define IMPORTER_HPP
+
+#include "pool.hpp"
+
+///@cond
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+///@endcond
+
+namespace Streams {
+
+	/**
+	 * @brief Parses a Wavefront OBJ or Stanford PLY mesh into triangles
+	 * over vertices with distinct positions.
+	 *
+	 * Text is split into chunks that start and end on line boundaries and
+	 * the chunks are parsed on the pool, with a number parser that ignores
+	 * the locale; binary PLY vertices are decoded in parallel by record.
+	 * The chunks are then concatenated, vertices with equal positions are
+	 * merged, keeping the first, and polygons are triangulated as fans.
+	 * Only positions are kept: OBJ v and f lines (f indices may be
+	 * negative, counting back from the last vertex, and may carry texture
+	 * and normal indices, which are dropped), and the x, y and z vertex
+	 * properties and vertex_indices or vertex_index face lists of PLY in
+	 * ascii or either binary byte order. Input that starts with "ply" is
+	 * read as PLY, anything else as OBJ.
+	 */
+	struct Importer {
+		/** @brief True if the input was read and well-formed; otherwise
+		 * the mesh is empty. */
+		explicit operator bool(void) const;
+		/** @brief The vertices as x, y, z, w, with w from OBJ or else 1. */
+		std::vector<float> const& vertices(void) const;
+		std::size_t vertex_count(void) const;
+		/** @brief The indices, three per triangle. */
+		std::vector<std::uint32_t> const& indices(void) const;
+		std::size_t index_count(void) const;
+		/** @brief The number of vertices read, before merging. */
+		std::size_t read(void) const;
+
+		/** @brief Writes the mesh as a file for MeshFile.
+		 * @return False if the import failed or the file was not written */
+		bool write(std::string const& path) const;
+
+		/** @brief Imports a file, mapped in place while it is parsed.
+		 * @param path The OBJ or PLY file
+		 * @param pool The threads that parse it */
+		Importer(std::string const& path,
+				Abstract::Pool &pool = Abstract::Pool::shared());
+		/** @brief Imports a mesh held in memory.
+		 * @param data The file contents, not necessarily terminated
+		 * @param size The number of bytes
+		 * @param pool The threads that parse it */
+		Importer(char const *data, std::size_t size,
+				Abstract::Pool &pool = Abstract::Pool::shared());
+	protected:
+		bool parse(char const *data, std::size_t size, Abstract::Pool &pool);
+		bool parse_obj(char const *data, std::size_t size,
+				Abstract::Pool &pool);
+		bool parse_ply(char const *data, std::size_t size,
+				Abstract::Pool &pool);
+		void merge(Abstract::Pool &pool);
+
+		std::vector<float> m_vertices;
+		std::vector<std::uint32_t> m_indices;
+		std::size_t m_read = 0;
+		bool m_valid = false;
+	};
+
+	/** @brief Parses a decimal floating point number as strtod does in the
+	 * C locale, but without its locale lookups; the result is within an
+	 * ulp of strtod's.
+	 * @param first The first character, after any leading blanks
+	 * @param last One past the last readable character
+	 * @param dest The number
+	 * @return One past the last character used, or first if there is no
+	 * number there */
+	char const* parse_float(char const *first, char const *last,
+			float &dest);
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*! @file include/interpolation.hpp
+ *  @brief Interpolation of rotations and rigid transforms, in scalar and
+ *  structure-of-arrays forms */
+
+#ifndef INTERPOLATION_HPP
+#define INTERPOLATION_HPP
+
+#include "geometry.hpp"
+#include "quaternion.hpp"
+#include "dual_quaternion.hpp"
+#include "batch.hpp"
+
+///@cond
+#include <limits>
+///@endcond
+
+namespace Geometry {
+
+	/**
+	 * @brief Normalized linear interpolation along the shorter arc; the
+	 * path matches slerp but the angular speed is not constant.
+	 * @tparam L The domain of the start
+	 * @tparam R The domain of the end
+	 * @tparam T The domain of the parameter
+	 * @tparam LR The range of the result
+	 * @param l The start, at t = 0
+	 * @param r The end, at t = 1 (negated if that shortens the arc)
+	 * @param t The parameter, generally in [0, 1]
+	 * @return The normalized interpolant
+	 */
+	template<typename L, typename R, typename T,
+		typename LR = COMBINE(L,*,R)>
+	Quat_t<LR> nlerp(Quat_t<L> const& l, Quat_t<R> const& r, T const& t);
+	/**
+	 * @brief Spherical linear interpolation along the shorter arc, at
+	 * constant angular speed; falls back to nlerp where the ends are too
+	 * close for sin(theta) to be divided by.
+	 * @param l The start, a unit quaternion
+	 * @param r The end, a unit quaternion
+	 * @param t The parameter in [0, 1]
+	 */
+	template<typename L, typename R, typename T,
+		typename LR = COMBINE(L,*,R)>
+	Quat_t<LR> slerp(Quat_t<L> const& l, Quat_t<R> const& r, T const& t);
+	/**
+	 * @brief Approximate slerp: nlerp with its parameter corrected by a
+	 * cubic in t whose coefficients are fit to the cosine of the arc.
+	 * The result is unit length by construction; for unit inputs and t in
+	 * [0, 1] it is within 4e-4 radians of slerp along the quaternion arc
+	 * (8e-4 radians, or 0.045 degrees, of rotation), and exact at the ends
+	 * and midpoint.
+	 */
+	template<typename L, typename R, typename T,
+		typename LR = COMBINE(L,*,R)>
+	Quat_t<LR> slerp_fast(Quat_t<L> const& l, Quat_t<R> const& r,
+			T const& t);
+
+	/**
+	 * @brief Raises a unit dual quaternion to a real power by scaling its
+	 * screw parameters, the angle and the pitch, about a fixed screw axis.
+	 * @tparam X The domain of the dual quaternion
+	 * @tparam T The domain of the exponent
+	 * @param q The rigid transform, with a non-negative real part
+	 * @param t The exponent
+	 * @return The transform q^t
+	 */
+	template<typename X, typename T>
+	DualQuat_t<X> power(DualQuat_t<X> const& q, T const& t);
+	/**
+	 * @brief Screw linear interpolation of rigid transforms, l (l* r)^t,
+	 * along the shorter arc; a constant-speed screw motion from l to r.
+	 * @param l The start, a unit dual quaternion
+	 * @param r The end, a unit dual quaternion
+	 * @param t The parameter in [0, 1]
+	 */
+	template<typename L, typename R, typename T,
+		typename LR = COMBINE(L,*,R)>
+	DualQuat_t<LR> sclerp(DualQuat_t<L> const& l, DualQuat_t<R> const& r,
+			T const& t);
+
+	/* The batched forms take either one parameter for every element or
+	 * an array of them, padded like the batches to Simd::padded(n). Each
+	 * writes the shorter of its inputs to dest, which may alias either. */
+
+	/** @brief Element-wise nlerp. */
+	void nlerp(QuatBatch const& l, QuatBatch const& r, float t,
+			QuatBatch& dest);
+	void nlerp(QuatBatch const& l, QuatBatch const& r,
+			Simd::Array const& t, QuatBatch& dest);
+	/** @brief Element-wise slerp, with polynomial arccosine and sine good
+	 * to a few float ulps over the interpolated range. */
+	void slerp(QuatBatch const& l, QuatBatch const& r, float t,
+			QuatBatch& dest);
+	void slerp(QuatBatch const& l, QuatBatch const& r,
+			Simd::Array const& t, QuatBatch& dest);
+	/** @brief Element-wise slerp_fast, with the same error bound. */
+	void slerp_fast(QuatBatch const& l, QuatBatch const& r, float t,
+			QuatBatch& dest);
+	void slerp_fast(QuatBatch const& l, QuatBatch const& r,
+			Simd::Array const& t, QuatBatch& dest);
+	/** @brief Element-wise sclerp. */
+	void sclerp(DualQuatBatch const& l, DualQuatBatch const& r, float t,
+			DualQuatBatch& dest);
+	void sclerp(DualQuatBatch const& l, DualQuatBatch const& r,
+			Simd::Array const& t, DualQuatBatch& dest);
+}
+#include "interpolation.tpp"
+
+#endif
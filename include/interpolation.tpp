@@ -0,0 +1,80 @@
+/*! @file include/interpolation.tpp
+ *  @brief Implementation of the scalar forms from interpolation.hpp */
+
+#ifndef INTERPOLATION_TPP
+#define INTERPOLATION_TPP
+
+namespace Geometry {
+	template<typename L, typename R, typename T, typename LR>
+	Quat_t<LR> nlerp(Quat_t<L> const& l, Quat_t<R> const& r, T const& t) {
+		LR a = LR(1 - t), b = dot(l, r) < 0 ? LR(-t) : LR(t);
+		return normalize(Quat_t<LR>{a*l.w + b*r.w, a*l.x + b*r.x,
+			a*l.y + b*r.y, a*l.z + b*r.z});
+	}
+	template<typename L, typename R, typename T, typename LR>
+	Quat_t<LR> slerp(Quat_t<L> const& l, Quat_t<R> const& r, T const& t) {
+		LR d = dot(l, r), s = d < 0 ? -1 : 1;
+		d *= s;
+		// Past this, sin(theta) has too few significant bits to divide by
+		if(d > LR(0.9995))
+			return nlerp(l, r, t);
+		LR theta = acos(d), sn = sqrt(1 - d*d),
+		   a = sin((1 - t) * theta) / sn, b = s * sin(t * theta) / sn;
+		return {a*l.w + b*r.w, a*l.x + b*r.x,
+			a*l.y + b*r.y, a*l.z + b*r.z};
+	}
+	template<typename L, typename R, typename T, typename LR>
+	Quat_t<LR> slerp_fast(Quat_t<L> const& l, Quat_t<R> const& r,
+			T const& t) {
+		/* Corrects the parameter of nlerp by t + t(t - 1/2)(t - 1) k, where
+		 * k = A (t - 1/2)^2 + B and A, B are polynomials in |cos(theta)|
+		 * fit to minimize the maximum angular error over [0, 1]. */
+		LR d = dot(l, r), u = LR(t);
+		d = d < 0 ? -d : d;
+		LR A = LR(1.0904) + d * (LR(-3.2452) + d * (LR(3.55645)
+				- d * LR(1.43519))),
+		   B = LR(0.848013) + d * (LR(-1.06021) + d * LR(0.215638)),
+		   h = u - LR(.5), k = A * h * h + B;
+		return nlerp(l, r, u + u * h * (u - 1) * k);
+	}
+
+	template<typename X, typename T>
+	DualQuat_t<X> power(DualQuat_t<X> const& q, T const& t) {
+		/* q = (cos h + l sin h) + e(-p sin h + m sin h + p l cos h) for the
+		 * half angle h, half pitch p, axis l and moment m; q^t scales h
+		 * and p by t and keeps the axis. With r = l sin h, that is
+		 * (cos th, k r) + e(t k v.w, k vec(v) + j r), k = sin(th)/sin(h),
+		 * where j carries the pitch; near h = 0 the axis is noise, so k
+		 * and j are taken from their series rather than divided out. */
+		auto const &u = q.u, &v = q.v;
+		X s2 = u.x*u.x + u.y*u.y + u.z*u.z, s = sqrt(s2),
+		  a = u.x*v.x + u.y*v.y + u.z*v.z,
+		  h = atan2(s, u.w), th = X(t * h), c = cos(th), tt = X(t*t), k, g;
+		// Where the series and the quotients are equally accurate
+		static const X cut = pow(std::numeric_limits<X>::epsilon(), X(1)/6);
+		if(h < cut) {
+			k = X(t * (1 + (1 - tt) * h*h / 6));
+			g = X(t * (1 - tt) / 3);
+		} else {
+			k = sin(th) / s;
+			g = (X(t * c) / u.w - k) / s2;
+		}
+		// j, by cos(h) where the rotation is small and sin(h) otherwise
+		X j = u.w > s ? a * g : (X(-t * c) * v.w - k * a) / s2;
+		return {{c, k*u.x, k*u.y, k*u.z}, {X(t * k * v.w),
+			k*v.x + j*u.x, k*v.y + j*u.y, k*v.z + j*u.z}};
+	}
+	template<typename L, typename R, typename T, typename LR>
+	DualQuat_t<LR> sclerp(DualQuat_t<L> const& l, DualQuat_t<R> const& r,
+			T const& t) {
+		DualQuat_t<LR> a, b, d;
+		a = l;
+		b = r;
+		if(dot(l.u, r.u) < 0)
+			b = -b;
+		d = *a * b;
+		return a * power(d, t);
+	}
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*! @file include/mapped.hpp
+ *  @brief Binary meshes read in place from memory-mapped files */
+
+#ifndef MAPPED_HPP
+#define MAPPED_HPP
+
+#include "geometry.hpp"
+
+///@cond
+#include <cstddef>
+#include <cstdint>
+#include <string>
+///@endcond
+
+namespace Streams {
+
+	/**
+	 * @brief A read-only mapping of a binary mesh file, whose sections are
+	 * used where they lie, e.g. passed straight to a buffer upload.
+	 *
+	 * A file is a 64-byte header followed by the vertices, as x, y, z, w
+	 * floats, and the 32-bit indices, three per triangle; each section
+	 * starts on a 64-byte boundary. The header holds the counts, the
+	 * section offsets and the bounds of the vertices, and a byte order
+	 * mark so that a file written on another architecture is rejected.
+	 * Opening validates only the header and the section extents, so it
+	 * costs the same for any size; the pages are read in on first touch,
+	 * from the page cache if the file was read recently.
+	 */
+	struct MeshFile {
+		/** @brief The alignment of each section. */
+		static constexpr std::size_t alignment = 64;
+
+		/** @brief The leading bytes of a file, in native byte order. */
+		struct Header {
+			char magic[8];
+			std::uint32_t order, version, vertices, indices;
+			std::uint64_t vertex_offset, index_offset;
+			float lo[3], hi[3];
+		};
+
+		/** @brief True if the file was mapped and its header is valid;
+		 * otherwise the sections are null and the counts zero. */
+		explicit operator bool(void) const;
+		/** @brief The header; only if the file was mapped. */
+		Header const& header(void) const;
+		/** @brief The vertices, four floats each. */
+		float const* vertices(void) const;
+		std::uint32_t vertex_count(void) const;
+		/** @brief The indices, not checked against the vertex count. */
+		std::uint32_t const* indices(void) const;
+		std::uint32_t index_count(void) const;
+		/** @brief The corners of the bounding box of the vertices. */
+		Geometry::Vec_t<float> lo(void) const;
+		Geometry::Vec_t<float> hi(void) const;
+
+		/** @brief Writes a mesh file.
+		 * @param path The destination
+		 * @param vertices x, y, z, w for each vertex
+		 * @param n_vertices The number of vertices
+		 * @param indices Three per triangle
+		 * @param n_indices The number of indices
+		 * @return False if the file could not be written */
+		static bool write(std::string const& path, float const *vertices,
+				std::uint32_t n_vertices, std::uint32_t const *indices,
+				std::uint32_t n_indices);
+
+		/** @brief Maps a mesh file; check the result with operator bool. */
+		MeshFile(std::string const& path);
+		MeshFile(MeshFile const&) = delete;
+		MeshFile& operator=(MeshFile const&) = delete;
+		virtual ~MeshFile(void);
+	protected:
+		char const *m_map = nullptr;
+		std::size_t m_size = 0;
+		bool m_valid = false;
+	};
+}
+
+#endif
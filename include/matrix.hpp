@@ -4,15 +4,32 @@
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
+#include "geometry.hpp"
+#include "simd.hpp"
+
+///@cond
+#include <algorithm>
+#include <cstddef>
+///@endcond
+
 namespace Geometry {
 
 	template<typename S = float>
 	struct Matrix_t;
 
+	struct VecBatch;
+
+	template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+	constexpr Matrix_t<LR> product(Matrix_t<L> const& l, Matrix_t<R> const& r);
+	/** @brief SIMD product of single-precision matrices; constant
+	 * expressions can name the generic product<float, float> instead. */
+	Matrix_t<float> product(Matrix_t<float> const& l,
+			Matrix_t<float> const& r);
+
 	template<typename S>
 	struct Matrix_t {
 		S data[16];
-		static Matrix_t<S> identity(void) {
+		static constexpr Matrix_t<S> identity(void) {
 			return {
 				1, 0, 0, 0,
 				0, 1, 0, 0,
@@ -20,7 +37,7 @@ namespace Geometry {
 				0, 0, 0, 1
 			};
 		}
-		Matrix_t<S> transpose(void) const {
+		constexpr Matrix_t<S> transpose(void) const {
 			return {
 				data[ 0], data[ 4], data[ 8], data[12],
 				data[ 1], data[ 5], data[ 9], data[13],
@@ -28,58 +45,145 @@ namespace Geometry {
 				data[ 3], data[ 7], data[11], data[15]
 			};
 		}
-		S const& operator[](unsigned N) const {
+		constexpr S const& operator[](unsigned N) const {
 			return data[N];
 		}
-		S& operator[](unsigned N) {
+		constexpr S& operator[](unsigned N) {
 			return data[N];
 		}
 		template<typename T>
-		Matrix_t<S> operator=(Matrix_t<T> const& r) {
-			std::copy(&r[0], &r[0]+16, data);
+		constexpr Matrix_t<S> operator=(Matrix_t<T> const& r) {
+			for(unsigned i = 0; i < 16; i++) data[i] = r[i];
 			return *this;
 		}
 		template<typename T>
-		Matrix_t<COMBINE(S,*,T)> operator*(Matrix_t<T> const& r) {
-			return {
-				data[ 0]*r[ 0] + data[ 1]*r[ 4]
-					+ data[ 2]*r[ 8] + data[ 3]*r[12],
-				data[ 0]*r[ 1] + data[ 1]*r[ 5]
-					+ data[ 2]*r[ 9] + data[ 3]*r[13],
-				data[ 0]*r[ 2] + data[ 1]*r[ 6]
-					+ data[ 2]*r[10] + data[ 3]*r[14],
-				data[ 0]*r[ 3] + data[ 1]*r[ 7]
-					+ data[ 2]*r[11] + data[ 3]*r[15],
-
-				data[ 4]*r[ 0] + data[ 5]*r[ 4]
-					+ data[ 6]*r[ 8] + data[ 7]*r[12],
-				data[ 4]*r[ 1] + data[ 5]*r[ 5]
-					+ data[ 6]*r[ 9] + data[ 7]*r[13],
-				data[ 4]*r[ 2] + data[ 5]*r[ 6]
-					+ data[ 6]*r[10] + data[ 7]*r[14],
-				data[ 4]*r[ 3] + data[ 5]*r[ 7]
-					+ data[ 6]*r[11] + data[ 7]*r[15],
-
-				data[ 8]*r[ 0] + data[ 9]*r[ 4]
-					+ data[10]*r[ 8] + data[11]*r[12],
-				data[ 8]*r[ 1] + data[ 9]*r[ 5]
-					+ data[10]*r[ 9] + data[11]*r[13],
-				data[ 8]*r[ 2] + data[ 9]*r[ 6]
-					+ data[10]*r[10] + data[11]*r[14],
-				data[ 8]*r[ 3] + data[ 9]*r[ 7]
-					+ data[10]*r[11] + data[11]*r[15],
+		constexpr Matrix_t<COMBINE(S,*,T)> operator*(
+				Matrix_t<T> const& r) const {
+			return product(*this, r);
+		}
+		template<typename T>
+		constexpr bool operator==(Matrix_t<T> const& r) const {
+			for(unsigned i = 0; i < 16; i++)
+				if(!(data[i] == r.data[i])) return false;
+			return true;
+		}
+		constexpr S determinant(void) const;
+		/** @brief General inverse by cofactor expansion.
+		 * @param invertible Set to false when the matrix is singular
+		 * (optional); the identity is returned in that case
+		 * @return The inverse, such that M*M.inverse() == identity */
+		constexpr Matrix_t<S> inverse(bool *invertible = 0) const;
+		/** @brief Inverse of an affine transform (last column 0,0,0,1);
+		 * inverts the upper 3x3 alone and carries the translation over. */
+		constexpr Matrix_t<S> affine_inverse(bool *invertible = 0) const;
+		/** @brief Inverse of a rigid transform (rotation and translation
+		 * only), where the upper 3x3 inverse is its transpose. */
+		constexpr Matrix_t<S> rigid_inverse(void) const;
+		/** @brief The normal matrix, the inverse transpose of the upper
+		 * 3x3, padded to 4x4 without translation; normals transform as
+		 * n*M.normal() when points transform as p*M. */
+		constexpr Matrix_t<S> normal(bool *invertible = 0) const;
+	};
 
-				data[12]*r[ 0] + data[13]*r[ 4]
-					+ data[14]*r[ 8] + data[15]*r[12],
-				data[12]*r[ 1] + data[13]*r[ 5]
-					+ data[14]*r[ 9] + data[15]*r[13],
-				data[12]*r[ 2] + data[13]*r[ 6]
-					+ data[14]*r[10] + data[15]*r[14],
-				data[12]*r[ 3] + data[13]*r[ 7]
-					+ data[14]*r[11] + data[15]*r[15],
-			};
+	/**
+	 * @brief A matrix with its inverse and normal matrix computed on demand
+	 * and cached until the matrix changes, so static transforms pay for
+	 * their inverses once.
+	 * @tparam S The domain of each element
+	 */
+	template<typename S = float>
+	struct Transform_t {
+		/** @brief The current matrix. */
+		operator Matrix_t<S> const&(void) const { return m_matrix; }
+		Matrix_t<S> const& matrix(void) const { return m_matrix; }
+		/** @brief Replaces the matrix; the cache survives equal values. */
+		Transform_t<S>& operator=(Matrix_t<S> const& m) {
+			if(!(m == m_matrix)) {
+				m_matrix = m;
+				m_cached = 0;
+			}
+			return *this;
+		}
+		/** @brief Mutable access; always invalidates the cache. */
+		Matrix_t<S>& edit(void) {
+			m_cached = 0;
+			return m_matrix;
 		}
+		/** @brief The cached inverse (affine_inverse if affine was set). */
+		Matrix_t<S> const& inverse(bool *invertible = 0) const {
+			if(!(m_cached & cached_inverse)) {
+				m_inverse = m_affine ? m_matrix.affine_inverse(&m_invertible)
+					: m_matrix.inverse(&m_invertible);
+				m_cached |= cached_inverse;
+			}
+			if(invertible) *invertible = m_invertible;
+			return m_inverse;
+		}
+		/** @brief The cached normal matrix, as Matrix_t::normal. The
+		 * cached inverse is reused only when it is the affine inverse;
+		 * the upper 3x3 of a general inverse is not the inverse of the
+		 * upper 3x3 unless the last column is (0,0,0,1). */
+		Matrix_t<S> const& normal(void) const {
+			if(!(m_cached & cached_normal)) {
+				if(m_affine) {
+					auto const& inv = inverse();
+					m_normal = {
+						inv[0], inv[4], inv[ 8], 0,
+						inv[1], inv[5], inv[ 9], 0,
+						inv[2], inv[6], inv[10], 0,
+						     0,      0,       0, 1
+					};
+				} else m_normal = m_matrix.normal();
+				m_cached |= cached_normal;
+			}
+			return m_normal;
+		}
+		/** @param m The initial matrix
+		 * @param affine Whether every assigned matrix is affine, which
+		 * allows the cheaper inverse */
+		Transform_t(Matrix_t<S> const& m = Matrix_t<S>::identity(),
+			bool affine = false): m_matrix(m), m_affine(affine) {}
+	protected:
+		enum : unsigned char { cached_inverse = 1, cached_normal = 2 };
+		Matrix_t<S> m_matrix;
+		mutable Matrix_t<S> m_inverse, m_normal;
+		mutable unsigned char m_cached = 0;
+		mutable bool m_invertible = true;
+		bool m_affine;
 	};
+
+	/**
+	 * @brief Row vector-matrix product of a point (implicit w = 1), so that
+	 * v*(A*B) == (v*A)*B and the last row holds the translation. This is
+	 * the same transform GL applies to the matrix uploaded untransposed.
+	 * @return The transformed point, without projective division
+	 */
+	template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+	constexpr Vec_t<LR> operator*(Vec_t<L> const& l, Matrix_t<R> const& r);
+
+	/** @brief Transforms points in place, split across the shared pool.
+	 * @param m The transform, applied as v*m
+	 * @param p0 The first point
+	 * @param p1 One past the last point */
+	void transform(Matrix_t<float> const& m,
+			Vec_t<float> *p0, Vec_t<float> *p1);
+	/** @brief Transforms n points from src into dest (may alias). */
+	void transform(Matrix_t<float> const& m,
+			Vec_t<float> const *src, Vec_t<float> *dest, std::size_t n);
+	/** @brief Transforms n homogeneous vertices (x, y, z, w) as laid out in
+	 * vertex buffers; a 16-byte aligned dest that does not alias src is
+	 * written with streaming stores, bypassing the cache. */
+	void transform(Matrix_t<float> const& m,
+			float const *src, float *dest, std::size_t n);
+	/** @brief Transforms each point of a batch, resizing dest (may alias). */
+	void transform(Matrix_t<float> const& m,
+			VecBatch const& src, VecBatch& dest);
+	/** @brief Element-wise products l[i]*r[i] of n matrices, as by the
+	 * SIMD product, split across the shared pool; dest may alias either. */
+	void product(Matrix_t<float> const *l, Matrix_t<float> const *r,
+			Matrix_t<float> *dest, std::size_t n);
 }
 
+#include "matrix.tpp"
+
 #endif
@@ -0,0 +1,139 @@
+/*! @file include/matrix.tpp
+ *  @brief Implementations from declarations in matrix.hpp */
+
+#ifndef MATRIX_TPP
+#define MATRIX_TPP
+
+namespace Geometry {
+	template<typename L, typename R, typename LR>
+	constexpr Matrix_t<LR> product(Matrix_t<L> const& l,
+			Matrix_t<R> const& r) {
+		Matrix_t<LR> out = {};
+		for(unsigned i = 0; i < 16; i += 4)
+			for(unsigned j = 0; j < 4; j++)
+				out[i+j] = l[i]*r[j] + l[i+1]*r[j+4]
+					+ l[i+2]*r[j+8] + l[i+3]*r[j+12];
+		return out;
+	}
+	/* Row i of the product is the sum of the rows of r weighted by row i
+	 * of l: four broadcasts and four multiply-adds per row. */
+	inline Matrix_t<float> product(Matrix_t<float> const& l,
+			Matrix_t<float> const& r) {
+		using Simd::Quad;
+		Matrix_t<float> out;
+		auto r0 = Quad::loadu(&r[0]), r1 = Quad::loadu(&r[4]),
+			 r2 = Quad::loadu(&r[8]), r3 = Quad::loadu(&r[12]);
+		for(unsigned i = 0; i < 16; i += 4) {
+			mul_add(Quad::broadcast(l[i]), r0,
+				mul_add(Quad::broadcast(l[i+1]), r1,
+				mul_add(Quad::broadcast(l[i+2]), r2,
+				Quad::broadcast(l[i+3]) * r3))).storeu(&out[i]);
+		}
+		return out;
+	}
+	template<typename S>
+	constexpr S Matrix_t<S>::determinant(void) const {
+		auto const& m = data;
+		S s0 = m[0]*m[5] - m[1]*m[4], s1 = m[0]*m[6] - m[2]*m[4],
+		  s2 = m[0]*m[7] - m[3]*m[4], s3 = m[1]*m[6] - m[2]*m[5],
+		  s4 = m[1]*m[7] - m[3]*m[5], s5 = m[2]*m[7] - m[3]*m[6],
+		  c5 = m[10]*m[15] - m[11]*m[14], c4 = m[9]*m[15] - m[11]*m[13],
+		  c3 = m[9]*m[14] - m[10]*m[13], c2 = m[8]*m[15] - m[11]*m[12],
+		  c1 = m[8]*m[14] - m[10]*m[12], c0 = m[8]*m[13] - m[9]*m[12];
+		return s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+	}
+	/* The 2x2 sub-determinants of the top and bottom row pairs are shared
+	 * by every cofactor, leaving about a hundred multiplies in total. */
+	template<typename S>
+	constexpr Matrix_t<S> Matrix_t<S>::inverse(bool *invertible) const {
+		auto const& m = data;
+		S s0 = m[0]*m[5] - m[1]*m[4], s1 = m[0]*m[6] - m[2]*m[4],
+		  s2 = m[0]*m[7] - m[3]*m[4], s3 = m[1]*m[6] - m[2]*m[5],
+		  s4 = m[1]*m[7] - m[3]*m[5], s5 = m[2]*m[7] - m[3]*m[6],
+		  c5 = m[10]*m[15] - m[11]*m[14], c4 = m[9]*m[15] - m[11]*m[13],
+		  c3 = m[9]*m[14] - m[10]*m[13], c2 = m[8]*m[15] - m[11]*m[12],
+		  c1 = m[8]*m[14] - m[10]*m[12], c0 = m[8]*m[13] - m[9]*m[12],
+		  det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+		if(invertible) *invertible = det != S(0);
+		if(det == S(0)) return identity();
+		S k = S(1) / det;
+		return {
+			( m[5]*c5 - m[6]*c4 + m[7]*c3) * k,
+			(-m[1]*c5 + m[2]*c4 - m[3]*c3) * k,
+			( m[13]*s5 - m[14]*s4 + m[15]*s3) * k,
+			(-m[9]*s5 + m[10]*s4 - m[11]*s3) * k,
+
+			(-m[4]*c5 + m[6]*c2 - m[7]*c1) * k,
+			( m[0]*c5 - m[2]*c2 + m[3]*c1) * k,
+			(-m[12]*s5 + m[14]*s2 - m[15]*s1) * k,
+			( m[8]*s5 - m[10]*s2 + m[11]*s1) * k,
+
+			( m[4]*c4 - m[5]*c2 + m[7]*c0) * k,
+			(-m[0]*c4 + m[1]*c2 - m[3]*c0) * k,
+			( m[12]*s4 - m[13]*s2 + m[15]*s0) * k,
+			(-m[8]*s4 + m[9]*s2 - m[11]*s0) * k,
+
+			(-m[4]*c3 + m[5]*c1 - m[6]*c0) * k,
+			( m[0]*c3 - m[1]*c1 + m[2]*c0) * k,
+			(-m[12]*s3 + m[13]*s1 - m[14]*s0) * k,
+			( m[8]*s3 - m[9]*s1 + m[10]*s0) * k
+		};
+	}
+	template<typename S>
+	constexpr Matrix_t<S> Matrix_t<S>::affine_inverse(
+			bool *invertible) const {
+		auto const& m = data;
+		// Rows of the adjugate are cross products of the 3x3 rows
+		S a0 = m[5]*m[10] - m[6]*m[9], a1 = m[2]*m[9] - m[1]*m[10],
+		  a2 = m[1]*m[6] - m[2]*m[5], a4 = m[6]*m[8] - m[4]*m[10],
+		  a5 = m[0]*m[10] - m[2]*m[8], a6 = m[2]*m[4] - m[0]*m[6],
+		  a8 = m[4]*m[9] - m[5]*m[8], a9 = m[1]*m[8] - m[0]*m[9],
+		  a10 = m[0]*m[5] - m[1]*m[4],
+		  det = m[0]*a0 + m[1]*a4 + m[2]*a8;
+		if(invertible) *invertible = det != S(0);
+		if(det == S(0)) return identity();
+		S k = S(1) / det;
+		a0 *= k; a1 *= k; a2 *= k; a4 *= k; a5 *= k;
+		a6 *= k; a8 *= k; a9 *= k; a10 *= k;
+		return {
+			a0, a1, a2, 0,
+			a4, a5, a6, 0,
+			a8, a9, a10, 0,
+			-(m[12]*a0 + m[13]*a4 + m[14]*a8),
+			-(m[12]*a1 + m[13]*a5 + m[14]*a9),
+			-(m[12]*a2 + m[13]*a6 + m[14]*a10), 1
+		};
+	}
+	template<typename S>
+	constexpr Matrix_t<S> Matrix_t<S>::rigid_inverse(void) const {
+		auto const& m = data;
+		return {
+			m[0], m[4], m[ 8], 0,
+			m[1], m[5], m[ 9], 0,
+			m[2], m[6], m[10], 0,
+			-(m[12]*m[0] + m[13]*m[1] + m[14]*m[2]),
+			-(m[12]*m[4] + m[13]*m[5] + m[14]*m[6]),
+			-(m[12]*m[8] + m[13]*m[9] + m[14]*m[10]), 1
+		};
+	}
+	template<typename S>
+	constexpr Matrix_t<S> Matrix_t<S>::normal(bool *invertible) const {
+		auto inv = affine_inverse(invertible);
+		return {
+			inv[0], inv[4], inv[ 8], 0,
+			inv[1], inv[5], inv[ 9], 0,
+			inv[2], inv[6], inv[10], 0,
+			     0,      0,       0, 1
+		};
+	}
+	template<typename L, typename R, typename LR>
+	constexpr Vec_t<LR> operator*(Vec_t<L> const& l, Matrix_t<R> const& r) {
+		return {
+			LR(l.x*r[0] + l.y*r[4] + l.z*r[ 8] + r[12]),
+			LR(l.x*r[1] + l.y*r[5] + l.z*r[ 9] + r[13]),
+			LR(l.x*r[2] + l.y*r[6] + l.z*r[10] + r[14])
+		};
+	}
+}
+
+#endif
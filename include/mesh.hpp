@@ -0,0 +1,98 @@
+/*! @file include/mesh.hpp
+ *  @brief Indexed triangle meshes in GPU buffers, drawn once or instanced */
+
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include "view.hpp"
+#include "buffer.hpp"
+#include "queue.hpp"
+#include "matrix.hpp"
+#include "mapped.hpp"
+
+///@cond
+#include <cstddef>
+///@endcond
+
+namespace View {
+
+	/**
+	 * @brief RAII vertex array, vertex buffer and index buffer of one
+	 * static mesh, with homogeneous positions at attribute 0.
+	 *
+	 * Instanced draws take one transform per instance as a per-instance
+	 * mat4 at attributes model through model+3, as declared by
+	 * share/instanced.vert, so any number of copies costs one draw call.
+	 */
+	struct Mesh {
+		/** @brief The attribute location of the position. */
+		static constexpr GLuint position = 0;
+		/** @brief The first of the four attribute locations taken by the
+		 * per-instance model matrix, one column each. */
+		static constexpr GLuint model = 1;
+
+		/** @brief The number of indices. */
+		GLsizei size(void) const;
+		/** @brief The vertex array; the instance attributes are enabled
+		 * only for the duration of an instanced draw, or from a queued
+		 * instanced draw until the next draw. */
+		GLuint vao(void) const;
+
+		/** @brief Draws the mesh once. */
+		void draw(void) const;
+		/**
+		 * @brief Draws one copy of the mesh per transform, streaming the
+		 * transforms as instanced attributes.
+		 * @param stream The stream to write the transforms to; each call
+		 * within a frame takes a slice of its region
+		 * @param transforms The model transforms, applied as v*m
+		 * @param n The number of instances
+		 * @return The number of instances drawn, fewer than n only if the
+		 * stream is out of space for the frame; more instances than a
+		 * region holds are split into several draws
+		 */
+		std::size_t draw(StreamBuffer &stream,
+				Geometry::Matrix_t<float> const *transforms,
+				std::size_t n);
+		/**
+		 * @brief Queues one copy of the mesh per transform as a single
+		 * instanced draw, streaming the transforms now; the instance
+		 * attributes point at them until the next draw of the mesh, so
+		 * it takes one instanced draw per submit.
+		 * @param queue The queue to push the draw to
+		 * @param item The program, material and depth of the draw; the
+		 * rest is taken from the mesh
+		 * @param stream The stream to write the transforms to, fenced
+		 * after the submit
+		 * @param transforms The model transforms, applied as v*m
+		 * @param n The number of instances
+		 * @return False, with nothing queued, if the stream is out of
+		 * space for the frame or n exceeds one of its regions
+		 */
+		bool draw(RenderQueue &queue, RenderQueue::Item item,
+				StreamBuffer &stream,
+				Geometry::Matrix_t<float> const *transforms,
+				std::size_t n);
+
+		/** @brief Uploads the mesh.
+		 * @param vertices Homogeneous positions (x, y, z, w)
+		 * @param n_vertices The number of vertices
+		 * @param indices Three indices per triangle
+		 * @param n_indices The number of indices */
+		Mesh(float const *vertices, std::size_t n_vertices,
+				GLuint const *indices, std::size_t n_indices);
+		/** @brief Uploads a mesh straight from its mapped file, with no
+		 * copy on the CPU side; the file may be closed afterwards. */
+		Mesh(Streams::MeshFile const& file);
+		Mesh(Mesh const&) = delete;
+		Mesh& operator=(Mesh const&) = delete;
+		virtual ~Mesh(void);
+	protected:
+		GLuint m_vao = 0, m_vbo = 0, m_ibo = 0;
+		GLsizei m_count;
+		/* True while a queued draw leaves the instance attributes on. */
+		mutable bool m_instanced = false;
+	};
+}
+
+#endif
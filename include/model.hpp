@@ -16,9 +16,7 @@ namespace Model {
 	 *  @tparam T The derived class providing the update method
 	 */
 	template<typename T>
-	struct ModelBase: Abstract::Updatable_t<T> {
-		using Abstract::Updatable_t<T>::update;
-	};
+	struct ModelBase: Abstract::Updatable_t<T> {};
 
 }
 
@@ -0,0 +1,98 @@
+/*! @file include/offscreen.hpp
+ *  @brief Offscreen render targets and asynchronous pixel readback */
+
+#ifndef OFFSCREEN_HPP
+#define OFFSCREEN_HPP
+
+#include "view.hpp"
+
+///@cond
+#include <functional>
+///@endcond
+
+namespace View {
+
+	/**
+	 * @brief RAII framebuffer with RGBA8 color and 24-bit depth, for
+	 * rendering without a visible surface.
+	 *
+	 * GL objects are created on first use and the attachments are
+	 * reallocated whenever the requested size changes.
+	 */
+	struct RenderTarget {
+		/** @brief The framebuffer, or 0 before the first bind. */
+		GLuint fbo(void) const;
+		GLsizei width(void) const;
+		GLsizei height(void) const;
+
+		/** @brief Binds the target for drawing and reading, resizing it
+		 * first if necessary.
+		 * @return False if the framebuffer is incomplete */
+		bool bind(GLsizei w, GLsizei h);
+
+		RenderTarget(void) {}
+		RenderTarget(RenderTarget const&) = delete;
+		RenderTarget& operator=(RenderTarget const&) = delete;
+		virtual ~RenderTarget(void);
+	protected:
+		void release(void);
+
+		GLuint m_fbo = 0, m_color = 0, m_depth = 0;
+		GLsizei m_width = 0, m_height = 0;
+		bool m_complete = false;
+	};
+
+	/**
+	 * @brief Reads frames back from the read framebuffer through a ring of
+	 * pixel buffers, handing each to a sink frames later.
+	 *
+	 * glReadPixels into a bound pixel buffer returns at once; the copy
+	 * runs after the frame's commands on the GPU. Each read is fenced, and
+	 * its buffer is mapped only when the ring comes back around to it, by
+	 * which time the copy has finished, so reading back never stalls the
+	 * pipeline as a read into client memory does.
+	 */
+	struct Readback {
+		/** @brief The number of reads in flight. */
+		static constexpr unsigned buffers = 2;
+		/** @brief Receives a frame while its buffer is mapped.
+		 * @param rgba Tightly packed RGBA8 rows, bottom row first as GL
+		 * stores them; valid only during the call
+		 * @param w The width in pixels
+		 * @param h The height in pixels
+		 * @param frame The number of the frame, counted from 0 */
+		typedef std::function<void(unsigned char const *rgba,
+				GLsizei w, GLsizei h, unsigned frame)> Sink;
+
+		/** @brief Sets the destination of frames read back. */
+		void sink(Sink sink);
+		/** @brief Queues a read of the read framebuffer, first handing
+		 * over the frame read when its buffer was last used. */
+		void read(GLsizei w, GLsizei h);
+		/** @brief Hands over every frame in flight, waiting for them. */
+		void flush(void);
+		/** @brief The number of frames read back, with or without a sink. */
+		unsigned delivered(void) const;
+
+		Readback(void) {}
+		Readback(Readback const&) = delete;
+		Readback& operator=(Readback const&) = delete;
+		virtual ~Readback(void);
+	protected:
+		/* One pixel buffer and the read into it. */
+		struct Slot {
+			GLuint pbo = 0;
+			GLsizeiptr capacity = 0;
+			GLsizei width = 0, height = 0;
+			unsigned frame = 0;
+			GLsync fence = nullptr;
+		};
+		void deliver(Slot &slot);
+
+		Slot m_slots[buffers];
+		Sink m_sink;
+		unsigned m_next = 0, m_frame = 0, m_delivered = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,64 @@
+/*! @file include/pacer.hpp
+ *  @brief Frame pacing to a target rate from high-resolution timestamps */
+
+#ifndef PACER_HPP
+#define PACER_HPP
+
+///@cond
+#include <chrono>
+///@endcond
+
+namespace View {
+
+	/**
+	 * @brief Schedules the end of each frame on a fixed cadence.
+	 *
+	 * Deadlines advance by one period from the previous deadline rather
+	 * than from the end of the frame, so the time a frame takes is part of
+	 * its budget instead of being added to it. The remaining budget is
+	 * slept off in the coarse, and the last stretch, which the scheduler
+	 * may overshoot, is spun off; the stretch adapts to the worst recent
+	 * oversleep. A frame that ends after its deadline is a miss, and the
+	 * cadence restarts from it rather than rushing the frames after it.
+	 */
+	struct Pacer {
+		typedef std::chrono::steady_clock Clock;
+
+		/** @brief Sets the target rate.
+		 * @param hz Frames per second, or zero to run uncapped, e.g. to
+		 * benchmark; uncapped frames never miss */
+		void rate(double hz);
+		/** @brief The target rate, or zero if uncapped. */
+		double rate(void) const;
+		/** @brief Leaves waiting to the swap, as with vsync, so that end()
+		 * only measures frames against the target rate. */
+		void external(bool on);
+		bool external(void) const;
+
+		/** @brief Ends the frame, waiting out the rest of its budget.
+		 * @return False if the frame missed its deadline */
+		bool end(void);
+		/** @brief Restarts the cadence and the statistics, e.g. after a
+		 * pause such as loading or minimizing. */
+		void reset(void);
+
+		/** @brief The number of frames ended since the last reset. */
+		unsigned frames(void) const;
+		/** @brief The number of those frames that missed the deadline. */
+		unsigned missed(void) const;
+		/** @brief The time from the end of the previous frame to the end
+		 * of the last, including any wait. */
+		Clock::duration last(void) const;
+		/** @brief The work of the last frame, excluding the wait. */
+		Clock::duration busy(void) const;
+
+		Pacer(double hz = 60);
+	protected:
+		Clock::duration m_period, m_spin, m_last{}, m_busy{};
+		Clock::time_point m_deadline, m_end;
+		unsigned m_frames = 0, m_missed = 0;
+		bool m_external = false;
+	};
+}
+
+#endif
@@ -0,0 +1,94 @@
+/*! @file include/packed.hpp
+ *  @brief Compressed storage for unit quaternions and rigid transforms */
+
+#ifndef PACKED_HPP
+#define PACKED_HPP
+
+#include "quaternion.hpp"
+#include "dual_quaternion.hpp"
+
+///@cond
+#include <cstddef>
+#include <cstdint>
+///@endcond
+
+namespace Geometry {
+
+	/**
+	 * @brief A unit quaternion in 32 bits by its "smallest three": two bits
+	 * name the largest component, which is made positive (q and -q are the
+	 * same rotation) and rebuilt from the rest, and the other three are
+	 * quantized to 10 bits over [-1/sqrt2, 1/sqrt2]. After a round trip the
+	 * stored components are within 6.9e-4 and the quaternion within 2.4e-3,
+	 * so the rotation is within 4.8e-3 radians (0.28 degrees); zero
+	 * components, and so the identity, are exact.
+	 */
+	struct Quat32 {
+		std::uint32_t bits = 0;
+
+		/** @brief The unpacked quaternion, unit length. */
+		Quat_t<float> unpack(void) const;
+		/** @brief Packs q, normalizing it first. */
+		Quat32(Quat_t<float> const& q);
+		Quat32(void) = default;
+	};
+
+	/**
+	 * @brief A unit quaternion in 48 bits by its smallest three at 15 bits
+	 * each, as Quat32. After a round trip the stored components are within
+	 * 2.2e-5 and the quaternion within 7.5e-5, so the rotation is within
+	 * 1.5e-4 radians (0.009 degrees).
+	 */
+	struct Quat48 {
+		std::uint16_t bits[3] = {0, 0, 0};
+
+		Quat_t<float> unpack(void) const;
+		Quat48(Quat_t<float> const& q);
+		Quat48(void) = default;
+	};
+
+	/**
+	 * @brief A unit dual quaternion u + ev in 12 bytes against 32: the
+	 * rotation u as a Quat48 and the translation t = 2 vec(v u*) in 16-bit
+	 * fixed point. The step of the fixed point is left to the caller, who
+	 * knows the extent of the scene, and each component of the translation
+	 * is within half a step after a round trip (clamped to 32767 steps).
+	 */
+	struct DualQuat96 {
+		Quat48 u;
+		std::int16_t t[3] = {0, 0, 0};
+
+		/** @brief The unpacked transform, with v = tu/2 for the translation
+		 * t, so that transform() applies it as it did the original.
+		 * @param step The step the transform was packed with */
+		DualQuat_t<float> unpack(float step) const;
+		/** @brief Packs dq with its translation in multiples of step. */
+		DualQuat96(DualQuat_t<float> const& dq, float step);
+		DualQuat96(void) = default;
+	};
+
+	/** @brief The finest step that packs every translation of the given
+	 * transforms without clamping, the largest component over 32767.
+	 * @param src The transforms, with normalized real parts
+	 * @param n The number of transforms */
+	float translation_step(DualQuat_t<float> const *src, std::size_t n);
+
+	/** @brief Packs n quaternions from src into dest; like the transforms
+	 * of matrix.hpp, large arrays are split across the shared pool. */
+	void encode(Quat_t<float> const *src, Quat32 *dest, std::size_t n);
+	void encode(Quat_t<float> const *src, Quat48 *dest, std::size_t n);
+	/** @brief Packs n transforms with translations in multiples of step. */
+	void encode(DualQuat_t<float> const *src, DualQuat96 *dest,
+			std::size_t n, float step);
+	/** @brief Unpacks n quaternions from src into dest. */
+	void decode(Quat32 const *src, Quat_t<float> *dest, std::size_t n);
+	void decode(Quat48 const *src, Quat_t<float> *dest, std::size_t n);
+	/** @brief Unpacks n transforms packed with the given step. */
+	void decode(DualQuat96 const *src, DualQuat_t<float> *dest,
+			std::size_t n, float step);
+
+	static_assert(sizeof(Quat32) == 4 && sizeof(Quat48) == 6
+		&& sizeof(DualQuat96) == 12, "Packed types must not be padded.");
+}
+
+#endif
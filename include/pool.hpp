@@ -0,0 +1,60 @@
+/*! @file include/pool.hpp
+ *  @brief Fork-join thread pool for data-parallel loops */
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+///@cond
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+///@endcond
+
+namespace Abstract {
+
+	/** @brief Persistent worker threads that split index ranges between
+	 * themselves and the calling thread. Calls made from inside a task run
+	 * serially on the current thread rather than deadlocking the pool. */
+	struct Pool {
+		/** @brief Work over the half-open index range [first, last). */
+		typedef std::function<void(std::size_t, std::size_t)> Task;
+
+		/** @brief The process-wide pool, sized to the hardware threads. */
+		static Pool& shared(void);
+
+		/** @brief The number of threads that take part, caller included. */
+		unsigned size(void) const;
+		/** @brief Runs task over [0,n) and blocks until every chunk is done.
+		 * @param n The number of elements
+		 * @param grain The smallest chunk worth handing to another thread;
+		 * every chunk boundary is a multiple of grain
+		 * @param task The work for one chunk */
+		void parallel(std::size_t n, std::size_t grain, Task const& task);
+
+		/** @brief Starts the workers.
+		 * @param threads Total threads including the caller (0 for one per
+		 * hardware thread) */
+		Pool(unsigned threads = 0);
+		Pool(Pool const&) = delete;
+		~Pool(void);
+	protected:
+		void work(void);
+		bool step(void);
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_submit, m_lock;
+		std::condition_variable m_wake, m_done;
+		Task const *m_task = nullptr;
+		std::size_t m_count = 0, m_chunk = 0, m_chunks = 0;
+		std::atomic<std::size_t> m_next{0}, m_left{0};
+		unsigned m_generation = 0, m_active = 0;
+		bool m_quit = false;
+	};
+
+}
+
+#endif
@@ -5,7 +5,13 @@
 #define QUATERNION_HPP
 
 #include "geometry.hpp"
+#include "constant.hpp"
+#include "expression.hpp"
 
+///@cond
+#include <cmath>
+#include <type_traits>
+///@endcond
 
 namespace Geometry {
 
@@ -22,8 +28,8 @@ namespace Geometry {
 		 * strongly-typed hypercomplex unit types are unrelated. */
 		unsigned e;
 		long double v;
-		operator Quatf(void) const;
-		operator Quatd(void) const;
+		constexpr operator Quatf(void) const;
+		constexpr operator Quatd(void) const;
 	};
 
 	/**
@@ -39,27 +45,25 @@ namespace Geometry {
 		friend Unit operator"" _j();
 		friend Unit operator"" _k();
 
-		X operator[](unsigned i) const;
-		X operator[](char c) const;
+		Quat_t(void) = default;
+		constexpr Quat_t(X w, X x, X y, X z): w(w), x(x), y(y), z(z) {}
+		/** @brief Evaluates an expression once, e.g. Quat_t<float>{a*b*c};
+		 * see expression.hpp for the operators. */
+		template<typename E, typename = std::enable_if_t<
+			Expr::Is_node<E>::value && Expr::Traits<E>::size == 4>>
+		constexpr Quat_t(E const& e):
+			Quat_t(Expr::convert<X>(Expr::evaluate(e))) {}
+
+		constexpr X operator[](unsigned i) const;
+		constexpr X operator[](char c) const;
 		template<typename R>
-		Quat_t<X> operator=(Quat_t<R> const& r);
-		Quat_t<X> operator*(void) const;
-		Quat_t<X> operator-(void) const;
-		template<typename R, typename XR = COMBINE(X,*,R)>
-		Quat_t<XR> operator*(Quat_t<R> const& r) const;
-		/// @brief The 'conjugacy' or 'sandwich product', A^B := ABA*.
-		template<typename R, typename XR = COMBINE(X,*,R)>
-		Quat_t<XR> operator^(Vec_t<R> const& r) const;
-		template<typename R, typename XR = COMBINE(X,*,R)>
-		Quat_t<XR> operator^(Quat_t<R> const& r) const;
-		template<typename R, typename XR = COMBINE(X,+,R)>
-		Quat_t<XR> operator+(Quat_t<R> const& r) const;
-		template<typename R, typename XR = COMBINE(X,-,R)>
-		Quat_t<XR> operator-(Quat_t<R> const& r) const;
+		constexpr Quat_t<X> operator=(Quat_t<R> const& r);
 		template<typename R>
-		bool operator==(Quat_t<R> const& r) const;
-		template<typename R, typename XR = COMBINE(X,/,R)>
-		Quat_t<XR> operator/(R const& r) const;
+		constexpr bool operator==(Quat_t<R> const& r) const;
+
+		constexpr X magnitude2(void) const;
+		X magnitude(void) const;
+		Quat_t<X> normalize(void) const;
 	};
 
 	/**
@@ -74,15 +78,36 @@ namespace Geometry {
 	template<typename L, typename R, typename LR = COMBINE(L,*,R)>
 	Quat_t<LR> rotation(L const& l, Vec_t<R> const& r);
 
+	namespace Constant {
+		/** @brief Angle-axis rotation usable in constant expressions, as
+		 * by the tables; at run time, rotation() is much faster. */
+		template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+		constexpr Quat_t<LR> rotation(L const& l, Vec_t<R> const& r);
+	}
+
+	/**
+	 * @brief Rotates a vector by a unit quaternion without forming q v q*;
+	 * with t = 2 (u x v), the result is v + w t + u x t.
+	 * @tparam L The domain of the quaternion
+	 * @tparam R The domain of the vector
+	 * @tparam LR The range of the rotated vector
+	 * @param l The rotation, which must be normalized (unlike operator^)
+	 * @param r The vector to rotate
+	 * @return The rotated vector
+	 */
+	template<typename L, typename R, typename LR = COMBINE(L,*,R)>
+	constexpr Vec_t<LR> rotate(Quat_t<L> const& l, Vec_t<R> const& r);
+
 	// User-defined suffixes, e.g. Quatf x = 1.0_j*1.0_k
 	// TODO template this; DRY, esp. anticipating ad-hoc hypercomplex
 	// (See note on 'Unit' helper type)
-	Unit operator"" _r(long double v) { return {0,v}; }
-	Unit operator"" _i(long double v) { return {1,v}; }
-	Unit operator"" _j(long double v) { return {2,v}; }
-	Unit operator"" _k(long double v) { return {3,v}; }
+	constexpr Unit operator"" _r(long double v) { return {0,v}; }
+	constexpr Unit operator"" _i(long double v) { return {1,v}; }
+	constexpr Unit operator"" _j(long double v) { return {2,v}; }
+	constexpr Unit operator"" _k(long double v) { return {3,v}; }
 
 }
 #include "quaternion.tpp"
+#include "expression.tpp"
 
 #endif
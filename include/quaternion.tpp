@@ -6,28 +6,20 @@
 
 namespace Geometry {
 	template<typename X>
-	X Quat_t<X>::operator[](unsigned i) const {
+	constexpr X Quat_t<X>::operator[](unsigned i) const {
 		return (i==0) ? w : (i==1) ? x : (i==2) ? y : (i==3) ? z : X(0);
 	}
 	template<typename X>
-	X Quat_t<X>::operator[](char c) const {
+	constexpr X Quat_t<X>::operator[](char c) const {
 		return c == '1' ? w : c == 'i' ? x : c == 'j'
 			? y : c == 'k' ? z : 0;
 	}
-	template<typename X>
-	Quat_t<X> Quat_t<X>::operator*(void) const {
-		return {w, -x, -y, -z};
-	}
-	template<typename X>
-	Quat_t<X> Quat_t<X>::operator-(void) const {
-		return {-w, -x, -y, -z};
-	}
 	template<typename X, typename Y = X, typename XY = COMBINE(X,*,Y)>
-	XY dot(Quat_t<X> const& l, Quat_t<Y> const& r) {
+	constexpr XY dot(Quat_t<X> const& l, Quat_t<Y> const& r) {
 		return l.w*r.w + l.x*r.x + l.y*r.y + l.z*r.z;
 	}
-	/*template<typename X>
-	X Quat_t<X>::magnitude2(void) const {
+	template<typename X>
+	constexpr X Quat_t<X>::magnitude2(void) const {
 		return w*w + x*x + y*y + z*z;
 	}
 	template<typename X>
@@ -36,70 +28,46 @@ namespace Geometry {
 	}
 	template<typename X>
 	Quat_t<X> Quat_t<X>::normalize(void) const {
-		return *this / magnitude();
-	}*/
+		X m = magnitude();
+		return {w/m, x/m, y/m, z/m};
+	}
 	template<typename X> template<typename R>
-	Quat_t<X> Quat_t<X>::operator=(Quat_t<R> const& r) {
+	constexpr Quat_t<X> Quat_t<X>::operator=(Quat_t<R> const& r) {
 		w = X(r.w); x = X(r.x);
 		y = X(r.y); z = X(r.z);
 		return *this;
 	}
-	template<typename X> template<typename R, typename XR>
-	Quat_t<XR> Quat_t<X>::operator*(Quat_t<R> const& r) const {
-		return {
-			XR(w * r.w - x * r.x - y * r.y - z * r.z),
-			XR(w * r.x + x * r.w + y * r.z - z * r.y),
-			XR(w * r.y - x * r.z + y * r.w + z * r.x),
-			XR(w * r.z + x * r.y - y * r.x + z * r.w)
-		};
-	}
-	template<typename X> template<typename R, typename XR>
-	Quat_t<XR> Quat_t<X>::operator^(Vec_t<R> const& r) const {
-		return Quat_t<XR> {
-			XR(          - x * r.x - y * r.y - z * r.z),
-			XR(w * r.x             + y * r.z - z * r.y),
-			XR(w * r.y - x * r.z             + z * r.x),
-			XR(w * r.z + x * r.y - y * r.x            )
-		}***this;
-	}
-	template<typename X> template<typename R, typename XR>
-	Quat_t<XR> Quat_t<X>::operator^(Quat_t<R> const& r) const {
-		return *this * r * * *this;
-	}
-	template<typename X> template<typename R, typename XR>
-	Quat_t<XR> Quat_t<X>::operator+(Quat_t<R> const& r) const {
-		return {XR(w+r.w), XR(x+r.x), XR(y+r.y), XR(z+r.z)};
-	}
-	template<typename X> template<typename R, typename XR>
-	Quat_t<XR> Quat_t<X>::operator-(Quat_t<R> const& r) const {
-		return {XR(w-r.w), XR(x-r.x), XR(y-r.y), XR(z-r.z)};
-	}
 	template<typename X> template<typename R>
-	bool Quat_t<X>::operator==(Quat_t<R> const& r) const {
+	constexpr bool Quat_t<X>::operator==(Quat_t<R> const& r) const {
 		return w == r.w && x == r.x
 			&& y == r.y && z == r.z;
 	}
-	template<typename X> template<typename R, typename XR>
-	Quat_t<XR> Quat_t<X>::operator/(R const& r) const {
-		return {w/r, x/r, y/r, z/r};
-	}
 	template<typename L, typename R, typename LR>
 	Quat_t<LR> rotation(L const& l, Vec_t<R> const& r) {
-		LR l2 = LR(l)/2, lc = LR(cos(l2)), ls = LR(sin(l2));
+		LR l2 = LR(l)/2, lc = LR(std::cos(l2)), ls = LR(std::sin(l2));
+		return Quat_t<LR>{lc, ls*r.x, ls*r.y, ls*r.z};
+	}
+	template<typename L, typename R, typename LR>
+	constexpr Quat_t<LR> Constant::rotation(L const& l, Vec_t<R> const& r) {
+		LR l2 = LR(l)/2, lc = Constant::cos(l2), ls = Constant::sin(l2);
 		return Quat_t<LR>{lc, ls*r.x, ls*r.y, ls*r.z};
 	}
-
 	template<typename L, typename R, typename LR>
-	Quat_t<LR> operator*(L const& l, Quat_t<R> const& r) {
-		return {LR(l*r.w), LR(l*r.x), LR(l*r.y), LR(l*r.z)};
+	constexpr Vec_t<LR> rotate(Quat_t<L> const& l, Vec_t<R> const& r) {
+		LR tx = 2 * (l.y * r.z - l.z * r.y),
+		   ty = 2 * (l.z * r.x - l.x * r.z),
+		   tz = 2 * (l.x * r.y - l.y * r.x);
+		return {LR(r.x + l.w * tx + l.y * tz - l.z * ty),
+			LR(r.y + l.w * ty + l.z * tx - l.x * tz),
+			LR(r.z + l.w * tz + l.x * ty - l.y * tx)};
 	}
 
 
-	Unit::operator Quatf(void) const {
+	constexpr Unit::operator Quatf(void) const {
 		float rijk[4] = { 0 }; rijk[e] = float(v);
 		return {rijk[0], rijk[1], rijk[2], rijk[3]};
 	}
-	Unit::operator Quatd(void) const {
+	constexpr Unit::operator Quatd(void) const {
 		double rijk[4] = { 0 }; rijk[e] = double(v);
 		return {rijk[0], rijk[1], rijk[2], rijk[3]};
 	}
@@ -0,0 +1,115 @@
+/*! @file include/queue.hpp
+ *  @brief Draw lists sorted by state and submitted in batches */
+
+#ifndef QUEUE_HPP
+#define QUEUE_HPP
+
+#include "view.hpp"
+#include "buffer.hpp"
+
+///@cond
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+///@endcond
+
+namespace View {
+
+	/**
+	 * @brief Collects indexed draws for a frame and submits them sorted by
+	 * a 64-bit state key.
+	 *
+	 * From the most significant bits down, the key holds the program, the
+	 * vertex array, the material and the quantized depth, so sorting it
+	 * groups draws by the most expensive state first and orders each group
+	 * front to back. Keys are radix sorted, skipping the passes over bytes
+	 * that every key shares. Runs of draws sharing program, vertex array
+	 * and material are merged into one glMultiDrawElementsIndirect where
+	 * the context has GL 4.3 or ARB_multi_draw_indirect, with the commands
+	 * streamed through a fenced ring, and into one
+	 * glMultiDrawElementsBaseVertex otherwise, where instanced draws are
+	 * issued one at a time.
+	 *
+	 * The key holds only the low bits of each name; names beyond them may
+	 * interleave in the order, but each draw still binds its own state.
+	 */
+	struct RenderQueue {
+		/** @brief One indexed draw and the state it needs. */
+		struct Item {
+			GLuint program = 0, vao = 0;
+			/** @brief The material, bound through the material callback. */
+			unsigned material = 0;
+			/** @brief The depth in [0,1]; lower depths draw first. */
+			float depth = 0;
+			GLenum mode = GL_TRIANGLES, type = GL_UNSIGNED_INT;
+			/** @brief The number of indices. */
+			GLsizei count = 0;
+			/** @brief The byte offset of the first index in the index
+			 * buffer; a multiple of the index size. */
+			GLsizeiptr offset = 0;
+			/** @brief The value added to each index. */
+			GLint base = 0;
+			/** @brief The number of instances; per-instance attributes
+			 * start at the first instance, as GL 3.3 has no base instance,
+			 * so they must point at this draw's data until the submit. */
+			GLsizei instances = 1;
+		};
+		/** @brief Binds a material, e.g. its textures and uniforms. */
+		typedef std::function<void(unsigned)> Bind;
+
+		/** @brief The bits of the key holding each field. */
+		static constexpr unsigned program_bits = 12, vao_bits = 12,
+			material_bits = 16, depth_bits = 24;
+
+		/** @brief The sort key of a draw. */
+		static std::uint64_t key(Item const& item);
+
+		/** @brief Sets the callback invoked before the first draw of each
+		 * material and after its program and vertex array are bound. */
+		void material(Bind bind);
+		/** @brief Adds a draw; the queue takes no GL action until submit. */
+		void push(Item const& item);
+		/** @brief The number of queued draws. */
+		std::size_t size(void) const;
+		/** @brief Drops the queued draws. */
+		void clear(void);
+
+		/** @brief Sorts and issues the queued draws, then clears them.
+		 * @return The number of draw calls issued */
+		unsigned submit(void);
+		/** @brief The number of program and vertex array binds made by
+		 * the last submit. */
+		unsigned switches(void) const;
+		/** @brief True if runs are submitted by indirect multi-draw. */
+		bool indirect(void);
+
+		/** @param commands The largest number of indirect commands per
+		 * submit; longer runs use direct multi-draw. */
+		RenderQueue(std::size_t commands = 1 << 12);
+		virtual ~RenderQueue(void) {}
+	protected:
+		/* A key and the index of its item, the unit of the sort. */
+		struct Entry {
+			std::uint64_t key;
+			std::uint32_t index;
+		};
+		void sort(void);
+		/* Issues a run of draws sharing state; returns the calls made. */
+		unsigned run(std::size_t first, std::size_t last);
+
+		std::vector<Item> m_items;
+		std::vector<Entry> m_order, m_swap;
+		Bind m_bind;
+		/* Scratch for direct multi-draw. */
+		std::vector<GLsizei> m_counts;
+		std::vector<const void*> m_offsets;
+		std::vector<GLint> m_bases;
+		StreamBuffer m_commands;
+		/* Unknown until the first submit, which has a context. */
+		int m_indirect = -1;
+		unsigned m_switches = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,263 @@
+/*! @file include/simd.hpp
+ *  @brief Packed float lanes over AVX/SSE with a scalar fallback */
+
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+///@cond
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <math.h>
+#include <new>
+#include <vector>
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+///@endcond
+
+/* Alignment (in bytes) of every lane buffer; wide enough for AVX even when
+ * the build only targets SSE, so buffers can be shared across builds. */
+#ifndef SIMD_ALIGN
+#define SIMD_ALIGN 32
+#endif
+
+namespace Geometry {
+	namespace Simd {
+
+		/** @brief Number of floats per aligned block; batch sizes are
+		 * padded to a multiple of this regardless of the lane width. */
+		static constexpr std::size_t block = SIMD_ALIGN / sizeof(float);
+
+		/** @brief Rounds a count up to the next multiple of block. */
+		constexpr std::size_t padded(std::size_t n) {
+			return (n + block - 1) / block * block;
+		}
+
+		/** @brief Minimal allocator returning SIMD_ALIGN-aligned storage.
+		 * @tparam T The element type */
+		template<typename T>
+		struct Allocator {
+			typedef T value_type;
+			T* allocate(std::size_t n) {
+				std::size_t len = (n * sizeof(T) + SIMD_ALIGN - 1)
+					/ SIMD_ALIGN * SIMD_ALIGN;
+				void *p = aligned_alloc(SIMD_ALIGN, len ? len : SIMD_ALIGN);
+				if(!p) throw std::bad_alloc();
+				return static_cast<T*>(p);
+			}
+			void deallocate(T *p, std::size_t) { free(p); }
+			template<typename U> struct rebind { typedef Allocator<U> other; };
+			template<typename U> bool operator==(Allocator<U> const&) const
+				{ return true; }
+			template<typename U> bool operator!=(Allocator<U> const&) const
+				{ return false; }
+			Allocator(void) {}
+			template<typename U> Allocator(Allocator<U> const&) {}
+		};
+
+		/** @brief Aligned, padded storage for one component of a batch. */
+		typedef std::vector<float, Allocator<float>> Array;
+
+#if defined(__AVX__)
+		/** @brief Eight packed floats (AVX). */
+		struct Lane {
+			static constexpr unsigned N = 8;
+			__m256 v;
+			static Lane load(float const *p) { return {_mm256_load_ps(p)}; }
+			static Lane loadu(float const *p) { return {_mm256_loadu_ps(p)}; }
+			static Lane broadcast(float f) { return {_mm256_set1_ps(f)}; }
+			void store(float *p) const { _mm256_store_ps(p, v); }
+			void storeu(float *p) const { _mm256_storeu_ps(p, v); }
+			void stream(float *p) const { _mm256_stream_ps(p, v); }
+			Lane operator-(void) const
+				{ return {_mm256_xor_ps(v, _mm256_set1_ps(-0.f))}; }
+			friend Lane operator+(Lane l, Lane r)
+				{ return {_mm256_add_ps(l.v, r.v)}; }
+			friend Lane operator-(Lane l, Lane r)
+				{ return {_mm256_sub_ps(l.v, r.v)}; }
+			friend Lane operator*(Lane l, Lane r)
+				{ return {_mm256_mul_ps(l.v, r.v)}; }
+			friend Lane operator/(Lane l, Lane r)
+				{ return {_mm256_div_ps(l.v, r.v)}; }
+			friend Lane sqrt(Lane l) { return {_mm256_sqrt_ps(l.v)}; }
+			/** @brief Reciprocal square root estimate, to 1.5 * 2^-12. */
+			friend Lane rsqrt(Lane l) { return {_mm256_rsqrt_ps(l.v)}; }
+			friend Lane min(Lane l, Lane r) { return {_mm256_min_ps(l.v, r.v)}; }
+			friend Lane max(Lane l, Lane r) { return {_mm256_max_ps(l.v, r.v)}; }
+			friend Lane operator<(Lane l, Lane r)
+				{ return {_mm256_cmp_ps(l.v, r.v, _CMP_LT_OQ)}; }
+			friend Lane operator<=(Lane l, Lane r)
+				{ return {_mm256_cmp_ps(l.v, r.v, _CMP_LE_OQ)}; }
+			friend Lane operator>(Lane l, Lane r) { return r < l; }
+			friend Lane operator>=(Lane l, Lane r) { return r <= l; }
+			friend Lane operator&(Lane l, Lane r)
+				{ return {_mm256_and_ps(l.v, r.v)}; }
+			friend Lane operator|(Lane l, Lane r)
+				{ return {_mm256_or_ps(l.v, r.v)}; }
+			/** @brief Per-lane choice of t where mask is set, else f. */
+			friend Lane select(Lane mask, Lane t, Lane f)
+				{ return {_mm256_blendv_ps(f.v, t.v, mask.v)}; }
+			/** @brief One bit per lane, set where the mask is set. */
+			friend unsigned bits(Lane mask)
+				{ return unsigned(_mm256_movemask_ps(mask.v)); }
+#if defined(__FMA__)
+			friend Lane mul_add(Lane a, Lane b, Lane c)
+				{ return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+#else
+			friend Lane mul_add(Lane a, Lane b, Lane c) { return a*b + c; }
+#endif
+		};
+#elif defined(__SSE2__)
+		/** @brief Four packed floats (SSE). */
+		struct Lane {
+			static constexpr unsigned N = 4;
+			__m128 v;
+			static Lane load(float const *p) { return {_mm_load_ps(p)}; }
+			static Lane loadu(float const *p) { return {_mm_loadu_ps(p)}; }
+			static Lane broadcast(float f) { return {_mm_set1_ps(f)}; }
+			void store(float *p) const { _mm_store_ps(p, v); }
+			void storeu(float *p) const { _mm_storeu_ps(p, v); }
+			void stream(float *p) const { _mm_stream_ps(p, v); }
+			Lane operator-(void) const
+				{ return {_mm_xor_ps(v, _mm_set1_ps(-0.f))}; }
+			friend Lane operator+(Lane l, Lane r)
+				{ return {_mm_add_ps(l.v, r.v)}; }
+			friend Lane operator-(Lane l, Lane r)
+				{ return {_mm_sub_ps(l.v, r.v)}; }
+			friend Lane operator*(Lane l, Lane r)
+				{ return {_mm_mul_ps(l.v, r.v)}; }
+			friend Lane operator/(Lane l, Lane r)
+				{ return {_mm_div_ps(l.v, r.v)}; }
+			friend Lane sqrt(Lane l) { return {_mm_sqrt_ps(l.v)}; }
+			/** @brief Reciprocal square root estimate, to 1.5 * 2^-12. */
+			friend Lane rsqrt(Lane l) { return {_mm_rsqrt_ps(l.v)}; }
+			friend Lane min(Lane l, Lane r) { return {_mm_min_ps(l.v, r.v)}; }
+			friend Lane max(Lane l, Lane r) { return {_mm_max_ps(l.v, r.v)}; }
+			friend Lane operator<(Lane l, Lane r)
+				{ return {_mm_cmplt_ps(l.v, r.v)}; }
+			friend Lane operator<=(Lane l, Lane r)
+				{ return {_mm_cmple_ps(l.v, r.v)}; }
+			friend Lane operator>(Lane l, Lane r) { return r < l; }
+			friend Lane operator>=(Lane l, Lane r) { return r <= l; }
+			friend Lane operator&(Lane l, Lane r)
+				{ return {_mm_and_ps(l.v, r.v)}; }
+			friend Lane operator|(Lane l, Lane r)
+				{ return {_mm_or_ps(l.v, r.v)}; }
+			/** @brief Per-lane choice of t where mask is set, else f. */
+			friend Lane select(Lane mask, Lane t, Lane f) {
+				return {_mm_or_ps(_mm_and_ps(mask.v, t.v),
+					_mm_andnot_ps(mask.v, f.v))};
+			}
+			/** @brief One bit per lane, set where the mask is set. */
+			friend unsigned bits(Lane mask)
+				{ return unsigned(_mm_movemask_ps(mask.v)); }
+#if defined(__FMA__)
+			friend Lane mul_add(Lane a, Lane b, Lane c)
+				{ return {_mm_fmadd_ps(a.v, b.v, c.v)}; }
+#else
+			friend Lane mul_add(Lane a, Lane b, Lane c) { return a*b + c; }
+#endif
+		};
+#else
+		/** @brief One float; keeps the kernels portable without SIMD. */
+		struct Lane {
+			static constexpr unsigned N = 1;
+			float v;
+			static Lane load(float const *p) { return {*p}; }
+			static Lane loadu(float const *p) { return {*p}; }
+			static Lane broadcast(float f) { return {f}; }
+			void store(float *p) const { *p = v; }
+			void storeu(float *p) const { *p = v; }
+			void stream(float *p) const { *p = v; }
+			Lane operator-(void) const { return {-v}; }
+			friend Lane operator+(Lane l, Lane r) { return {l.v + r.v}; }
+			friend Lane operator-(Lane l, Lane r) { return {l.v - r.v}; }
+			friend Lane operator*(Lane l, Lane r) { return {l.v * r.v}; }
+			friend Lane operator/(Lane l, Lane r) { return {l.v / r.v}; }
+			friend Lane sqrt(Lane l) { return {::sqrtf(l.v)}; }
+			friend Lane rsqrt(Lane l) { return {1 / ::sqrtf(l.v)}; }
+			friend Lane min(Lane l, Lane r) { return {l.v < r.v ? l.v : r.v}; }
+			friend Lane max(Lane l, Lane r) { return {l.v < r.v ? r.v : l.v}; }
+			/* Masks are all-ones or all-zeros bit patterns, as in SSE/AVX */
+			static Lane mask(bool b) {
+				float f; unsigned u = b ? ~0u : 0u;
+				memcpy(&f, &u, sizeof f);
+				return {f};
+			}
+			static unsigned word(Lane l) {
+				unsigned u; memcpy(&u, &l.v, sizeof u);
+				return u;
+			}
+			friend Lane operator<(Lane l, Lane r) { return mask(l.v < r.v); }
+			friend Lane operator<=(Lane l, Lane r) { return mask(l.v <= r.v); }
+			friend Lane operator>(Lane l, Lane r) { return r < l; }
+			friend Lane operator>=(Lane l, Lane r) { return r <= l; }
+			friend Lane operator&(Lane l, Lane r)
+				{ return mask(word(l) & word(r)); }
+			friend Lane operator|(Lane l, Lane r)
+				{ return mask(word(l) | word(r)); }
+			/** @brief Per-lane choice of t where mask is set, else f. */
+			friend Lane select(Lane mask, Lane t, Lane f)
+				{ return word(mask) ? t : f; }
+			/** @brief One bit per lane, set where the mask is set. */
+			friend unsigned bits(Lane mask) { return word(mask) ? 1 : 0; }
+			friend Lane mul_add(Lane a, Lane b, Lane c) { return a*b + c; }
+		};
+#endif
+
+		/** @brief Four packed floats regardless of the lane width, e.g. one
+		 * homogeneous vertex or one row of a 4x4 matrix. */
+		struct Quad {
+#if defined(__SSE2__)
+			__m128 v;
+			static Quad load(float const *p) { return {_mm_load_ps(p)}; }
+			static Quad loadu(float const *p) { return {_mm_loadu_ps(p)}; }
+			static Quad broadcast(float f) { return {_mm_set1_ps(f)}; }
+			void store(float *p) const { _mm_store_ps(p, v); }
+			void storeu(float *p) const { _mm_storeu_ps(p, v); }
+			void stream(float *p) const { _mm_stream_ps(p, v); }
+			friend Quad operator+(Quad l, Quad r)
+				{ return {_mm_add_ps(l.v, r.v)}; }
+			friend Quad operator*(Quad l, Quad r)
+				{ return {_mm_mul_ps(l.v, r.v)}; }
+#if defined(__FMA__)
+			friend Quad mul_add(Quad a, Quad b, Quad c)
+				{ return {_mm_fmadd_ps(a.v, b.v, c.v)}; }
+#else
+			friend Quad mul_add(Quad a, Quad b, Quad c) { return a*b + c; }
+#endif
+#else
+			float v[4];
+			static Quad load(float const *p) { return {{p[0], p[1], p[2], p[3]}}; }
+			static Quad loadu(float const *p) { return load(p); }
+			static Quad broadcast(float f) { return {{f, f, f, f}}; }
+			void store(float *p) const
+				{ for(unsigned i = 0; i < 4; i++) p[i] = v[i]; }
+			void storeu(float *p) const { store(p); }
+			void stream(float *p) const { store(p); }
+			friend Quad operator+(Quad l, Quad r) {
+				return {{l.v[0] + r.v[0], l.v[1] + r.v[1],
+					l.v[2] + r.v[2], l.v[3] + r.v[3]}};
+			}
+			friend Quad operator*(Quad l, Quad r) {
+				return {{l.v[0] * r.v[0], l.v[1] * r.v[1],
+					l.v[2] * r.v[2], l.v[3] * r.v[3]}};
+			}
+			friend Quad mul_add(Quad a, Quad b, Quad c) { return a*b + c; }
+#endif
+		};
+
+		/** @brief Orders non-temporal (stream) stores before later stores. */
+		inline void fence(void) {
+#if defined(__SSE2__)
+			_mm_sfence();
+#endif
+		}
+
+		static_assert(block % Lane::N == 0,
+			"The padded block must hold a whole number of lanes.");
+	}
+}
+
+#endif
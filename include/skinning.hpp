@@ -0,0 +1,74 @@
+/*! @file include/skinning.hpp
+ *  @brief Dual-quaternion linear blend skinning over SoA vertex batches */
+
+#ifndef SKINNING_HPP
+#define SKINNING_HPP
+
+#include "dual_quaternion.hpp"
+#include "batch.hpp"
+
+///@cond
+#include <vector>
+///@endcond
+
+namespace Model {
+	using Geometry::DualQuat_t;
+	using Geometry::Vec_t;
+	using Geometry::VecBatch;
+
+	/** @brief Bind-pose vertices with up to four weighted bone influences;
+	 * each influence slot is its own padded array so that the blend runs a
+	 * whole SIMD lane of vertices at a time. */
+	struct Skin {
+		static constexpr unsigned influences = 4;
+
+		VecBatch positions, normals;
+		std::vector<unsigned> bones[influences];
+		Geometry::Simd::Array weights[influences];
+
+		std::size_t size(void) const;
+		void resize(std::size_t n);
+		/** @brief Sets one vertex and its influences; unused slots get bone
+		 * 0 with weight 0.
+		 * @param i The vertex index
+		 * @param p The bind-pose position
+		 * @param n The bind-pose normal
+		 * @param b The bone indices (count entries)
+		 * @param w The bone weights (count entries; normalized on use)
+		 * @param count The number of influences, at most four */
+		void set(std::size_t i, Vec_t<float> const& p, Vec_t<float> const& n,
+			unsigned const *b, float const *w, unsigned count);
+
+		Skin(std::size_t n = 0);
+	};
+
+	/** @brief One skinned instance: shared bind-pose data, its current
+	 * bone transforms and the destination batches. */
+	struct SkinJob {
+		Skin const *skin;
+		DualQuat_t<float> const *bones;
+		VecBatch *positions, *normals;
+	};
+
+	/**
+	 * @brief Blends and applies the bone transforms to every vertex.
+	 *
+	 * Each bone is a unit dual quaternion u + ev with v = tu/2, i.e. the
+	 * rotation u followed by the translation t, already composed with the
+	 * inverse bind pose. Influences are sign-aligned to the first before
+	 * blending so that antipodal bones do not cancel, then the blend is
+	 * normalized; positions receive the rigid transform and normals only
+	 * the rotation.
+	 * @param s The bind-pose data
+	 * @param bones The bone transforms indexed by Skin::bones
+	 * @param positions The skinned positions (resized to match)
+	 * @param normals The skinned normals (resized to match)
+	 */
+	void skin(Skin const& s, DualQuat_t<float> const *bones,
+			VecBatch& positions, VecBatch& normals);
+	/** @brief Skins every job, splitting all of their vertices together
+	 * across the shared pool. */
+	void skin(SkinJob const *jobs, std::size_t count);
+}
+
+#endif
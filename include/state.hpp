@@ -0,0 +1,95 @@
+/*! @file include/state.hpp
+ *  @brief Shadow of the GL binding state, filtering redundant calls */
+
+#ifndef STATE_HPP
+#define STATE_HPP
+
+#include "view.hpp"
+
+///@cond
+#include <map>
+///@endcond
+
+namespace View {
+
+	/**
+	 * @brief Mirrors the program, vertex array, buffer and texture bindings
+	 * and the capabilities of the current context, and issues a bind or an
+	 * enable only if it changes the state.
+	 *
+	 * Each thread has its own shadow, as each has its own current context.
+	 * The shadow only sees calls made through it, so state changed behind
+	 * its back, and switching contexts, need invalidate(). Deleting a bound
+	 * object unbinds it, so deleted names are forgotten before reuse. The
+	 * element buffer is vertex array state and is unknown after a vertex
+	 * array is bound.
+	 */
+	struct State {
+		/** @brief Tallies of state calls. */
+		struct Counters {
+			/** @brief The calls passed on to GL. */
+			unsigned issued = 0;
+			/** @brief The calls dropped as redundant. */
+			unsigned filtered = 0;
+		};
+		/** @brief The texture units tracked; others pass through. */
+		static constexpr unsigned units = 16;
+		/** @brief The uniform buffer binding points tracked. */
+		static constexpr unsigned blocks = 16;
+
+		/** @brief The shadow of the context current on this thread. */
+		static State& current(void);
+
+		/** @brief The calls since the last frame() or invalidate(). */
+		Counters const& counters(void) const;
+		/** @brief Ends a frame, restarting the counters.
+		 * @return The calls of the frame */
+		Counters frame(void);
+		/** @brief Forgets all state, e.g. after a context switch or calls
+		 * made without the shadow. */
+		void invalidate(void);
+
+		/** @return True if the call was issued, false if filtered. */
+		bool program(GLuint id);
+		bool vao(GLuint id);
+		bool buffer(GLenum target, GLuint id);
+		/** @brief Binds a range of a buffer to an indexed binding point,
+		 * and the buffer to the target, as glBindBufferRange. */
+		bool range(GLenum target, GLuint index, GLuint id,
+				GLintptr offset, GLsizeiptr size);
+		bool texture(unsigned unit, GLenum target, GLuint id);
+		bool enable(GLenum cap, bool on = true);
+		bool disable(GLenum cap) { return enable(cap, false); }
+
+		/** @brief Forgets a name about to be deleted, so that a name
+		 * reissued by GL is bound anew. */
+		void forget_program(GLuint id);
+		void forget_vao(GLuint id);
+		void forget_buffer(GLuint id);
+		void forget_texture(GLuint id);
+
+		State(void);
+	protected:
+		/* Marks a binding as unknown; GL never issues this name. */
+		static constexpr GLuint unknown = ~GLuint(0);
+		/* The buffer and texture targets tracked. */
+		static constexpr unsigned buffers = 8, textures = 7;
+
+		/* A range bound to an indexed point. */
+		struct Range {
+			GLuint id;
+			GLintptr offset;
+			GLsizeiptr size;
+		};
+
+		bool count(bool changed);
+
+		Counters m_counters;
+		GLuint m_program, m_vao, m_buffers[buffers],
+			m_textures[units][textures], m_unit;
+		Range m_ranges[blocks];
+		std::map<GLenum, bool> m_caps;
+	};
+}
+
+#endif
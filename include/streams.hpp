@@ -61,6 +61,8 @@ namespace Geometry {
 	S& operator<<(S& dest, Quat_t<T> const& src);
 	template<typename S, typename T>
 	S& operator<<(S& dest, DualQuat_t<T> const& src);
+	template<typename S, typename OP, typename L, typename R>
+	S& operator<<(S& dest, Node<OP, L, R> const& src);
 	template<typename S, typename T>
 	S& operator<<(S& dest, Vec_t<T> const& src);
 	template<typename S, typename T>
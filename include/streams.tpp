@@ -47,6 +47,10 @@ namespace Geometry {
 		dest << std::noshowpos;
 		return dest;
 	}
+	template<typename S, typename OP, typename L, typename R>
+	S& operator<<(S& dest, Node<OP, L, R> const& src) {
+		return dest << typename Node<OP, L, R>::value_type(src);
+	}
 	template<typename S, typename T>
 	S& operator<<(S& dest, Vec_t<T> const& src) {
 		//Streams::Paster paster;
@@ -0,0 +1,96 @@
+/*! @file include/tables.hpp
+ *  @brief Basis and rotation tables generated at compile time */
+
+#ifndef TABLES_HPP
+#define TABLES_HPP
+
+#include "quaternion.hpp"
+#include "dual_quaternion.hpp"
+
+///@cond
+#include <cstddef>
+///@endcond
+
+namespace Geometry {
+	namespace Tables {
+
+		/** @brief Fixed-size array usable in constant expressions, where
+		 * std::array cannot be written to until C++17.
+		 * @tparam T The element type
+		 * @tparam N The number of elements */
+		template<typename T, std::size_t N>
+		struct Table_t {
+			T data[N];
+			static constexpr std::size_t size(void) { return N; }
+			constexpr T const& operator[](std::size_t i) const {
+				return data[i];
+			}
+			constexpr T& operator[](std::size_t i) { return data[i]; }
+			constexpr T const* begin(void) const { return data; }
+			constexpr T const* end(void) const { return data + N; }
+		};
+
+		/**
+		 * @brief Every product of two basis elements.
+		 * @tparam Q The element type
+		 * @tparam N The size of the basis
+		 * @param basis The basis
+		 * @return The table where entry N*i + j is basis[i] * basis[j]
+		 */
+		template<typename Q, std::size_t N>
+		constexpr Table_t<Q, N*N> products(Table_t<Q, N> const& basis) {
+			Table_t<Q, N*N> out = {};
+			for(std::size_t i = 0; i < N; i++)
+				for(std::size_t j = 0; j < N; j++)
+					out[N*i + j] = basis[i] * basis[j];
+			return out;
+		}
+
+		/**
+		 * @brief Rotations evenly spaced over one turn about an axis.
+		 * @tparam X The domain of the rotations
+		 * @tparam N The number of rotations
+		 * @param axis The rotation axis, normalized
+		 * @return The table where entry k is rotation(2 pi k/N, axis)
+		 */
+		template<typename X, std::size_t N>
+		constexpr Table_t<Quat_t<X>, N> turns(Vec_t<X> const& axis) {
+			Table_t<Quat_t<X>, N> out = {};
+			for(std::size_t k = 0; k < N; k++)
+				out[k] = Constant::rotation(X(2 * Constant::pi * k / N),
+					axis);
+			return out;
+		}
+
+		/** @brief The quaternion units 1, i, j, k. */
+		template<typename X = float>
+		constexpr Table_t<Quat_t<X>, 4> quat_basis = {{
+			{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}
+		}};
+		/** @brief The dual quaternion units 1, i, j, k, e, ei, ej, ek. */
+		template<typename X = float>
+		constexpr Table_t<DualQuat_t<X>, 8> dual_basis = {{
+			{quat_basis<X>[0], {}}, {quat_basis<X>[1], {}},
+			{quat_basis<X>[2], {}}, {quat_basis<X>[3], {}},
+			{{}, quat_basis<X>[0]}, {{}, quat_basis<X>[1]},
+			{{}, quat_basis<X>[2]}, {{}, quat_basis<X>[3]}
+		}};
+		/** @brief The multiplication table of quat_basis. */
+		template<typename X = float>
+		constexpr Table_t<Quat_t<X>, 16> quat_products
+			= products(quat_basis<X>);
+		/** @brief The multiplication table of dual_basis. */
+		template<typename X = float>
+		constexpr Table_t<DualQuat_t<X>, 64> dual_products
+			= products(dual_basis<X>);
+		/** @brief Quarter turns about the x, y and z axes. */
+		template<typename X = float>
+		constexpr Table_t<Quat_t<X>, 3> quarter_turns = {{
+			Constant::rotation(X(Constant::pi / 2), Vec_t<X>{1, 0, 0}),
+			Constant::rotation(X(Constant::pi / 2), Vec_t<X>{0, 1, 0}),
+			Constant::rotation(X(Constant::pi / 2), Vec_t<X>{0, 0, 1})
+		}};
+	}
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*! @file include/timer.hpp
+ *  @brief GPU frame and pass timing from timestamp queries */
+
+#ifndef TIMER_HPP
+#define TIMER_HPP
+
+#include "view.hpp"
+
+///@cond
+#include <deque>
+#include <utility>
+#include <vector>
+///@endcond
+
+namespace View {
+
+	/**
+	 * @brief Measures the time the GPU spends on each frame and on named
+	 * passes within it, without waiting for the GPU.
+	 *
+	 * Every mark is a GL_TIMESTAMP query, so passes may nest, unlike
+	 * GL_TIME_ELAPSED queries. The queries of each frame occupy one slot of
+	 * a ring; a slot is read when the ring comes back around to it, frames
+	 * later, and only if its results are available. A frame that is still
+	 * in flight is dropped rather than waited for.
+	 *
+	 * GL objects are created on first use, as in StreamBuffer.
+	 */
+	struct GpuTimer {
+		/** @brief The number of frames whose queries may be in flight. */
+		static constexpr unsigned frames = 4;
+		/** @brief The most passes timed in one frame; more are ignored. */
+		static constexpr unsigned passes = 16;
+
+		/** @brief Begins the GPU commands of a frame, first collecting
+		 * any earlier frames that have completed. */
+		void start(void);
+		/** @brief Ends the GPU commands of a frame. */
+		void stop(void);
+		/** @brief Begins a pass.
+		 * @param name The name of the pass; must outlive the results, as
+		 * a string literal does */
+		void begin(const char *name);
+		/** @brief Ends the innermost pass. */
+		void end(void);
+
+		/** @brief Milliseconds from the start to the stop of the latest
+		 * collected frame. */
+		double last(void) const;
+		/** @brief The mean of last() over recent frames. */
+		double average(void) const;
+		/** @brief The pass names and milliseconds of the latest collected
+		 * frame, in the order the passes began. */
+		std::vector<std::pair<const char*, double>> const&
+			timings(void) const;
+		/** @brief The number of frames collected and dropped. */
+		unsigned collected(void) const;
+		unsigned dropped(void) const;
+
+		template<typename OS>
+		friend OS& operator<<(OS& os, GpuTimer const& t) {
+			if(!t.m_collected) return os;
+			os << "GPU ms: " << t.last() << " (average " << t.average();
+			for(auto const& p : t.m_timings)
+				os << ", " << p.first << ' ' << p.second;
+			os << ')';
+			return os;
+		}
+
+		GpuTimer(unsigned max_samples = 60);
+		GpuTimer(GpuTimer const&) = delete;
+		GpuTimer& operator=(GpuTimer const&) = delete;
+		virtual ~GpuTimer(void);
+	protected:
+		/* The queries of one frame: its start and stop, then the begin and
+		 * end of each pass. */
+		struct Slot {
+			GLuint queries[2 + 2 * passes];
+			const char *names[passes];
+			/* The passes begun, and the stack of those still open, where
+			 * passes marks one beyond the limit. */
+			unsigned count = 0, open[passes], depth = 0, overflow = 0;
+			bool pending = false;
+		};
+		/* Reads the results of a slot if they are available. */
+		bool collect(Slot &slot);
+
+		Slot m_slots[frames];
+		unsigned m_frame = 0, m_max, m_collected = 0, m_dropped = 0;
+		bool m_created = false, m_started = false;
+		double m_last = 0, m_sum = 0;
+		std::deque<double> m_samples;
+		std::vector<std::pair<const char*, double>> m_timings;
+	};
+}
+
+#endif
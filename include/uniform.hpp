@@ -0,0 +1,92 @@
+/*! @file include/uniform.hpp
+ *  @brief Uniform blocks sub-allocated from one streamed buffer */
+
+#ifndef UNIFORM_HPP
+#define UNIFORM_HPP
+
+#include "view.hpp"
+#include "buffer.hpp"
+
+///@cond
+#include <cstddef>
+///@endcond
+
+namespace View {
+
+	/** @brief The std140 layout of the Frame block of share/ shaders,
+	 * written once per frame. */
+	struct FrameBlock {
+		/** @brief The view-projection, as uploaded to glUniformMatrix4fv
+		 * without transposition. */
+		float mvp[16];
+	};
+	/** @brief The std140 layout of the Object block, written per draw. */
+	struct ObjectBlock {
+		/** @brief The model transform, applied before the Frame mvp. */
+		float model[16];
+	};
+
+	/**
+	 * @brief Uniform block data for many objects, written into the ring of
+	 * a StreamBuffer and bound by range.
+	 *
+	 * Each block is padded to the context's offset alignment, so a whole
+	 * run of objects is written with one allocation and each is bound with
+	 * glBindBufferRange instead of a buffer per block. Binding points come
+	 * from Shaders::blockBinding, shared with every program.
+	 */
+	struct UniformBuffer {
+		/** @brief A run of blocks of one frame. */
+		struct Blocks {
+			/** @brief The memory and location of the run. */
+			StreamBuffer::Slice slice;
+			/** @brief The byte size of each block, and the distance
+			 * between the starts of consecutive blocks. */
+			GLsizeiptr size = 0, stride = 0;
+			/** @brief The number of blocks. */
+			std::size_t count = 0;
+			/** @brief Where to write block i; valid until commit(). */
+			void* operator[](std::size_t i) const {
+				return static_cast<char*>(slice.data) + i * stride;
+			}
+			explicit operator bool(void) const { return count; }
+		};
+
+		/** @brief The required alignment of a bound range. */
+		GLsizeiptr alignment(void);
+
+		/** @brief Allocates blocks from the region of the current frame.
+		 * @param count The number of blocks
+		 * @param size The byte size of each block
+		 * @return The blocks; empty if the region is full */
+		Blocks allocate(std::size_t count, GLsizeiptr size);
+		/** @brief Allocates, writes and commits one block.
+		 * @return The block; empty if it could not be written */
+		template<typename T>
+		Blocks push(T const& t);
+		/** @brief Publishes the blocks after writing them.
+		 * @return False if the data was lost */
+		bool commit(Blocks &blocks);
+		/** @brief Binds block i to a binding point; filtered if bound. */
+		void bind(GLuint binding, Blocks const& blocks, std::size_t i = 0);
+		/** @brief Ends the frame, as StreamBuffer::fence. */
+		void fence(void);
+
+		UniformBuffer(GLsizeiptr capacity);
+		virtual ~UniformBuffer(void) {}
+	protected:
+		StreamBuffer m_stream;
+		GLsizeiptr m_alignment = 0;
+	};
+
+	template<typename T>
+	UniformBuffer::Blocks UniformBuffer::push(T const& t) {
+		auto blocks = allocate(1, sizeof(T));
+		if(!blocks) return blocks;
+		*static_cast<T*>(blocks[0]) = t;
+		if(!commit(blocks)) blocks.count = 0;
+		return blocks;
+	}
+}
+
+#endif
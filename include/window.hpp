@@ -6,8 +6,17 @@
 
 #include "view.hpp"
 #include "events.hpp"
+#include "bvh.hpp"
+#include "buffer.hpp"
+#include "queue.hpp"
+#include "pacer.hpp"
+#include "state.hpp"
+#include "uniform.hpp"
+#include "timer.hpp"
+#include "offscreen.hpp"
 
 ///@cond
+#include <functional>
 #include <map>
 #include <glbinding/Binding.h>
 ///@endcond
@@ -33,8 +42,54 @@ namespace View {
 		SDL_Window *m_win;
 		SDL_GLContext m_ctx;
 		Streams::ErrorFIFO m_errors;
+		/* The model-view-projection of the last frame drawn; zero, so
+		 * that nothing is picked, before the first. */
+		Geometry::Matrix_t<float> m_mvp = {};
+		/* The inverse of m_mvp, computed with it once per frame rather than
+		 * per pick, and whether it exists. */
+		Geometry::Matrix_t<float> m_unproject = {};
+		bool m_invertible = false;
+		/* Vertices written by the CPU each frame. */
+		StreamBuffer m_stream{1 << 20};
+		/* Frame and Object blocks written each frame. */
+		UniformBuffer m_uniforms{1 << 16};
+		/* The framebuffer drawn to instead of the window when headless. */
+		RenderTarget m_target;
 	public:
 		unsigned m_width, m_height;
+		/** @brief The triangles picked by the mouse handlers, if any;
+		 * owned by the application, in the space m_mvp maps from. */
+		Geometry::Bvh const *m_scene = nullptr;
+		/** @brief The nearest hits under the cursor and under the last
+		 * button press. */
+		Geometry::Hit m_hover, m_pick;
+		/** @brief Paces draw() to its target rate, 60 Hz by default. */
+		Pacer m_pacer;
+		/** @brief The state calls of the last frame drawn, issued and
+		 * filtered as redundant. */
+		State::Counters m_calls;
+		/** @brief Times the GPU work of each frame and its passes. */
+		GpuTimer m_gpu;
+		/** @brief True if the window was created hidden; frames are then
+		 * drawn offscreen and read back instead of swapped. */
+		bool m_headless = false;
+		/** @brief True to read back frames drawn to the window as well,
+		 * e.g. to capture them. */
+		bool m_record = false;
+		/** @brief The program of the quad, which reads the view-projection
+		 * from its Frame block and the model transform from its Object
+		 * block. */
+		GLuint m_program = 0;
+		/** @brief The draws of a frame, the quad's among them, sorted by
+		 * state and submitted after m_draw. */
+		RenderQueue m_queue;
+		/** @brief Adds more of the scene with the Frame block of the frame
+		 * bound, e.g. instanced meshes queued to m_queue; draws issued
+		 * directly precede the queued ones. */
+		std::function<void(void)> m_draw;
+		/** @brief Hands the frames drawn headless or recorded to its
+		 * sink. */
+		Readback m_readback;
 		//operator bool(void) const;
 		operator SDL_Window *const(void) const;
 		operator SDL_GLContext const(void) const;
@@ -44,9 +99,37 @@ namespace View {
 		FSignal validate(void);
 		template<typename T> FSignal handle(T const& ev);
 
+		/** @brief Casts one ray per pixel of a rectangle of the window
+		 * into m_scene, as packets of neighbouring pixels.
+		 * @param x The left edge in window pixels
+		 * @param y The top edge in window pixels
+		 * @param w The width in pixels
+		 * @param h The height in pixels
+		 * @param hits The destination, row by row; all misses without a
+		 * scene or an invertible projection
+		 */
+		void pick(int x, int y, unsigned w, unsigned h,
+				Geometry::Hit *hits) const;
+
+		/** @brief Sets the swap interval, letting the swap pace frames
+		 * while it waits for vertical sync.
+		 * @param interval 0 for immediate swaps, 1 for vsync, or -1 for
+		 * adaptive vsync, falling back to vsync where unsupported
+		 * @return False if the interval could not be set */
+		bool swap_interval(int interval);
+
+		/** @brief The stream of the quad, fenced after each submit, so
+		 * queued draws may take slices of it for the frame. */
+		StreamBuffer& stream(void);
+
 		FSignal update(unsigned frame);
-		FSignal draw(unsigned frame, GLint id_mvp);
+		/** @brief Draws a frame: queues the quad with m_program, calls
+		 * m_draw if it is set, then submits m_queue. */
+		FSignal draw(unsigned frame);
 
+		/** @brief Creates the window and its context.
+		 * @param flags SDL window flags; SDL_WINDOW_HIDDEN makes the
+		 * window headless, e.g. with the offscreen video driver */
 		Window(const char *title, int w, int h,
 			Uint32 flags, std::map<SDL_GLattr, int> const& attribs);
 	};
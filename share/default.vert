@@ -1,9 +1,14 @@
 #version 330
 
-uniform mat4 mvp;
+layout(std140) uniform Frame {
+	mat4 mvp;
+};
+layout(std140) uniform Object {
+	mat4 model;
+};
 
 in vec4 arg0;
 
 void main(){
-	gl_Position = mvp * arg0;
+	gl_Position = mvp * (model * arg0);
 }
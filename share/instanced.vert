@@ -0,0 +1,12 @@
+#version 330
+
+layout(std140) uniform Frame {
+	mat4 mvp;
+};
+
+layout(location = 0) in vec4 arg0;
+layout(location = 1) in mat4 model;
+
+void main(){
+	gl_Position = mvp * (model * arg0);
+}
@@ -0,0 +1,412 @@
+/*! @file src/batch.cpp
+ *  @brief Implementation of the SoA types and kernels from batch.hpp */
+
+#include "batch.hpp"
+
+///@cond
+#include <algorithm>
+#include <cmath>
+///@endcond
+
+namespace Geometry {
+	using Simd::Lane;
+
+	std::size_t VecBatch::size(void) const { return count; }
+	void VecBatch::resize(std::size_t n) {
+		auto p = Simd::padded(n);
+		for(auto *a : {&x, &y, &z}) {
+			a -> resize(p);
+			std::fill(a -> begin() + n, a -> end(), 0.f);
+		}
+		count = n;
+	}
+	Vec_t<float> VecBatch::operator[](std::size_t i) const {
+		return {x[i], y[i], z[i]};
+	}
+	void VecBatch::set(std::size_t i, Vec_t<float> const& v) {
+		x[i] = v.x; y[i] = v.y; z[i] = v.z;
+	}
+	VecBatch::VecBatch(std::size_t n) { resize(n); }
+
+	std::size_t QuatBatch::size(void) const { return count; }
+	void QuatBatch::resize(std::size_t n) {
+		auto p = Simd::padded(n);
+		for(auto *a : {&w, &x, &y, &z}) {
+			a -> resize(p);
+			std::fill(a -> begin() + n, a -> end(), 0.f);
+		}
+		count = n;
+	}
+	Quat_t<float> QuatBatch::operator[](std::size_t i) const {
+		return {w[i], x[i], y[i], z[i]};
+	}
+	void QuatBatch::set(std::size_t i, Quat_t<float> const& q) {
+		w[i] = q.w; x[i] = q.x; y[i] = q.y; z[i] = q.z;
+	}
+	QuatBatch::QuatBatch(std::size_t n) { resize(n); }
+
+	std::size_t DualQuatBatch::size(void) const { return u.size(); }
+	void DualQuatBatch::resize(std::size_t n) {
+		u.resize(n);
+		v.resize(n);
+	}
+	DualQuat_t<float> DualQuatBatch::operator[](std::size_t i) const {
+		return {u[i], v[i]};
+	}
+	void DualQuatBatch::set(std::size_t i, DualQuat_t<float> const& q) {
+		u.set(i, q.u);
+		v.set(i, q.v);
+	}
+	DualQuatBatch::DualQuatBatch(std::size_t n) { resize(n); }
+
+	/* Zeroes the padding of a component past n. Kernels over padded(n)
+	 * lanes call it once done, so that neither a longer input nor lanes
+	 * that map zero to something else (e.g. a translation) leave values
+	 * in the padding of dest. */
+	static inline void clear(Simd::Array& a, std::size_t n) {
+		std::fill(a.begin() + n, a.end(), 0.f);
+	}
+
+	/* A lane of quaternions as w, x, y, z. */
+	static inline void load(QuatBatch const& q, std::size_t i, Lane *o) {
+		o[0] = Lane::load(&q.w[i]); o[1] = Lane::load(&q.x[i]);
+		o[2] = Lane::load(&q.y[i]); o[3] = Lane::load(&q.z[i]);
+	}
+	static inline void store(Lane const *o, QuatBatch& q, std::size_t i) {
+		o[0].store(&q.w[i]); o[1].store(&q.x[i]);
+		o[2].store(&q.y[i]); o[3].store(&q.z[i]);
+	}
+	static inline void product(Lane const *l, Lane const *r, Lane *o) {
+		o[0] = l[0]*r[0] - l[1]*r[1] - l[2]*r[2] - l[3]*r[3];
+		o[1] = l[0]*r[1] + l[1]*r[0] + l[2]*r[3] - l[3]*r[2];
+		o[2] = l[0]*r[2] - l[1]*r[3] + l[2]*r[0] + l[3]*r[1];
+		o[3] = l[0]*r[3] + l[1]*r[2] - l[2]*r[1] + l[3]*r[0];
+	}
+
+	void multiply(QuatBatch const& l, QuatBatch const& r, QuatBatch& dest) {
+		auto n = std::min(l.size(), r.size());
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			Lane a[4], b[4], o[4];
+			load(l, i, a);
+			load(r, i, b);
+			product(a, b, o);
+			store(o, dest, i);
+		}
+		for(auto *a : {&dest.w, &dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+
+	void multiply(DualQuatBatch const& l, DualQuatBatch const& r,
+			DualQuatBatch& dest) {
+		auto n = std::min(l.size(), r.size());
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			Lane a[4], b[4], c[4], d[4], ac[4], ad[4], bc[4];
+			load(l.u, i, a); load(l.v, i, b);
+			load(r.u, i, c); load(r.v, i, d);
+			product(a, c, ac);
+			product(a, d, ad);
+			product(b, c, bc);
+			for(unsigned k = 0; k < 4; k++) ad[k] = ad[k] + bc[k];
+			store(ac, dest.u, i);
+			store(ad, dest.v, i);
+		}
+		for(auto *q : {&dest.u, &dest.v})
+			for(auto *a : {&q -> w, &q -> x, &q -> y, &q -> z}) clear(*a, n);
+	}
+
+	void conjugate(QuatBatch const& src, QuatBatch& dest) {
+		auto n = src.size();
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			Lane::load(&src.w[i]).store(&dest.w[i]);
+			(-Lane::load(&src.x[i])).store(&dest.x[i]);
+			(-Lane::load(&src.y[i])).store(&dest.y[i]);
+			(-Lane::load(&src.z[i])).store(&dest.z[i]);
+		}
+		for(auto *a : {&dest.w, &dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+
+	/* q v q* = (w^2 - u.u) v + 2 (u.v) u + 2w (u x v) for any quaternion
+	 * q = w + u, which skips the terms that cancel in the two full products
+	 * of the scalar operator^ (including its zero real part). */
+	static inline void sandwich(Lane qw, Lane qx, Lane qy, Lane qz,
+			Lane &vx, Lane &vy, Lane &vz) {
+		auto two = Lane::broadcast(2),
+			 s = qw*qw - qx*qx - qy*qy - qz*qz,
+			 d = two * (qx*vx + qy*vy + qz*vz),
+			 w2 = two * qw,
+			 cx = qy*vz - qz*vy, cy = qz*vx - qx*vz, cz = qx*vy - qy*vx;
+		auto ox = s*vx + d*qx + w2*cx,
+			 oy = s*vy + d*qy + w2*cy,
+			 oz = s*vz + d*qz + w2*cz;
+		vx = ox; vy = oy; vz = oz;
+	}
+
+	void sandwich(QuatBatch const& q, VecBatch const& v, VecBatch& dest) {
+		auto n = std::min(q.size(), v.size());
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto vx = Lane::load(&v.x[i]), vy = Lane::load(&v.y[i]),
+				 vz = Lane::load(&v.z[i]);
+			sandwich(Lane::load(&q.w[i]), Lane::load(&q.x[i]),
+				Lane::load(&q.y[i]), Lane::load(&q.z[i]), vx, vy, vz);
+			vx.store(&dest.x[i]);
+			vy.store(&dest.y[i]);
+			vz.store(&dest.z[i]);
+		}
+		for(auto *a : {&dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+
+	void sandwich(Quat_t<float> const& q, VecBatch const& v, VecBatch& dest) {
+		auto n = v.size();
+		dest.resize(n);
+		auto qw = Lane::broadcast(q.w), qx = Lane::broadcast(q.x),
+			 qy = Lane::broadcast(q.y), qz = Lane::broadcast(q.z);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto vx = Lane::load(&v.x[i]), vy = Lane::load(&v.y[i]),
+				 vz = Lane::load(&v.z[i]);
+			sandwich(qw, qx, qy, qz, vx, vy, vz);
+			vx.store(&dest.x[i]);
+			vy.store(&dest.y[i]);
+			vz.store(&dest.z[i]);
+		}
+		for(auto *a : {&dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+
+	void dot(VecBatch const& l, VecBatch const& r, Simd::Array& dest) {
+		auto n = std::min(l.size(), r.size());
+		dest.resize(Simd::padded(n));
+		for(std::size_t i = 0, N = dest.size(); i < N; i += Lane::N) {
+			auto lx = Lane::load(&l.x[i]), ly = Lane::load(&l.y[i]),
+				 lz = Lane::load(&l.z[i]), rx = Lane::load(&r.x[i]),
+				 ry = Lane::load(&r.y[i]), rz = Lane::load(&r.z[i]);
+			mul_add(lx, rx, mul_add(ly, ry, lz * rz)).store(&dest[i]);
+		}
+		clear(dest, n);
+	}
+
+	void cross(VecBatch const& l, VecBatch const& r, VecBatch& dest) {
+		auto n = std::min(l.size(), r.size());
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto lx = Lane::load(&l.x[i]), ly = Lane::load(&l.y[i]),
+				 lz = Lane::load(&l.z[i]), rx = Lane::load(&r.x[i]),
+				 ry = Lane::load(&r.y[i]), rz = Lane::load(&r.z[i]);
+			(ly*rz - lz*ry).store(&dest.x[i]);
+			(lz*rx - lx*rz).store(&dest.y[i]);
+			(lx*ry - ly*rx).store(&dest.z[i]);
+		}
+		for(auto *a : {&dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+
+	/* 1/sqrt(x) from the estimate and one Newton step; zero, and so the
+	 * padding, maps to zero rather than to infinity. */
+	static inline Lane inverse_root(Lane x) {
+		auto zero = Lane::broadcast(0), y = rsqrt(x);
+		y = y * (Lane::broadcast(1.5f) - Lane::broadcast(.5f) * x * y * y);
+		return select(x > zero, y, zero);
+	}
+	static inline std::size_t count(unsigned mask) {
+		std::size_t n = 0;
+		for(; mask; mask &= mask - 1) n++;
+		return n;
+	}
+
+	void magnitude(VecBatch const& src, Simd::Array& dest) {
+		dest.resize(Simd::padded(src.size()));
+		for(std::size_t i = 0, N = dest.size(); i < N; i += Lane::N) {
+			auto x = Lane::load(&src.x[i]), y = Lane::load(&src.y[i]),
+				 z = Lane::load(&src.z[i]), m2 = x*x + y*y + z*z;
+			(m2 * inverse_root(m2)).store(&dest[i]);
+		}
+	}
+	void magnitude(QuatBatch const& src, Simd::Array& dest) {
+		dest.resize(Simd::padded(src.size()));
+		for(std::size_t i = 0, N = dest.size(); i < N; i += Lane::N) {
+			auto w = Lane::load(&src.w[i]), x = Lane::load(&src.x[i]),
+				 y = Lane::load(&src.y[i]), z = Lane::load(&src.z[i]),
+				 m2 = w*w + x*x + y*y + z*z;
+			(m2 * inverse_root(m2)).store(&dest[i]);
+		}
+	}
+
+	void normalize(VecBatch const& src, VecBatch& dest) {
+		auto n = src.size();
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto x = Lane::load(&src.x[i]), y = Lane::load(&src.y[i]),
+				 z = Lane::load(&src.z[i]),
+				 inv = inverse_root(x*x + y*y + z*z);
+			(x*inv).store(&dest.x[i]);
+			(y*inv).store(&dest.y[i]);
+			(z*inv).store(&dest.z[i]);
+		}
+	}
+	void normalize(QuatBatch const& src, QuatBatch& dest) {
+		auto n = src.size();
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto w = Lane::load(&src.w[i]), x = Lane::load(&src.x[i]),
+				 y = Lane::load(&src.y[i]), z = Lane::load(&src.z[i]),
+				 inv = inverse_root(w*w + x*x + y*y + z*z);
+			(w*inv).store(&dest.w[i]);
+			(x*inv).store(&dest.x[i]);
+			(y*inv).store(&dest.y[i]);
+			(z*inv).store(&dest.z[i]);
+		}
+	}
+
+	/* Blocks without drift are neither blended nor stored, so that a pass
+	 * over settled transforms only reads them. */
+	std::size_t renormalize(QuatBatch &q, float tolerance) {
+		auto zero = Lane::broadcast(0), one = Lane::broadcast(1),
+			 tol = Lane::broadcast(tolerance);
+		std::size_t total = 0;
+		for(std::size_t i = 0, N = Simd::padded(q.size()); i < N;
+				i += Lane::N) {
+			auto w = Lane::load(&q.w[i]), x = Lane::load(&q.x[i]),
+				 y = Lane::load(&q.y[i]), z = Lane::load(&q.z[i]),
+				 m2 = w*w + x*x + y*y + z*z, d = m2 - one,
+				 off = (tol < max(d, -d)) & (zero < m2);
+			auto mask = bits(off);
+			if(!mask) continue;
+			total += count(mask);
+			auto inv = select(off, inverse_root(m2), one);
+			(w*inv).store(&q.w[i]);
+			(x*inv).store(&q.x[i]);
+			(y*inv).store(&q.y[i]);
+			(z*inv).store(&q.z[i]);
+		}
+		return total;
+	}
+	std::size_t renormalize(DualQuatBatch &dq, float tolerance) {
+		auto zero = Lane::broadcast(0), one = Lane::broadcast(1),
+			 tol = Lane::broadcast(tolerance);
+		auto &u = dq.u, &v = dq.v;
+		std::size_t total = 0;
+		for(std::size_t i = 0, N = Simd::padded(dq.size()); i < N;
+				i += Lane::N) {
+			auto uw = Lane::load(&u.w[i]), ux = Lane::load(&u.x[i]),
+				 uy = Lane::load(&u.y[i]), uz = Lane::load(&u.z[i]),
+				 vw = Lane::load(&v.w[i]), vx = Lane::load(&v.x[i]),
+				 vy = Lane::load(&v.y[i]), vz = Lane::load(&v.z[i]),
+				 m2 = uw*uw + ux*ux + uy*uy + uz*uz, d = m2 - one,
+				 e = uw*vw + ux*vx + uy*vy + uz*vz,
+				 off = (tol < max(max(d, -d), max(e, -e))) & (zero < m2);
+			auto mask = bits(off);
+			if(!mask) continue;
+			total += count(mask);
+			// u/|u| and v/|u|, less the part of the latter along the former
+			auto inv = select(off, inverse_root(m2), one),
+				 k = select(off, e * inv * inv, zero);
+			uw = uw * inv; ux = ux * inv; uy = uy * inv; uz = uz * inv;
+			(vw*inv - k*uw).store(&v.w[i]);
+			(vx*inv - k*ux).store(&v.x[i]);
+			(vy*inv - k*uy).store(&v.y[i]);
+			(vz*inv - k*uz).store(&v.z[i]);
+			uw.store(&u.w[i]); ux.store(&u.x[i]);
+			uy.store(&u.y[i]); uz.store(&u.z[i]);
+		}
+		return total;
+	}
+	std::size_t renormalize(Quat_t<float> *q, std::size_t n,
+			float tolerance) {
+		std::size_t total = 0;
+		for(std::size_t i = 0; i < n; i++) {
+			float m2 = q[i].magnitude2();
+			if(!(std::abs(m2 - 1) > tolerance && m2 > 0)) continue;
+			float inv = 1 / std::sqrt(m2);
+			q[i] = {q[i].w*inv, q[i].x*inv, q[i].y*inv, q[i].z*inv};
+			total++;
+		}
+		return total;
+	}
+	std::size_t renormalize(DualQuat_t<float> *dq, std::size_t n,
+			float tolerance) {
+		std::size_t total = 0;
+		for(std::size_t i = 0; i < n; i++) {
+			auto &u = dq[i].u, &v = dq[i].v;
+			float m2 = u.magnitude2(), e = dot(u, v);
+			if(!((std::abs(m2 - 1) > tolerance || std::abs(e) > tolerance)
+					&& m2 > 0))
+				continue;
+			float inv = 1 / std::sqrt(m2), k = e * inv * inv;
+			u = {u.w*inv, u.x*inv, u.y*inv, u.z*inv};
+			v = {v.w*inv - k*u.w, v.x*inv - k*u.x,
+				v.y*inv - k*u.y, v.z*inv - k*u.z};
+			total++;
+		}
+		return total;
+	}
+
+	/* Rotation by the unit quaternion (w, u): t = 2 u x v, then
+	 * v + w t + u x t; 18 products against the 24 of sandwich(). */
+	void rotate(QuatBatch const& q, VecBatch const& v, VecBatch& dest) {
+		auto n = std::min(q.size(), v.size());
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto vx = Lane::load(&v.x[i]), vy = Lane::load(&v.y[i]),
+				 vz = Lane::load(&v.z[i]);
+			rotate(Lane::load(&q.w[i]), Lane::load(&q.x[i]),
+				Lane::load(&q.y[i]), Lane::load(&q.z[i]), vx, vy, vz);
+			vx.store(&dest.x[i]);
+			vy.store(&dest.y[i]);
+			vz.store(&dest.z[i]);
+		}
+		for(auto *a : {&dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+
+	void rotate(Quat_t<float> const& q, VecBatch const& v, VecBatch& dest) {
+		auto n = v.size();
+		dest.resize(n);
+		auto qw = Lane::broadcast(q.w), qx = Lane::broadcast(q.x),
+			 qy = Lane::broadcast(q.y), qz = Lane::broadcast(q.z);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto vx = Lane::load(&v.x[i]), vy = Lane::load(&v.y[i]),
+				 vz = Lane::load(&v.z[i]);
+			rotate(qw, qx, qy, qz, vx, vy, vz);
+			vx.store(&dest.x[i]);
+			vy.store(&dest.y[i]);
+			vz.store(&dest.z[i]);
+		}
+		for(auto *a : {&dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+
+	void transform(QuatBatch const& u, QuatBatch const& v,
+			VecBatch const& p, VecBatch& dest) {
+		auto n = std::min(std::min(u.size(), v.size()), p.size());
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto px = Lane::load(&p.x[i]), py = Lane::load(&p.y[i]),
+				 pz = Lane::load(&p.z[i]);
+			transform(Lane::load(&u.w[i]), Lane::load(&u.x[i]),
+				Lane::load(&u.y[i]), Lane::load(&u.z[i]),
+				Lane::load(&v.w[i]), Lane::load(&v.x[i]),
+				Lane::load(&v.y[i]), Lane::load(&v.z[i]), px, py, pz);
+			px.store(&dest.x[i]);
+			py.store(&dest.y[i]);
+			pz.store(&dest.z[i]);
+		}
+		for(auto *a : {&dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+
+	void transform(DualQuat_t<float> const& dq,
+			VecBatch const& p, VecBatch& dest) {
+		auto n = p.size();
+		dest.resize(n);
+		auto uw = Lane::broadcast(dq.u.w), ux = Lane::broadcast(dq.u.x),
+			 uy = Lane::broadcast(dq.u.y), uz = Lane::broadcast(dq.u.z),
+			 vw = Lane::broadcast(dq.v.w), vx = Lane::broadcast(dq.v.x),
+			 vy = Lane::broadcast(dq.v.y), vz = Lane::broadcast(dq.v.z);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto px = Lane::load(&p.x[i]), py = Lane::load(&p.y[i]),
+				 pz = Lane::load(&p.z[i]);
+			transform(uw, ux, uy, uz, vw, vx, vy, vz, px, py, pz);
+			px.store(&dest.x[i]);
+			py.store(&dest.y[i]);
+			pz.store(&dest.z[i]);
+		}
+		for(auto *a : {&dest.x, &dest.y, &dest.z}) clear(*a, n);
+	}
+}
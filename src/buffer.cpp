@@ -0,0 +1,164 @@
+/*! @file src/buffer.cpp
+ *  @brief Implementation of the streaming buffers from buffer.hpp */
+
+#include "buffer.hpp"
+#include "state.hpp"
+
+///@cond
+#include <cstring>
+///@endcond
+
+namespace View {
+	using namespace gl;
+
+	constexpr unsigned StreamBuffer::frames;
+
+	bool supports(GLint major, GLint minor, const char *extension) {
+		GLint ma = 0, mi = 0, n = 0;
+		glGetIntegerv(GL_MAJOR_VERSION, &ma);
+		glGetIntegerv(GL_MINOR_VERSION, &mi);
+		if(ma > major || (ma == major && mi >= minor)) return true;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+		for(GLint i = 0; i < n; i++) {
+			auto name = reinterpret_cast<const char*>(
+					glGetStringi(GL_EXTENSIONS, i));
+			if(name && !strcmp(name, extension)) return true;
+		}
+		return false;
+	}
+
+	void StreamBuffer::create(void) {
+		if(m_vbo) return;
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_vbo);
+		State::current().buffer(GL_ARRAY_BUFFER, m_vbo);
+		// Persistent mapping needs glBufferStorage, core since GL 4.4
+		bool immutable = supports(4, 4, "GL_ARB_buffer_storage");
+		if(immutable) {
+			auto flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+				| GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_ARRAY_BUFFER, m_capacity, nullptr, flags);
+			m_map = static_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER,
+					0, m_capacity, flags));
+			m_persistent = m_map != nullptr;
+		}
+		// Without storage, or if the mapping failed, map per slice instead
+		if(!m_persistent) {
+			// Immutable storage cannot be respecified, only replaced
+			if(immutable) {
+				State::current().forget_buffer(m_vbo);
+				glDeleteBuffers(1, &m_vbo);
+				glGenBuffers(1, &m_vbo);
+				State::current().buffer(GL_ARRAY_BUFFER, m_vbo);
+			}
+			glBufferData(GL_ARRAY_BUFFER, m_capacity, nullptr,
+					GL_STREAM_DRAW);
+		}
+	}
+
+	GLuint StreamBuffer::vao(void) { return create(), m_vao; }
+	GLuint StreamBuffer::vbo(void) { return create(), m_vbo; }
+	bool StreamBuffer::persistent(void) { return create(), m_persistent; }
+	GLsizeiptr StreamBuffer::region(void) const {
+		return m_capacity / frames;
+	}
+
+	void StreamBuffer::attribute(GLuint index, GLint size, GLenum type,
+			GLsizei stride, GLsizeiptr offset) {
+		create();
+		State::current().vao(m_vao);
+		State::current().buffer(GL_ARRAY_BUFFER, m_vbo);
+		glEnableVertexAttribArray(index);
+		glVertexAttribPointer(index, size, type, GL_FALSE, stride,
+				reinterpret_cast<const void*>(offset));
+	}
+
+	void StreamBuffer::elements(GLuint const *indices, GLsizeiptr count) {
+		create();
+		State::current().vao(m_vao);
+		// The element buffer binding is part of the vertex array
+		if(!m_ibo) glGenBuffers(1, &m_ibo);
+		State::current().buffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint),
+				indices, GL_STATIC_DRAW);
+	}
+
+	StreamBuffer::Slice StreamBuffer::allocate(GLsizeiptr count,
+			GLsizei stride) {
+		Slice slice;
+		create();
+		if(count <= 0 || stride <= 0) return slice;
+		if(!m_waited) {
+			// The region was last written frames ago; wait until it is read
+			if(auto &sync = m_fences[m_frame]) {
+				GLenum status;
+				do status = glClientWaitSync(sync,
+						GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+				while(status == GL_TIMEOUT_EXPIRED);
+				glDeleteSync(sync);
+				sync = nullptr;
+			}
+			m_waited = true;
+		}
+		GLsizeiptr base = m_frame * region(),
+			first = (base + m_head + stride - 1) / stride,
+			offset = first * stride, size = count * stride;
+		if(offset + size > base + region()) return slice;
+		if(m_persistent) {
+			slice.data = m_map + offset;
+		} else {
+			State::current().buffer(GL_ARRAY_BUFFER, m_vbo);
+			slice.data = glMapBufferRange(GL_ARRAY_BUFFER, offset, size,
+				GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+				| GL_MAP_INVALIDATE_RANGE_BIT);
+			if(!slice.data) return slice;
+		}
+		m_head = offset + size - base;
+		slice.offset = offset;
+		slice.size = size;
+		slice.first = GLint(first);
+		return slice;
+	}
+
+	bool StreamBuffer::commit(Slice &slice) {
+		if(!slice) return false;
+		slice.data = nullptr;
+		if(m_persistent) return true;
+		State::current().buffer(GL_ARRAY_BUFFER, m_vbo);
+		return glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+	}
+
+	void StreamBuffer::fence(void) {
+		if(m_head)
+			m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,
+					GL_NONE_BIT);
+		m_frame = (m_frame + 1) % frames;
+		m_head = 0;
+		m_waited = false;
+	}
+
+	StreamBuffer::StreamBuffer(GLsizeiptr capacity):
+		m_capacity(capacity) {}
+
+	StreamBuffer::~StreamBuffer(void) {
+		for(auto &sync : m_fences)
+			if(sync) glDeleteSync(sync);
+		if(m_persistent) {
+			State::current().buffer(GL_ARRAY_BUFFER, m_vbo);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+		}
+		auto &state = State::current();
+		if(m_ibo) {
+			state.forget_buffer(m_ibo);
+			glDeleteBuffers(1, &m_ibo);
+		}
+		if(m_vbo) {
+			state.forget_buffer(m_vbo);
+			glDeleteBuffers(1, &m_vbo);
+		}
+		if(m_vao) {
+			state.forget_vao(m_vao);
+			glDeleteVertexArrays(1, &m_vao);
+		}
+	}
+}
@@ -0,0 +1,345 @@
+/*! @file src/bvh.cpp
+ *  @brief Construction and traversal of the hierarchy from bvh.hpp */
+
+#include "bvh.hpp"
+#include "simd.hpp"
+
+///@cond
+#include <algorithm>
+#include <cmath>
+///@endcond
+
+namespace Geometry {
+	using Simd::Lane;
+
+	constexpr unsigned Bvh::none;
+
+	static constexpr float inf = std::numeric_limits<float>::infinity();
+	/* Centroids are binned per axis; leaves of up to leaf triangles are
+	 * always accepted, and leaves over cap are split even at a loss. */
+	static constexpr unsigned bins = 16, leaf = 4, cap = 16;
+	/* Past this depth splits fall back to the median, which bounds the
+	 * depth, and so the traversal stack, for any input. */
+	static constexpr unsigned deep = 48, stack = 128;
+
+	static inline Vec_t<float> lower(Vec_t<float> const& l,
+			Vec_t<float> const& r) {
+		return {std::min(l.x, r.x), std::min(l.y, r.y), std::min(l.z, r.z)};
+	}
+	static inline Vec_t<float> upper(Vec_t<float> const& l,
+			Vec_t<float> const& r) {
+		return {std::max(l.x, r.x), std::max(l.y, r.y), std::max(l.z, r.z)};
+	}
+	/* Half the surface area, which is all the heuristic compares. */
+	static inline float area(Vec_t<float> const& lo, Vec_t<float> const& hi) {
+		float x = hi.x - lo.x, y = hi.y - lo.y, z = hi.z - lo.z;
+		return x < 0 ? 0 : x*y + y*z + z*x;
+	}
+	static inline float axis(Vec_t<float> const& v, unsigned a) {
+		return a == 0 ? v.x : a == 1 ? v.y : v.z;
+	}
+
+	Ray unproject(Matrix_t<float> const& m, float x, float y) {
+		bool finite = true;
+		auto at = [&] (float z) -> Vec_t<float> {
+			float p[4];
+			for(unsigned j = 0; j < 4; j++)
+				p[j] = x*m[j] + y*m[4+j] + z*m[8+j] + m[12+j];
+			// Points at or near infinity, or NaN, cannot be divided out
+			float size = std::max(std::max(std::abs(p[0]), std::abs(p[1])),
+					std::abs(p[2]));
+			if(!(std::abs(p[3]) > 1e-6f * size)) {
+				finite = false;
+				return {};
+			}
+			return {p[0]/p[3], p[1]/p[3], p[2]/p[3]};
+		};
+		Vec_t<float> near = at(-1), far = at(1);
+		// A ray without direction fails every triangle's determinant test
+		if(!finite) return {};
+		return {near, {far.x - near.x, far.y - near.y, far.z - near.z}};
+	}
+
+	Bvh::Bvh(Vec_t<float> const *vertices, std::size_t n) {
+		build(vertices, n);
+	}
+
+	std::size_t Bvh::size(void) const {
+		return m_order.size();
+	}
+
+	void Bvh::build(Vec_t<float> const *v, std::size_t n) {
+		std::vector<Vec_t<float>> c(n), lo(n), hi(n);
+		m_order.resize(n);
+		for(std::size_t i = 0; i < n; i++) {
+			auto const *t = v + 3*i;
+			lo[i] = lower(t[0], lower(t[1], t[2]));
+			hi[i] = upper(t[0], upper(t[1], t[2]));
+			c[i] = {(lo[i].x + hi[i].x) / 2, (lo[i].y + hi[i].y) / 2,
+				(lo[i].z + hi[i].z) / 2};
+			m_order[i] = unsigned(i);
+		}
+		m_nodes.clear();
+		m_nodes.reserve(2 * (n / leaf + 1));
+		if(n)
+			split(m_order, c.data(), lo.data(), hi.data(), 0, unsigned(n), 0);
+		refit(v);
+	}
+
+	unsigned Bvh::split(std::vector<unsigned> &order, Vec_t<float> const *c,
+			Vec_t<float> const *lo, Vec_t<float> const *hi,
+			unsigned begin, unsigned end, unsigned depth) {
+		struct Bin {
+			Vec_t<float> lo = {inf, inf, inf}, hi = {-inf, -inf, -inf};
+			unsigned n = 0;
+		};
+		auto index = unsigned(m_nodes.size()), count = end - begin;
+		m_nodes.push_back({{}, {}, begin, count});
+		if(count <= leaf) return index;
+
+		Vec_t<float> blo = {inf, inf, inf}, bhi = {-inf, -inf, -inf},
+			clo = blo, chi = bhi;
+		for(auto i = begin; i < end; i++) {
+			auto t = order[i];
+			blo = lower(blo, lo[t]); bhi = upper(bhi, hi[t]);
+			clo = lower(clo, c[t]); chi = upper(chi, c[t]);
+		}
+
+		float best = inf, scale = 0, origin = 0;
+		unsigned best_axis = 3, cut = 0;
+		for(unsigned a = 0; a < 3 && depth < deep; a++) {
+			float c0 = axis(clo, a), ext = axis(chi, a) - c0;
+			if(!(ext > 0)) continue;
+			float k = bins * (1 - 1e-6f) / ext;
+			Bin b[bins];
+			for(auto i = begin; i < end; i++) {
+				auto t = order[i];
+				auto &bin = b[unsigned((axis(c[t], a) - c0) * k)];
+				bin.lo = lower(bin.lo, lo[t]); bin.hi = upper(bin.hi, hi[t]);
+				bin.n++;
+			}
+			// Sweep the right sides, then the left sides against them
+			float right[bins];
+			Bin acc;
+			for(unsigned j = bins; --j > 0;) {
+				acc.lo = lower(acc.lo, b[j].lo); acc.hi = upper(acc.hi, b[j].hi);
+				acc.n += b[j].n;
+				right[j] = acc.n * area(acc.lo, acc.hi);
+			}
+			acc = Bin{};
+			for(unsigned j = 1; j < bins; j++) {
+				acc.lo = lower(acc.lo, b[j-1].lo);
+				acc.hi = upper(acc.hi, b[j-1].hi);
+				acc.n += b[j-1].n;
+				float cost = acc.n * area(acc.lo, acc.hi) + right[j];
+				if(acc.n && acc.n < count && cost < best)
+					best = cost, best_axis = a, cut = j, scale = k, origin = c0;
+			}
+		}
+
+		unsigned mid = begin + count / 2;
+		if(best_axis < 3) {
+			// One traversal step against intersecting every triangle here
+			float whole = area(blo, bhi);
+			if(count <= cap && whole + best >= count * whole)
+				return index;
+			auto a = best_axis;
+			mid = unsigned(std::partition(order.begin() + begin,
+				order.begin() + end, [=] (unsigned t) {
+					return unsigned((axis(c[t], a) - origin) * scale) < cut;
+				}) - order.begin());
+		} else if(count <= cap && depth < deep) {
+			// Coincident centroids cannot be told apart by any split
+			return index;
+		}
+		m_nodes[index].count = 0;
+		split(order, c, lo, hi, begin, mid, depth + 1);
+		auto right = split(order, c, lo, hi, mid, end, depth + 1);
+		m_nodes[index].start = right;
+		return index;
+	}
+
+	void Bvh::refit(Vec_t<float> const *v) {
+		auto n = m_order.size();
+		m_triangles.resize(n);
+		for(std::size_t k = 0; k < n; k++) {
+			auto const *t = v + 3*m_order[k];
+			m_triangles[k] = {t[0],
+				{t[1].x - t[0].x, t[1].y - t[0].y, t[1].z - t[0].z},
+				{t[2].x - t[0].x, t[2].y - t[0].y, t[2].z - t[0].z}};
+		}
+		// Children follow their parents, so one backward pass suffices
+		for(auto i = m_nodes.size(); i--;) {
+			auto &node = m_nodes[i];
+			if(node.count) {
+				node.lo = {inf, inf, inf};
+				node.hi = {-inf, -inf, -inf};
+				for(auto k = node.start; k < node.start + node.count; k++) {
+					auto const *t = v + 3*m_order[k];
+					node.lo = lower(node.lo, lower(t[0], lower(t[1], t[2])));
+					node.hi = upper(node.hi, upper(t[0], upper(t[1], t[2])));
+				}
+			} else {
+				auto const &l = m_nodes[i+1], &r = m_nodes[node.start];
+				node.lo = lower(l.lo, r.lo);
+				node.hi = upper(l.hi, r.hi);
+			}
+		}
+	}
+
+	/* The entry parameter of a ray into a box, or inf on a miss. */
+	static inline float entry(Vec_t<float> const& lo, Vec_t<float> const& hi,
+			Vec_t<float> const& o, Vec_t<float> const& inv, float t1) {
+		float x0 = (lo.x - o.x) * inv.x, x1 = (hi.x - o.x) * inv.x,
+			  y0 = (lo.y - o.y) * inv.y, y1 = (hi.y - o.y) * inv.y,
+			  z0 = (lo.z - o.z) * inv.z, z1 = (hi.z - o.z) * inv.z;
+		float t0 = std::max(std::max(std::min(x0, x1), std::min(y0, y1)),
+				std::max(std::min(z0, z1), 0.f));
+		t1 = std::min(std::min(std::max(x0, x1), std::max(y0, y1)),
+				std::min(std::max(z0, z1), t1));
+		return t0 <= t1 ? t0 : inf;
+	}
+
+	Hit Bvh::intersect(Ray const& ray) const {
+		Hit hit;
+		if(m_nodes.empty()) return hit;
+		auto const &o = ray.origin, &d = ray.direction;
+		Vec_t<float> inv = {1 / d.x, 1 / d.y, 1 / d.z};
+		struct Entry { unsigned node; float t; } todo[stack];
+		unsigned top = 0;
+		float t0 = entry(m_nodes[0].lo, m_nodes[0].hi, o, inv, inf);
+		if(t0 < inf) todo[top++] = {0, t0};
+		while(top) {
+			auto e = todo[--top];
+			if(!(e.t < hit.t)) continue;
+			auto const &node = m_nodes[e.node];
+			if(!node.count) {
+				unsigned l = e.node + 1, r = node.start;
+				float tl = entry(m_nodes[l].lo, m_nodes[l].hi, o, inv, hit.t),
+					  tr = entry(m_nodes[r].lo, m_nodes[r].hi, o, inv, hit.t);
+				// The nearer child is popped first
+				if(tl > tr) std::swap(l, r), std::swap(tl, tr);
+				if(tr < inf) todo[top++] = {r, tr};
+				if(tl < inf) todo[top++] = {l, tl};
+				continue;
+			}
+			// Moller-Trumbore
+			for(auto k = node.start; k < node.start + node.count; k++) {
+				auto const &tri = m_triangles[k];
+				auto const &e1 = tri.e1, &e2 = tri.e2;
+				float px = d.y*e2.z - d.z*e2.y, py = d.z*e2.x - d.x*e2.z,
+					  pz = d.x*e2.y - d.y*e2.x,
+					  det = e1.x*px + e1.y*py + e1.z*pz;
+				if(std::abs(det) < 1e-12f) continue;
+				float f = 1 / det, sx = o.x - tri.v0.x, sy = o.y - tri.v0.y,
+					  sz = o.z - tri.v0.z, u = (sx*px + sy*py + sz*pz) * f;
+				if(u < 0 || u > 1) continue;
+				float qx = sy*e1.z - sz*e1.y, qy = sz*e1.x - sx*e1.z,
+					  qz = sx*e1.y - sy*e1.x,
+					  v = (d.x*qx + d.y*qy + d.z*qz) * f;
+				if(v < 0 || u + v > 1) continue;
+				float t = (e2.x*qx + e2.y*qy + e2.z*qz) * f;
+				if(t >= 0 && t < hit.t) hit = {k, t, u, v};
+			}
+		}
+		if(hit) hit.triangle = m_order[hit.triangle];
+		return hit;
+	}
+
+	void Bvh::intersect(Ray const *rays, Hit *hits, std::size_t n) const {
+		auto zero = Lane::broadcast(0), one = Lane::broadcast(1),
+			 eps = Lane::broadcast(1e-12f);
+		for(std::size_t i = 0; i < n; i += Lane::N) {
+			auto len = std::min<std::size_t>(Lane::N, n - i);
+			// The tail repeats the first ray, whose results are dropped
+			alignas(SIMD_ALIGN) float in[9][Lane::N];
+			for(unsigned j = 0; j < Lane::N; j++) {
+				auto const &r = rays[i + (j < len ? j : 0)];
+				float c[9] = {r.origin.x, r.origin.y, r.origin.z,
+					r.direction.x, r.direction.y, r.direction.z,
+					1 / r.direction.x, 1 / r.direction.y, 1 / r.direction.z};
+				for(unsigned k = 0; k < 9; k++) in[k][j] = c[k];
+			}
+			Lane ox = Lane::load(in[0]), oy = Lane::load(in[1]),
+				 oz = Lane::load(in[2]), dx = Lane::load(in[3]),
+				 dy = Lane::load(in[4]), dz = Lane::load(in[5]),
+				 ix = Lane::load(in[6]), iy = Lane::load(in[7]),
+				 iz = Lane::load(in[8]), best = Lane::broadcast(inf),
+				 bu = zero, bv = zero;
+			unsigned id[Lane::N];
+			std::fill(id, id + Lane::N, none);
+			// Children are ordered along the first ray, as they share a side
+			auto const &d0 = rays[i].direction;
+
+			unsigned todo[stack], top = 0;
+			if(!m_nodes.empty()) todo[top++] = 0;
+			while(top) {
+				auto index = todo[--top];
+				auto const &node = m_nodes[index];
+				auto x0 = (Lane::broadcast(node.lo.x) - ox) * ix,
+					 x1 = (Lane::broadcast(node.hi.x) - ox) * ix,
+					 y0 = (Lane::broadcast(node.lo.y) - oy) * iy,
+					 y1 = (Lane::broadcast(node.hi.y) - oy) * iy,
+					 z0 = (Lane::broadcast(node.lo.z) - oz) * iz,
+					 z1 = (Lane::broadcast(node.hi.z) - oz) * iz;
+				auto t0 = max(max(min(x0, x1), min(y0, y1)),
+						max(min(z0, z1), zero)),
+					 t1 = min(min(max(x0, x1), max(y0, y1)),
+						min(max(z0, z1), best));
+				if(!bits(t0 <= t1)) continue;
+				if(!node.count) {
+					unsigned l = index + 1, r = node.start;
+					auto const &a = m_nodes[l], &b = m_nodes[r];
+					float s = (a.lo.x + a.hi.x - b.lo.x - b.hi.x) * d0.x
+						+ (a.lo.y + a.hi.y - b.lo.y - b.hi.y) * d0.y
+						+ (a.lo.z + a.hi.z - b.lo.z - b.hi.z) * d0.z;
+					if(s > 0) std::swap(l, r);
+					todo[top++] = r;
+					todo[top++] = l;
+					continue;
+				}
+				for(auto k = node.start; k < node.start + node.count; k++) {
+					auto const &tri = m_triangles[k];
+					auto e1x = Lane::broadcast(tri.e1.x),
+						 e1y = Lane::broadcast(tri.e1.y),
+						 e1z = Lane::broadcast(tri.e1.z),
+						 e2x = Lane::broadcast(tri.e2.x),
+						 e2y = Lane::broadcast(tri.e2.y),
+						 e2z = Lane::broadcast(tri.e2.z);
+					auto px = dy*e2z - dz*e2y, py = dz*e2x - dx*e2z,
+						 pz = dx*e2y - dy*e2x,
+						 det = e1x*px + e1y*py + e1z*pz,
+						 f = one / det,
+						 sx = ox - Lane::broadcast(tri.v0.x),
+						 sy = oy - Lane::broadcast(tri.v0.y),
+						 sz = oz - Lane::broadcast(tri.v0.z),
+						 u = (sx*px + sy*py + sz*pz) * f,
+						 qx = sy*e1z - sz*e1y, qy = sz*e1x - sx*e1z,
+						 qz = sx*e1y - sy*e1x,
+						 v = (dx*qx + dy*qy + dz*qz) * f,
+						 t = (e2x*qx + e2y*qy + e2z*qz) * f;
+					// Comparisons with the NaN of a parallel ray all fail
+					auto ok = (eps < max(det, -det)) & (zero <= u)
+						& (zero <= v) & (u + v <= one)
+						& (zero <= t) & (t < best);
+					auto m = bits(ok);
+					if(!m) continue;
+					best = select(ok, t, best);
+					bu = select(ok, u, bu);
+					bv = select(ok, v, bv);
+					for(unsigned j = 0; j < Lane::N; j++)
+						if(m >> j & 1) id[j] = k;
+				}
+			}
+
+			alignas(SIMD_ALIGN) float out[3][Lane::N];
+			best.store(out[0]); bu.store(out[1]); bv.store(out[2]);
+			for(unsigned j = 0; j < len; j++) {
+				Hit hit;
+				if(id[j] != none)
+					hit = {m_order[id[j]], out[0][j], out[1][j], out[2][j]};
+				hits[i + j] = hit;
+			}
+		}
+	}
+}
@@ -0,0 +1,227 @@
+/*! @file src/capture.cpp
+ *  @brief Implementation of the frame capture from capture.hpp */
+
+#include "capture.hpp"
+
+///@cond
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+///@endcond
+
+namespace Streams {
+	using std::uint32_t;
+
+	static const char signature[] = "RGBACAP1";
+	/* Equal bytes that end a literal run; shorter gaps cost less inline. */
+	static constexpr std::size_t gap = 8;
+
+	static void put(std::vector<unsigned char> &dest, uint32_t word) {
+		auto bytes = reinterpret_cast<unsigned char const*>(&word);
+		dest.insert(dest.end(), bytes, bytes + sizeof word);
+	}
+
+	Capture::operator bool(void) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_good && !m_closed;
+	}
+	unsigned Capture::written(void) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_written;
+	}
+	unsigned Capture::dropped(void) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_dropped;
+	}
+	std::size_t Capture::backlog(void) const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_queue.size();
+	}
+
+	bool Capture::push(unsigned char const *rgba, unsigned w, unsigned h,
+			unsigned frame) {
+		std::vector<unsigned char> buffer;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if(m_closed || !m_good) return m_dropped++, false;
+			if(m_queue.size() >= m_depth) {
+				switch(m_policy) {
+					case Policy::block:
+						m_space.wait(lock, [this] {
+							return m_queue.size() < m_depth || m_closed;
+						});
+						if(m_closed) return m_dropped++, false;
+						break;
+					case Policy::drop_newest:
+						return m_dropped++, false;
+					case Policy::drop_oldest:
+						m_free.push_back(std::move(m_queue.front().rgba));
+						m_queue.pop_front();
+						m_dropped++;
+						break;
+				}
+			}
+			if(m_free.size()) {
+				buffer = std::move(m_free.back());
+				m_free.pop_back();
+			}
+		}
+		// Only this thread pushes, so the copy can run unlocked
+		buffer.assign(rgba, rgba + std::size_t(w) * h * 4);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.push_back({std::move(buffer), w, h, frame});
+		}
+		m_ready.notify_one();
+		return true;
+	}
+
+	bool Capture::write_ppm(Frame const& f) {
+		char number[16];
+		std::snprintf(number, sizeof number, "%06u", f.frame);
+		std::ofstream out(m_path + number + ".ppm", std::ios::binary);
+		out << "P6\n" << f.width << ' ' << f.height << "\n255\n";
+		std::vector<char> row(std::size_t(f.width) * 3);
+		// PPM rows run top to bottom, the frame's bottom to top
+		for(auto y = f.height; y-- > 0;) {
+			auto src = &f.rgba[std::size_t(y) * f.width * 4];
+			for(unsigned x = 0; x < f.width; x++)
+				std::memcpy(&row[x * 3], src + x * 4, 3);
+			out.write(row.data(), row.size());
+		}
+		return bool(out);
+	}
+
+	bool Capture::write(Frame const& f) {
+		if(m_format == Format::ppm) return write_ppm(f);
+		auto n = f.rgba.size();
+		auto cur = f.rgba.data();
+		bool key = m_keys <= 1 || !m_since_key
+			|| f.width != m_prev_w || f.height != m_prev_h;
+		m_encoded.clear();
+		if(!key) {
+			auto prev = m_previous.data();
+			for(std::size_t i = 0; i < n;) {
+				auto start = i;
+				while(i < n && cur[i] == prev[i]) i++;
+				auto skip = i - start, literal = i, end = i;
+				for(std::size_t same = 0; i < n; i++) {
+					if(cur[i] != prev[i]) same = 0, end = i + 1;
+					else if(++same == gap) break;
+				}
+				i = end;
+				put(m_encoded, uint32_t(skip));
+				put(m_encoded, uint32_t(end - literal));
+				for(auto j = literal; j < end; j++)
+					m_encoded.push_back(cur[j] ^ prev[j]);
+			}
+		}
+		uint32_t header[] = {f.frame, f.width, f.height, key ? 0u : 1u,
+			uint32_t(key ? n : m_encoded.size())};
+		m_out.write(reinterpret_cast<const char*>(header), sizeof header);
+		if(key) m_out.write(reinterpret_cast<const char*>(cur), n);
+		else m_out.write(reinterpret_cast<const char*>(m_encoded.data()),
+				m_encoded.size());
+		if(m_keys > 1) {
+			m_previous.assign(cur, cur + n);
+			m_prev_w = f.width;
+			m_prev_h = f.height;
+			m_since_key = (m_since_key + 1) % m_keys;
+		}
+		return bool(m_out);
+	}
+
+	void Capture::run(void) {
+		for(;;) {
+			Frame f;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_ready.wait(lock, [this] {
+					return m_queue.size() || m_closed;
+				});
+				if(m_queue.empty()) break;
+				f = std::move(m_queue.front());
+				m_queue.pop_front();
+			}
+			m_space.notify_one();
+			bool good = write(f);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_free.push_back(std::move(f.rgba));
+			if(good) m_written++;
+			else m_good = false;
+		}
+		if(m_out.is_open()) m_out.flush();
+	}
+
+	void Capture::close(void) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_closed = true;
+		}
+		m_ready.notify_all();
+		m_space.notify_all();
+		if(m_writer.joinable()) m_writer.join();
+	}
+
+	Capture::Capture(std::string const& path, Format format, Policy policy,
+			std::size_t depth, unsigned keys):
+			m_path(path), m_format(format), m_policy(policy),
+			m_depth(std::max<std::size_t>(depth, 1)), m_keys(keys) {
+		if(format == Format::raw) {
+			m_out.open(path, std::ios::binary);
+			m_out.write(signature, sizeof signature - 1);
+			m_good = bool(m_out);
+		}
+		if(m_good) m_writer = std::thread(&Capture::run, this);
+	}
+
+	Capture::~Capture(void) { close(); }
+
+	CaptureReader::operator bool(void) const { return m_good; }
+
+	bool CaptureReader::next(std::vector<unsigned char> &rgba, unsigned &w,
+			unsigned &h, unsigned &frame) {
+		uint32_t header[5];
+		if(!m_good || !m_in.read(reinterpret_cast<char*>(header),
+				sizeof header))
+			return m_good = false;
+		auto n = std::size_t(header[1]) * header[2] * 4;
+		m_payload.resize(header[4]);
+		if(!m_in.read(reinterpret_cast<char*>(m_payload.data()), header[4]))
+			return m_good = false;
+		if(!header[3]) {
+			if(header[4] != n) return m_good = false;
+			m_previous = m_payload;
+		} else {
+			if(m_previous.size() != n) return m_good = false;
+			std::size_t pos = 0, at = 0;
+			auto word = [&] (uint32_t &dest) {
+				if(at + sizeof dest > m_payload.size()) return false;
+				std::memcpy(&dest, &m_payload[at], sizeof dest);
+				at += sizeof dest;
+				return true;
+			};
+			uint32_t skip, count;
+			while(at < m_payload.size()) {
+				if(!word(skip) || !word(count)) return m_good = false;
+				pos += skip;
+				if(pos + count > n || at + count > m_payload.size())
+					return m_good = false;
+				for(uint32_t i = 0; i < count; i++)
+					m_previous[pos++] ^= m_payload[at++];
+			}
+		}
+		rgba = m_previous;
+		frame = header[0];
+		w = header[1];
+		h = header[2];
+		return true;
+	}
+
+	CaptureReader::CaptureReader(std::string const& path):
+			m_in(path, std::ios::binary) {
+		char head[sizeof signature - 1];
+		m_good = m_in.read(head, sizeof head)
+			&& !std::memcmp(head, signature, sizeof head);
+	}
+}
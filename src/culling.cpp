@@ -0,0 +1,126 @@
+/*! @file src/culling.cpp
+ *  @brief Implementation of the frustum and culling kernels */
+
+#include "culling.hpp"
+
+///@cond
+#include <algorithm>
+#include <cmath>
+///@endcond
+
+namespace Geometry {
+	using Simd::Lane;
+
+	/* Gribb and Hartmann: with clip = v*m, the column w of m plus or minus
+	 * the column of x, y or z gives the plane where that coordinate meets
+	 * w; dividing by the length of the normal makes distances true. */
+	Frustum::Frustum(Matrix_t<float> const& m) {
+		for(unsigned i = 0; i < count; i++) {
+			unsigned axis = i / 2;
+			float sign = i % 2 ? -1 : 1, len = 0;
+			for(unsigned j = 0; j < 4; j++) {
+				planes[i][j] = m[j*4 + 3] + sign * m[j*4 + axis];
+				if(j < 3) len += planes[i][j] * planes[i][j];
+			}
+			len = len > 0 ? 1 / std::sqrt(len) : 0;
+			for(auto &p : planes[i]) p *= len;
+		}
+	}
+
+	bool Frustum::visible(Vec_t<float> const& c, float r) const {
+		for(auto const& p : planes)
+			if(p[0]*c.x + p[1]*c.y + p[2]*c.z + p[3] < -r) return false;
+		return true;
+	}
+	bool Frustum::visible(Vec_t<float> const& lo,
+			Vec_t<float> const& hi) const {
+		// The corner furthest along each normal decides
+		for(auto const& p : planes)
+			if(p[0]*(p[0] < 0 ? lo.x : hi.x) + p[1]*(p[1] < 0 ? lo.y : hi.y)
+					+ p[2]*(p[2] < 0 ? lo.z : hi.z) + p[3] < 0)
+				return false;
+		return true;
+	}
+
+	/* The planes broadcast once per call, with the absolute normals the
+	 * box test projects extents onto. */
+	struct Planes {
+		Lane a[Frustum::count], b[Frustum::count], c[Frustum::count],
+			 d[Frustum::count], ma[Frustum::count], mb[Frustum::count],
+			 mc[Frustum::count];
+		Planes(Frustum const& f) {
+			for(unsigned i = 0; i < Frustum::count; i++) {
+				auto const& p = f.planes[i];
+				a[i] = Lane::broadcast(p[0]);
+				b[i] = Lane::broadcast(p[1]);
+				c[i] = Lane::broadcast(p[2]);
+				d[i] = Lane::broadcast(p[3]);
+				ma[i] = Lane::broadcast(std::abs(p[0]));
+				mb[i] = Lane::broadcast(std::abs(p[1]));
+				mc[i] = Lane::broadcast(std::abs(p[2]));
+			}
+		}
+	};
+
+	/* Appends the lanes set in mask among the n real elements. Every lane
+	 * is written and the count advanced only past the set ones, so there
+	 * is no branch on the mask; the writes stay in bounds since k <= i+j. */
+	static inline std::size_t compact(unsigned mask, std::size_t i,
+			std::size_t n, unsigned *visible, std::size_t k) {
+		auto len = std::min<std::size_t>(Lane::N, n - i);
+		for(unsigned j = 0; j < len; j++) {
+			visible[k] = unsigned(i + j);
+			k += mask >> j & 1;
+		}
+		return k;
+	}
+
+	std::size_t cull(Frustum const& f, VecBatch const& centers,
+			Simd::Array const& radii, unsigned *visible) {
+		Planes p(f);
+		auto n = centers.size();
+		std::size_t k = 0;
+		for(std::size_t i = 0; i < n; i += Lane::N) {
+			auto x = Lane::load(&centers.x[i]), y = Lane::load(&centers.y[i]),
+				 z = Lane::load(&centers.z[i]);
+			auto reach = [&] (unsigned j) {
+				return mul_add(p.a[j], x, mul_add(p.b[j], y,
+						mul_add(p.c[j], z, p.d[j])));
+			};
+			// The least signed distance of the center over the planes
+			auto d = reach(0);
+			for(unsigned j = 1; j < Frustum::count; j++)
+				d = min(d, reach(j));
+			k = compact(bits(d >= -Lane::load(&radii[i])), i, n, visible, k);
+		}
+		return k;
+	}
+
+	/* Center and half-extent form: the box reaches the inner side of a
+	 * plane when n.c + d >= -|n|.e, which needs no per-plane corner. */
+	std::size_t cull(Frustum const& f, VecBatch const& lo,
+			VecBatch const& hi, unsigned *visible) {
+		Planes p(f);
+		auto n = std::min(lo.size(), hi.size());
+		auto half = Lane::broadcast(.5f);
+		std::size_t k = 0;
+		for(std::size_t i = 0; i < n; i += Lane::N) {
+			auto lx = Lane::load(&lo.x[i]), ly = Lane::load(&lo.y[i]),
+				 lz = Lane::load(&lo.z[i]), hx = Lane::load(&hi.x[i]),
+				 hy = Lane::load(&hi.y[i]), hz = Lane::load(&hi.z[i]),
+				 cx = (lx + hx) * half, cy = (ly + hy) * half,
+				 cz = (lz + hz) * half, ex = (hx - lx) * half,
+				 ey = (hy - ly) * half, ez = (hz - lz) * half;
+			auto reach = [&] (unsigned j) {
+				return mul_add(p.a[j], cx, mul_add(p.b[j], cy,
+						mul_add(p.c[j], cz, p.d[j])))
+					+ mul_add(p.ma[j], ex, mul_add(p.mb[j], ey, p.mc[j] * ez));
+			};
+			auto d = reach(0);
+			for(unsigned j = 1; j < Frustum::count; j++)
+				d = min(d, reach(j));
+			k = compact(bits(d >= Lane::broadcast(0)), i, n, visible, k);
+		}
+		return k;
+	}
+}
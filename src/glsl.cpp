@@ -4,6 +4,10 @@
 #include "glsl.hpp"
 #include "view.hpp"
 
+///@cond
+#include <map>
+///@endcond
+
 namespace View {
 namespace Shaders {
 	GLint queryIv(GLuint id, GLenum k, GLint *pdest) {
@@ -50,6 +54,25 @@ namespace Shaders {
 		return "(no info available)";
 	}
 
+	GLuint blockBinding(std::string const& name) {
+		static std::map<std::string, GLuint> bindings;
+		auto it = bindings.find(name);
+		if(it != bindings.end()) return it -> second;
+		GLuint binding = bindings.size();
+		return bindings[name] = binding;
+	}
+	GLint bindBlocks(GLuint id) {
+		auto n = programIv(id, GL_ACTIVE_UNIFORM_BLOCKS),
+			len = programIv(id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH);
+		if(n <= 0 || len <= 0) return 0;
+		GLchar buf[len];
+		for(GLint i = 0; i < n; i++) {
+			glGetActiveUniformBlockName(id, i, len, 0, buf);
+			glUniformBlockBinding(id, i, blockBinding(buf));
+		}
+		return n;
+	}
+
 	Shader::operator GLuint(void) const {
 		return m_id;
 	}
@@ -84,7 +107,10 @@ namespace Shaders {
 	Shader::~Shader(void) {
 		if(queryAssertIv(m_id, GL_DELETE_STATUS, GLint(GL_TRUE))) return;
 		if(m_isShader) glDeleteShader(m_id);
-		else if(m_isProgram) glDeleteProgram(m_id);
+		else if(m_isProgram) {
+			State::current().forget_program(m_id);
+			glDeleteProgram(m_id);
+		}
 	}
 }
 }
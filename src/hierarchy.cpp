@@ -0,0 +1,122 @@
+/*! @file src/hierarchy.cpp
+ *  @brief Implementation of the transform hierarchy from hierarchy.hpp */
+
+#include "hierarchy.hpp"
+
+///@cond
+#include <algorithm>
+///@endcond
+
+namespace Model {
+	constexpr unsigned Hierarchy::none;
+
+	std::size_t Hierarchy::size(void) const { return m_slot.size(); }
+
+	unsigned Hierarchy::add(DualQuat_t<float> const& local,
+			unsigned parent) {
+		/* Appended slots still precede their children, so the next update
+		 * can sort them depth-first in one pass. */
+		unsigned i = unsigned(m_slot.size());
+		m_slot.push_back(i);
+		m_up.push_back(parent);
+		m_parent.push_back(parent == none ? none : m_slot[parent]);
+		m_end.push_back(i + 1);
+		m_local.push_back(local);
+		m_world.push_back(local);
+		m_dirty.push_back(false);
+		m_stale = true;
+		return i;
+	}
+	unsigned Hierarchy::parent(unsigned i) const { return m_up[i]; }
+	DualQuat_t<float> const& Hierarchy::local(unsigned i) const {
+		return m_local[m_slot[i]];
+	}
+	DualQuat_t<float> const& Hierarchy::world(unsigned i) const {
+		return m_world[m_slot[i]];
+	}
+	void Hierarchy::set(unsigned i, DualQuat_t<float> const& local) {
+		unsigned s = m_slot[i];
+		m_local[s] = local;
+		if(!m_dirty[s]) {
+			m_dirty[s] = true;
+			m_changed.push_back(s);
+		}
+	}
+
+	void Hierarchy::layout(void) {
+		auto n = m_slot.size();
+		// Subtree sizes, children before parents
+		std::vector<unsigned> count(n, 1), to(n), cursor(n);
+		for(auto s = n; s--;)
+			if(m_parent[s] != none) count[m_parent[s]] += count[s];
+		// Each slot takes the next place in its parent's run
+		unsigned next = 0;
+		for(unsigned s = 0; s < n; s++) {
+			auto p = m_parent[s];
+			to[s] = p == none ? next : cursor[p];
+			if(p == none) next += count[s];
+			else cursor[p] += count[s];
+			cursor[s] = to[s] + 1;
+		}
+		std::vector<unsigned> parent(n), end(n);
+		std::vector<DualQuat_t<float>> local(n);
+		for(unsigned s = 0; s < n; s++) {
+			auto p = m_parent[s];
+			parent[to[s]] = p == none ? none : to[p];
+			end[to[s]] = to[s] + count[s];
+			local[to[s]] = m_local[s];
+		}
+		for(auto &s : m_slot) s = to[s];
+		m_parent.swap(parent);
+		m_end.swap(end);
+		m_local.swap(local);
+		m_dirty.assign(n, false);
+		m_changed.clear();
+		for(unsigned s = 0; s < n; s++) {
+			auto p = m_parent[s];
+			if(p == none) m_world[s] = m_local[s];
+			else m_world[s] = m_world[p] * m_local[s];
+		}
+		m_stale = false;
+	}
+
+	bool Hierarchy::update(void) {
+		if(m_stale) {
+			layout();
+			return true;
+		}
+		if(m_changed.empty()) return false;
+		auto n = m_slot.size();
+		if(m_changed.size() > n / 8) {
+			/* Past a fraction of the nodes, sorting costs more than one
+			 * pass that carries the dirty bits down to the children. */
+			for(unsigned s = 0; s < n; s++) {
+				auto p = m_parent[s];
+				if(p == none) {
+					if(m_dirty[s]) m_world[s] = m_local[s];
+				} else if(m_dirty[s] || m_dirty[p]) {
+					m_dirty[s] = true;
+					m_world[s] = m_world[p] * m_local[s];
+				}
+			}
+			m_dirty.assign(n, false);
+			m_changed.clear();
+			return true;
+		}
+		/* In slot order each changed subtree either starts a new run or
+		 * lies inside the last one, which recomputes it anyway. */
+		std::sort(m_changed.begin(), m_changed.end());
+		unsigned done = 0;
+		for(auto s : m_changed) {
+			m_dirty[s] = false;
+			if(s < done) continue;
+			auto p = m_parent[s];
+			if(p == none) m_world[s] = m_local[s];
+			else m_world[s] = m_world[p] * m_local[s];
+			for(done = m_end[s]; ++s < done;)
+				m_world[s] = m_world[m_parent[s]] * m_local[s];
+		}
+		m_changed.clear();
+		return true;
+	}
+}
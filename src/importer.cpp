@@ -0,0 +1,659 @@
+/*! @file src/importer.cpp
+ *  @brief Implementation of the mesh importer from importer.hpp */
+
+#include "importer.hpp"
+#include "mapped.hpp"
+
+///@cond
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+///@endcond
+
+namespace Streams {
+	using std::int64_t;
+	using std::uint32_t;
+	using std::uint64_t;
+	using std::size_t;
+	using std::string;
+	using std::vector;
+
+	/* The powers of ten that a double holds exactly. */
+	static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+		1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+		1e18, 1e19, 1e20, 1e21, 1e22};
+
+	static bool digit(char c) { return unsigned(c - '0') < 10; }
+	static bool blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+	static char const* skip(char const *p, char const *last) {
+		while(p < last && blank(*p)) p++;
+		return p;
+	}
+	static char const* line_end(char const *p, char const *last) {
+		auto nl = static_cast<char const*>(std::memchr(p, '\n', last - p));
+		return nl ? nl : last;
+	}
+
+	char const* parse_float(char const *first, char const *last,
+			float &dest) {
+		auto p = first;
+		bool negative = false, any = false;
+		if(p < last && (*p == '-' || *p == '+')) negative = *p++ == '-';
+		// Up to 19 significant digits fit the mantissa; later ones only
+		// scale it (integer part) or are dropped (fraction)
+		uint64_t mantissa = 0;
+		int exponent = 0, digits = 0;
+		for(; p < last && digit(*p); p++, any = true) {
+			if(digits < 19) {
+				mantissa = mantissa * 10 + unsigned(*p - '0');
+				if(mantissa) digits++;
+			} else exponent++;
+		}
+		if(p < last && *p == '.')
+			for(p++; p < last && digit(*p); p++, any = true) {
+				if(digits < 19) {
+					mantissa = mantissa * 10 + unsigned(*p - '0');
+					if(mantissa) digits++;
+					exponent--;
+				}
+			}
+		if(!any) return first;
+		if(p < last && (*p == 'e' || *p == 'E')) {
+			auto q = p + 1;
+			bool down = false;
+			if(q < last && (*q == '-' || *q == '+')) down = *q++ == '-';
+			if(q < last && digit(*q)) {
+				int e = 0;
+				for(; q < last && digit(*q); q++)
+					if(e < 10000) e = e * 10 + (*q - '0');
+				exponent += down ? -e : e;
+				p = q;
+			}
+		}
+		double value;
+		// Both operands exact, so the one rounding is correct
+		if(!(mantissa >> 53) && exponent >= -22 && exponent <= 22)
+			value = exponent < 0 ? mantissa / powers[-exponent]
+				: mantissa * powers[exponent];
+		else value = double(mantissa * std::pow(10.0L, exponent));
+		dest = float(negative ? -value : value);
+		return p;
+	}
+
+	/* A decimal integer, optionally signed. */
+	static char const* parse_int(char const *first, char const *last,
+			int64_t &dest) {
+		auto p = first;
+		bool negative = false;
+		if(p < last && (*p == '-' || *p == '+')) negative = *p++ == '-';
+		if(p == last || !digit(*p)) return first;
+		int64_t value = 0;
+		for(; p < last && digit(*p); p++)
+			if(value < (int64_t(1) << 40)) value = value * 10 + (*p - '0');
+		dest = negative ? -value : value;
+		return p;
+	}
+
+	/* Splits [first, last) into about n runs of whole lines. */
+	static vector<char const*> split(char const *first, char const *last,
+			size_t n) {
+		vector<char const*> bounds = {first};
+		auto size = size_t(last - first);
+		for(size_t k = 1; k < n; k++) {
+			auto p = std::max(first + size * k / n, bounds.back());
+			p = line_end(p, last);
+			bounds.push_back(p < last ? p + 1 : last);
+		}
+		bounds.push_back(last);
+		return bounds;
+	}
+	/* Enough runs to balance the pool, but no smaller than 64 KiB. */
+	static size_t runs(size_t bytes, Abstract::Pool const& pool) {
+		return std::max<size_t>(1,
+			std::min<size_t>(pool.size() * 4, bytes >> 16));
+	}
+	/* Runs fn(i) for each i in [0, n) on the pool, one at a time each. */
+	template<typename F>
+	static void each(Abstract::Pool &pool, size_t n, F const& fn) {
+		pool.parallel(n, 1, [&] (size_t first, size_t last) {
+			for(auto i = first; i < last; i++) fn(i);
+		});
+	}
+
+	/* Triangulates a polygon as a fan, checking each index. */
+	template<typename T>
+	static bool fan(T const *poly, size_t n, size_t vertices,
+			vector<uint32_t> &dest) {
+		for(size_t k = 0; k < n; k++)
+			if(poly[k] < 0 || poly[k] >= T(vertices)) return false;
+		for(size_t k = 2; k < n; k++) {
+			dest.push_back(uint32_t(poly[0]));
+			dest.push_back(uint32_t(poly[k-1]));
+			dest.push_back(uint32_t(poly[k]));
+		}
+		return true;
+	}
+
+	Importer::operator bool(void) const { return m_valid; }
+	vector<float> const& Importer::vertices(void) const {
+		return m_vertices;
+	}
+	size_t Importer::vertex_count(void) const {
+		return m_vertices.size() / 4;
+	}
+	vector<uint32_t> const& Importer::indices(void) const {
+		return m_indices;
+	}
+	size_t Importer::index_count(void) const { return m_indices.size(); }
+	size_t Importer::read(void) const { return m_read; }
+
+	bool Importer::write(string const& path) const {
+		return m_valid && MeshFile::write(path, m_vertices.data(),
+				uint32_t(vertex_count()), m_indices.data(),
+				uint32_t(m_indices.size()));
+	}
+
+	/* The vertices and triangles of one run of OBJ lines. Indices counting
+	 * back from the last vertex are resolved once the vertices before the
+	 * run are counted, so they are kept aside with their position. */
+	struct ObjRun {
+		vector<float> vertices;
+		vector<uint32_t> indices;
+		vector<std::pair<size_t, int64_t>> relative;
+		bool good = true;
+	};
+
+	static bool parse_obj_run(char const *p, char const *last, ObjRun &run) {
+		vector<int64_t> poly;
+		while(p < last) {
+			auto eol = line_end(p, last);
+			p = skip(p, eol);
+			if(eol - p > 1 && p[0] == 'v' && blank(p[1])) {
+				// x y z, optionally w, or r g b as some scanners write
+				float v[7];
+				unsigned n = 0;
+				for(p = skip(p + 1, eol); p < eol && n < 7;
+						p = skip(p, eol)) {
+					auto q = parse_float(p, eol, v[n++]);
+					if(q == p) return false;
+					p = q;
+				}
+				if(n < 3) return false;
+				run.vertices.insert(run.vertices.end(),
+						{v[0], v[1], v[2], n == 4 ? v[3] : 1.f});
+			} else if(eol - p > 1 && p[0] == 'f' && blank(p[1])) {
+				auto count = int64_t(run.vertices.size() / 4);
+				poly.clear();
+				for(p = skip(p + 1, eol); p < eol; p = skip(p, eol)) {
+					int64_t i;
+					auto q = parse_int(p, eol, i);
+					if(q == p || !i) return false;
+					// Texture and normal indices are not kept
+					for(p = q; p < eol && !blank(*p); p++);
+					poly.push_back(i);
+				}
+				for(size_t k = 2; k < poly.size(); k++)
+					for(auto i : {poly[0], poly[k-1], poly[k]}) {
+						if(i < 0) run.relative.emplace_back(
+								run.indices.size(), count + i);
+						run.indices.push_back(i < 0 ? 0 : uint32_t(
+								std::min<int64_t>(i - 1, UINT32_MAX)));
+					}
+			}
+			p = eol + 1;
+		}
+		return true;
+	}
+
+	bool Importer::parse_obj(char const *data, size_t size,
+			Abstract::Pool &pool) {
+		auto bounds = split(data, data + size, runs(size, pool));
+		vector<ObjRun> parts(bounds.size() - 1);
+		each(pool, parts.size(), [&] (size_t i) {
+			parts[i].good = parse_obj_run(bounds[i], bounds[i+1], parts[i]);
+		});
+		vector<size_t> vertex_at = {0}, index_at = {0};
+		for(auto const& part : parts) {
+			if(!part.good) return false;
+			vertex_at.push_back(vertex_at.back() + part.vertices.size());
+			index_at.push_back(index_at.back() + part.indices.size());
+		}
+		auto n = vertex_at.back() / 4;
+		if(n > UINT32_MAX) return false;
+		m_vertices.resize(vertex_at.back());
+		m_indices.resize(index_at.back());
+		vector<char> good(parts.size(), true);
+		each(pool, parts.size(), [&] (size_t i) {
+			auto const& part = parts[i];
+			std::copy(part.vertices.begin(), part.vertices.end(),
+					m_vertices.begin() + vertex_at[i]);
+			auto dest = &m_indices[index_at[i]];
+			std::copy(part.indices.begin(), part.indices.end(), dest);
+			auto base = int64_t(vertex_at[i] / 4);
+			for(auto const& r : part.relative) {
+				if(base + r.second < 0) good[i] = false;
+				else dest[r.first] = uint32_t(base + r.second);
+			}
+			for(size_t k = 0; k < part.indices.size(); k++)
+				if(dest[k] >= n) good[i] = false;
+		});
+		return std::find(good.begin(), good.end(), false) == good.end();
+	}
+
+	/* The scalar types of PLY properties, by their old and new names. */
+	enum class Type { int8, uint8, int16, uint16, int32, uint32,
+		float32, float64, none };
+	static Type type(string const& name) {
+		static const char *names[][2] = {{"char", "int8"},
+			{"uchar", "uint8"}, {"short", "int16"}, {"ushort", "uint16"},
+			{"int", "int32"}, {"uint", "uint32"}, {"float", "float32"},
+			{"double", "float64"}};
+		for(unsigned i = 0; i < 8; i++)
+			if(name == names[i][0] || name == names[i][1]) return Type(i);
+		return Type::none;
+	}
+	static size_t bytes(Type t) {
+		static const size_t sizes[] = {1, 1, 2, 2, 4, 4, 4, 8, 0};
+		return sizes[unsigned(t)];
+	}
+	template<typename T>
+	static double load(char const *p, bool swap) {
+		char b[sizeof(T)];
+		std::memcpy(b, p, sizeof b);
+		if(swap) std::reverse(b, b + sizeof b);
+		T t;
+		std::memcpy(&t, b, sizeof t);
+		return double(t);
+	}
+	static double load(char const *p, Type t, bool swap) {
+		switch(t) {
+			case Type::int8: return load<std::int8_t>(p, swap);
+			case Type::uint8: return load<std::uint8_t>(p, swap);
+			case Type::int16: return load<std::int16_t>(p, swap);
+			case Type::uint16: return load<std::uint16_t>(p, swap);
+			case Type::int32: return load<std::int32_t>(p, swap);
+			case Type::uint32: return load<std::uint32_t>(p, swap);
+			case Type::float32: return load<float>(p, swap);
+			case Type::float64: return load<double>(p, swap);
+			default: return 0;
+		}
+	}
+
+	/* A property is a list if it has a count type. */
+	struct Property {
+		string name;
+		Type type, count;
+	};
+	struct Element {
+		string name;
+		size_t count;
+		vector<Property> properties;
+		/* The properties used, or -1: x, y, z, and the face list. */
+		int x = -1, y = -1, z = -1, list = -1;
+		/* The bytes in a binary record, or 0 if it holds a list. */
+		size_t stride = 0;
+	};
+
+	/* Reads a record as text, keeping each scalar value by property and
+	 * the entries of the used list; null if the record is malformed. */
+	static char const* read_text(char const *p, char const *last,
+			Element const& e, double *values, vector<int64_t> &list) {
+		list.clear();
+		for(size_t k = 0; k < e.properties.size(); k++) {
+			auto const& prop = e.properties[k];
+			int64_t n = 1;
+			p = skip(p, last);
+			if(prop.count != Type::none) {
+				auto q = parse_int(p, last, n);
+				if(q == p || n < 0) return nullptr;
+				p = q;
+			}
+			for(int64_t j = 0; j < n; j++) {
+				p = skip(p, last);
+				char const *q;
+				if(prop.type == Type::float32 || prop.type == Type::float64) {
+					float f;
+					q = parse_float(p, last, f);
+					values[k] = f;
+				} else {
+					int64_t i;
+					q = parse_int(p, last, i);
+					values[k] = double(i);
+					if(int(k) == e.list) list.push_back(i);
+				}
+				if(q == p) return nullptr;
+				p = q;
+			}
+		}
+		return p;
+	}
+	/* Reads a record in binary, as read_text does. */
+	static char const* read_binary(char const *p, char const *last,
+			Element const& e, bool swap, double *values,
+			vector<int64_t> &list) {
+		list.clear();
+		for(size_t k = 0; k < e.properties.size(); k++) {
+			auto const& prop = e.properties[k];
+			size_t n = 1;
+			if(prop.count != Type::none) {
+				if(size_t(last - p) < bytes(prop.count)) return nullptr;
+				auto count = load(p, prop.count, swap);
+				if(count < 0) return nullptr;
+				n = size_t(count);
+				p += bytes(prop.count);
+			}
+			auto size = bytes(prop.type);
+			if(size_t(last - p) / size < n) return nullptr;
+			for(size_t j = 0; j < n; j++, p += size) {
+				values[k] = load(p, prop.type, swap);
+				if(int(k) == e.list) list.push_back(int64_t(values[k]));
+			}
+		}
+		return p;
+	}
+
+	bool Importer::parse_ply(char const *data, size_t size,
+			Abstract::Pool &pool) {
+		auto last = data + size, p = data;
+		vector<Element> elements;
+		bool text = false, swap = false;
+		const uint32_t one = 1;
+		bool little = *reinterpret_cast<char const*>(&one);
+		for(bool ended = false; !ended;) {
+			if(p == last) return false;
+			auto eol = line_end(p, last);
+			std::istringstream line(string(p, eol));
+			p = eol < last ? eol + 1 : last;
+			string word;
+			line >> word;
+			if(word == "format") {
+				line >> word;
+				if(word == "ascii") text = true;
+				else if(word == "binary_little_endian") swap = !little;
+				else if(word == "binary_big_endian") swap = little;
+				else return false;
+			} else if(word == "element") {
+				Element e;
+				if(!(line >> e.name >> e.count)) return false;
+				elements.push_back(e);
+			} else if(word == "property") {
+				if(elements.empty()) return false;
+				auto &e = elements.back();
+				Property prop = {"", Type::none, Type::none};
+				line >> word;
+				if(word == "list") {
+					string count;
+					line >> count >> word;
+					prop.count = type(count);
+					if(prop.count == Type::none) return false;
+				}
+				prop.type = type(word);
+				if(!(line >> prop.name) || prop.type == Type::none)
+					return false;
+				int k = int(e.properties.size());
+				if(prop.count == Type::none) {
+					if(prop.name == "x") e.x = k;
+					else if(prop.name == "y") e.y = k;
+					else if(prop.name == "z") e.z = k;
+				} else if(prop.name == "vertex_indices"
+						|| prop.name == "vertex_index") e.list = k;
+				e.properties.push_back(prop);
+			} else if(word == "end_header") ended = true;
+		}
+		for(auto &e : elements) {
+			e.stride = 0;
+			for(auto const& prop : e.properties) {
+				if(prop.count != Type::none) {
+					e.stride = 0;
+					break;
+				}
+				e.stride += bytes(prop.type);
+			}
+		}
+		Element const *vertex = nullptr;
+		for(auto const& e : elements)
+			if(e.name == "vertex") vertex = &e;
+		if(!vertex || vertex->x < 0 || vertex->y < 0 || vertex->z < 0
+				|| vertex->count > UINT32_MAX) return false;
+		auto n = vertex->count;
+		m_vertices.assign(4 * n, 1.f);
+		auto put = [&] (size_t i, double const *values) {
+			m_vertices[4*i] = float(values[vertex->x]);
+			m_vertices[4*i+1] = float(values[vertex->y]);
+			m_vertices[4*i+2] = float(values[vertex->z]);
+		};
+
+		if(text) {
+			// Every record is a line, so lines number the records
+			auto bounds = split(p, last, runs(last - p, pool));
+			auto parts = bounds.size() - 1;
+			vector<size_t> lines(parts + 1, 0), start = {0};
+			each(pool, parts, [&] (size_t i) {
+				lines[i+1] = std::count(bounds[i], bounds[i+1], '\n');
+			});
+			for(size_t i = 0; i < parts; i++) lines[i+1] += lines[i];
+			for(auto const& e : elements)
+				start.push_back(start.back() + e.count);
+			if(lines.back() + (p < last && last[-1] != '\n') < start.back())
+				return false;
+			vector<vector<uint32_t>> faces(parts);
+			vector<char> good(parts, true);
+			each(pool, parts, [&] (size_t i) {
+				vector<double> values(64);
+				vector<int64_t> list;
+				size_t e = 0, line = lines[i];
+				for(auto q = bounds[i]; q < bounds[i+1]; line++) {
+					auto eol = line_end(q, bounds[i+1]);
+					while(e < elements.size() && line >= start[e+1]) e++;
+					if(e == elements.size()) break;
+					auto const& el = elements[e];
+					bool used = &el == vertex || el.list >= 0;
+					values.resize(std::max(values.size(),
+							el.properties.size()));
+					if(used && !read_text(q, eol, el, values.data(), list))
+						good[i] = false;
+					else if(&el == vertex) put(line - start[e], values.data());
+					else if(el.list >= 0 && !fan(list.data(), list.size(),
+							n, faces[i])) good[i] = false;
+					q = eol + 1;
+				}
+			});
+			if(std::find(good.begin(), good.end(), false) != good.end())
+				return false;
+			size_t total = 0;
+			for(auto const& f : faces) total += f.size();
+			m_indices.reserve(total);
+			for(auto const& f : faces)
+				m_indices.insert(m_indices.end(), f.begin(), f.end());
+			return true;
+		}
+
+		vector<double> values;
+		vector<int64_t> list;
+		for(auto const& e : elements) {
+			values.resize(std::max(values.size(), e.properties.size()));
+			if(&e == vertex && e.stride) {
+				// Fixed records decode in parallel, straight from the offsets
+				if(size_t(last - p) / e.stride < e.count) return false;
+				size_t offset[3] = {0, 0, 0};
+				int used[3] = {e.x, e.y, e.z};
+				for(unsigned k = 0; k < 3; k++)
+					for(int j = 0; j < used[k]; j++)
+						offset[k] += bytes(e.properties[j].type);
+				pool.parallel(e.count, 1 << 12, [&] (size_t i0, size_t i1) {
+					for(auto i = i0; i < i1; i++) {
+						auto r = p + i * e.stride;
+						for(unsigned k = 0; k < 3; k++)
+							m_vertices[4*i+k] = float(load(r + offset[k],
+									e.properties[used[k]].type, swap));
+					}
+				});
+				p += e.count * e.stride;
+			} else if(e.stride && e.list < 0) {
+				if(size_t(last - p) / e.stride < e.count) return false;
+				p += e.count * e.stride;
+			} else for(size_t i = 0; i < e.count; i++) {
+				// Records with lists vary in size, so are read in turn
+				p = read_binary(p, last, e, swap, values.data(), list);
+				if(!p) return false;
+				if(&e == vertex) put(i, values.data());
+				else if(e.list >= 0
+						&& !fan(list.data(), list.size(), n, m_indices))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	/* Vertices with equal positions, -0 and 0 alike, are one vertex. */
+	static uint64_t hash(float const *v) {
+		uint64_t h = 0;
+		for(unsigned k = 0; k < 4; k++) {
+			float f = v[k] + 0.f;
+			uint32_t bits;
+			std::memcpy(&bits, &f, sizeof bits);
+			h = (h ^ bits) * 0x9E3779B97F4A7C15ull;
+		}
+		// Round coordinates leave the low bits zero, so mix in the high
+		h = (h ^ h >> 33) * 0xFF51AFD7ED558CCDull;
+		return h ^ h >> 33;
+	}
+	static bool same(float const *l, float const *r) {
+		for(unsigned k = 0; k < 4; k++) {
+			float a = l[k] + 0.f, b = r[k] + 0.f;
+			if(std::memcmp(&a, &b, sizeof a)) return false;
+		}
+		return true;
+	}
+
+	void Importer::merge(Abstract::Pool &pool) {
+		auto n = vertex_count();
+		m_read = n;
+		if(n < 2) return;
+		auto v = m_vertices.data();
+
+		// Scatter the vertices into buckets by hash, in order within each;
+		// a bucket's table then fits in the L2 cache
+		constexpr size_t buckets = 4096;
+		size_t parts = pool.size() * 4, per = (n + parts - 1) / parts;
+		vector<size_t> counts(parts * buckets, 0);
+		each(pool, parts, [&] (size_t c) {
+			auto count = &counts[c * buckets];
+			for(auto i = c * per; i < std::min(n, (c + 1) * per); i++)
+				count[hash(v + 4*i) >> 52]++;
+		});
+		vector<size_t> at(parts * buckets), begin(buckets + 1, 0);
+		for(size_t b = 0, total = 0; b < buckets; b++) {
+			begin[b] = total;
+			for(size_t c = 0; c < parts; c++) {
+				at[c * buckets + b] = total;
+				total += counts[c * buckets + b];
+			}
+		}
+		begin[buckets] = n;
+		// Each entry carries its position, so comparisons stay in cache
+		struct Entry {
+			float position[4];
+			uint32_t index;
+		};
+		vector<Entry> order(n);
+		each(pool, parts, [&] (size_t c) {
+			auto dest = &at[c * buckets];
+			for(auto i = c * per; i < std::min(n, (c + 1) * per); i++) {
+				auto &e = order[dest[hash(v + 4*i) >> 52]++];
+				std::copy(v + 4*i, v + 4*i + 4, e.position);
+				e.index = uint32_t(i);
+			}
+		});
+
+		// The first of equal vertices leads them; each bucket finds its
+		// leads in an open-addressed table at most half full
+		vector<uint32_t> lead(n), remap(n);
+		each(pool, buckets, [&] (size_t b) {
+			size_t mask = 1;
+			while(mask < 2 * (begin[b+1] - begin[b])) mask <<= 1;
+			vector<Entry> seen(mask--, Entry{{0, 0, 0, 0}, UINT32_MAX});
+			for(auto k = begin[b]; k < begin[b+1]; k++) {
+				auto const& e = order[k];
+				for(auto s = hash(e.position) & mask;; s = (s + 1) & mask) {
+					auto const& t = seen[s];
+					if(t.index == UINT32_MAX) {
+						seen[s] = e;
+						lead[e.index] = e.index;
+						break;
+					}
+					if(same(t.position, e.position)) {
+						lead[e.index] = t.index;
+						break;
+					}
+				}
+			}
+		});
+
+		// Number the representatives in order, then map the rest to them
+		vector<size_t> kept(parts + 1, 0);
+		each(pool, parts, [&] (size_t c) {
+			for(auto i = c * per; i < std::min(n, (c + 1) * per); i++)
+				kept[c+1] += lead[i] == i;
+		});
+		for(size_t c = 0; c < parts; c++) kept[c+1] += kept[c];
+		vector<float> merged(4 * kept.back());
+		each(pool, parts, [&] (size_t c) {
+			auto k = kept[c];
+			for(auto i = c * per; i < std::min(n, (c + 1) * per); i++)
+				if(lead[i] == i) {
+					std::copy(v + 4*i, v + 4*i + 4, &merged[4*k]);
+					remap[i] = uint32_t(k++);
+				}
+		});
+		each(pool, parts, [&] (size_t c) {
+			for(auto i = c * per; i < std::min(n, (c + 1) * per); i++)
+				if(lead[i] != i) remap[i] = remap[lead[i]];
+		});
+		pool.parallel(m_indices.size(), 1 << 12,
+			[&] (size_t first, size_t last) {
+				for(auto i = first; i < last; i++)
+					m_indices[i] = remap[m_indices[i]];
+			});
+		m_vertices = std::move(merged);
+	}
+
+	bool Importer::parse(char const *data, size_t size,
+			Abstract::Pool &pool) {
+		bool ply = size > 3 && !std::memcmp(data, "ply", 3)
+			&& (data[3] == '\n' || data[3] == '\r');
+		if(!(ply ? parse_ply(data, size, pool)
+				: parse_obj(data, size, pool))) {
+			m_vertices.clear();
+			m_indices.clear();
+			return false;
+		}
+		merge(pool);
+		return true;
+	}
+
+	Importer::Importer(char const *data, size_t size,
+			Abstract::Pool &pool) {
+		m_valid = parse(data, size, pool);
+	}
+
+	Importer::Importer(string const& path, Abstract::Pool &pool) {
+		int fd = open(path.c_str(), O_RDONLY);
+		if(fd < 0) return;
+		struct stat st;
+		void *map = MAP_FAILED;
+		if(!fstat(fd, &st) && st.st_size > 0)
+			map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if(map == MAP_FAILED) return;
+		// Each run is read once, front to back
+		posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+		m_valid = parse(static_cast<char const*>(map), st.st_size, pool);
+		munmap(map, st.st_size);
+	}
+}
@@ -0,0 +1,241 @@
+/*! @file src/interpolation.cpp
+ *  @brief Batched interpolation kernels declared in interpolation.hpp */
+
+#include "interpolation.hpp"
+
+///@cond
+#include <algorithm>
+///@endcond
+
+namespace Geometry {
+	using Simd::Lane;
+
+	/* The interpolation parameter, broadcast once or loaded per lane. */
+	struct Uniform {
+		Lane t;
+		Lane operator()(std::size_t) const { return t; }
+	};
+	struct Varying {
+		float const *t;
+		Lane operator()(std::size_t i) const { return Lane::load(t + i); }
+	};
+
+	/* One lane of quaternions, loaded from and stored to a batch. */
+	struct QuatLane {
+		Lane w, x, y, z;
+		static QuatLane load(QuatBatch const& q, std::size_t i) {
+			return {Lane::load(&q.w[i]), Lane::load(&q.x[i]),
+				Lane::load(&q.y[i]), Lane::load(&q.z[i])};
+		}
+		void store(QuatBatch &q, std::size_t i) const {
+			w.store(&q.w[i]); x.store(&q.x[i]);
+			y.store(&q.y[i]); z.store(&q.z[i]);
+		}
+	};
+
+	static inline Lane dot(QuatLane const& l, QuatLane const& r) {
+		return l.w*r.w + l.x*r.x + l.y*r.y + l.z*r.z;
+	}
+	static inline QuatLane product(QuatLane const& l, QuatLane const& r) {
+		return {l.w*r.w - l.x*r.x - l.y*r.y - l.z*r.z,
+			l.w*r.x + l.x*r.w + l.y*r.z - l.z*r.y,
+			l.w*r.y - l.x*r.z + l.y*r.w + l.z*r.x,
+			l.w*r.z + l.x*r.y - l.y*r.x + l.z*r.w};
+	}
+	static inline QuatLane conjugate(QuatLane const& q) {
+		return {q.w, -q.x, -q.y, -q.z};
+	}
+	static inline QuatLane blend(QuatLane const& l, QuatLane const& r,
+			Lane a, Lane b) {
+		return {a*l.w + b*r.w, a*l.x + b*r.x, a*l.y + b*r.y, a*l.z + b*r.z};
+	}
+	static inline QuatLane sum(QuatLane const& l, QuatLane const& r) {
+		return {l.w + r.w, l.x + r.x, l.y + r.y, l.z + r.z};
+	}
+	static inline QuatLane select(Lane mask, QuatLane const& t,
+			QuatLane const& f) {
+		return {select(mask, t.w, f.w), select(mask, t.x, f.x),
+			select(mask, t.y, f.y), select(mask, t.z, f.z)};
+	}
+	static inline QuatLane scale(QuatLane const& q, Lane s) {
+		return {q.w*s, q.x*s, q.y*s, q.z*s};
+	}
+
+	/* Arccosine over [0, 1] by Abramowitz and Stegun 4.4.46, with an
+	 * absolute error under 2e-8 before rounding to float. */
+	static inline Lane acos01(Lane x) {
+		static constexpr float a[] = {-0.0012624911f, 0.0066700901f,
+			-0.0170881256f, 0.0308918810f, -0.0501743046f, 0.0889789874f,
+			-0.2145988016f, 1.5707963050f};
+		auto p = Lane::broadcast(a[0]);
+		for(unsigned i = 1; i < 8; i++)
+			p = mul_add(p, x, Lane::broadcast(a[i]));
+		return sqrt(Lane::broadcast(1) - x) * p;
+	}
+	/* Sine and cosine over [0, pi/2] by Taylor polynomials through x^11
+	 * and x^12; the first omitted terms are under 6e-8 and 7e-9. */
+	static inline Lane sin(Lane x) {
+		auto x2 = x*x, p = Lane::broadcast(-1.f/39916800);
+		for(float c : {1.f/362880, -1.f/5040, 1.f/120, -1.f/6, 1.f})
+			p = mul_add(p, x2, Lane::broadcast(c));
+		return p * x;
+	}
+	static inline Lane cos(Lane x) {
+		auto x2 = x*x, p = Lane::broadcast(1.f/479001600);
+		for(float c : {-1.f/3628800, 1.f/40320, -1.f/720, 1.f/24,
+				-1.f/2, 1.f})
+			p = mul_add(p, x2, Lane::broadcast(c));
+		return p;
+	}
+
+	/* nlerp with the sign of r already chosen; zero results stay zero. */
+	static inline QuatLane nlerp(QuatLane const& l, QuatLane const& r,
+			Lane t, Lane sign) {
+		auto zero = Lane::broadcast(0), one = Lane::broadcast(1);
+		auto q = blend(l, r, one - t, sign * t);
+		auto m = sqrt(dot(q, q));
+		return scale(q, select(m > zero, one / m, zero));
+	}
+	static inline Lane sign(Lane d) {
+		return select(d < Lane::broadcast(0),
+			Lane::broadcast(-1), Lane::broadcast(1));
+	}
+
+	template<typename P>
+	static void nlerp(QuatBatch const& l, QuatBatch const& r, P const& t,
+			QuatBatch& dest) {
+		auto n = std::min(l.size(), r.size());
+		dest.resize(n);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto a = QuatLane::load(l, i), b = QuatLane::load(r, i);
+			nlerp(a, b, t(i), sign(dot(a, b))).store(dest, i);
+		}
+	}
+	void nlerp(QuatBatch const& l, QuatBatch const& r, float t,
+			QuatBatch& dest) {
+		nlerp(l, r, Uniform{Lane::broadcast(t)}, dest);
+	}
+	void nlerp(QuatBatch const& l, QuatBatch const& r,
+			Simd::Array const& t, QuatBatch& dest) {
+		nlerp(l, r, Varying{t.data()}, dest);
+	}
+
+	template<typename P>
+	static void slerp(QuatBatch const& l, QuatBatch const& r, P const& t,
+			QuatBatch& dest) {
+		auto n = std::min(l.size(), r.size());
+		dest.resize(n);
+		auto one = Lane::broadcast(1), limit = Lane::broadcast(0.9995f);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto a = QuatLane::load(l, i), b = QuatLane::load(r, i);
+			auto u = t(i), d = dot(a, b), s = sign(d);
+			d = min(s * d, one);
+			auto close = d > limit, theta = acos01(d),
+				 inv = one / select(close, one, sqrt(one - d*d));
+			auto q = blend(a, b, sin((one - u) * theta) * inv,
+					s * sin(u * theta) * inv);
+			// As in the scalar form, nearly equal ends fall back to nlerp
+			if(bits(close))
+				q = select(close, nlerp(a, b, u, s), q);
+			q.store(dest, i);
+		}
+	}
+	void slerp(QuatBatch const& l, QuatBatch const& r, float t,
+			QuatBatch& dest) {
+		slerp(l, r, Uniform{Lane::broadcast(t)}, dest);
+	}
+	void slerp(QuatBatch const& l, QuatBatch const& r,
+			Simd::Array const& t, QuatBatch& dest) {
+		slerp(l, r, Varying{t.data()}, dest);
+	}
+
+	template<typename P>
+	static void slerp_fast(QuatBatch const& l, QuatBatch const& r,
+			P const& t, QuatBatch& dest) {
+		auto n = std::min(l.size(), r.size());
+		dest.resize(n);
+		auto one = Lane::broadcast(1), half = Lane::broadcast(.5f);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto a = QuatLane::load(l, i), b = QuatLane::load(r, i);
+			auto u = t(i), d = dot(a, b), s = sign(d);
+			d = s * d;
+			// The coefficients of the scalar slerp_fast
+			auto A = mul_add(mul_add(mul_add(Lane::broadcast(-1.43519f), d,
+						Lane::broadcast(3.55645f)), d,
+						Lane::broadcast(-3.2452f)), d,
+						Lane::broadcast(1.0904f)),
+				 B = mul_add(mul_add(Lane::broadcast(0.215638f), d,
+						Lane::broadcast(-1.06021f)), d,
+						Lane::broadcast(0.848013f)),
+				 h = u - half, k = mul_add(A * h, h, B);
+			nlerp(a, b, mul_add(u * h * (u - one), k, u), s).store(dest, i);
+		}
+	}
+	void slerp_fast(QuatBatch const& l, QuatBatch const& r, float t,
+			QuatBatch& dest) {
+		slerp_fast(l, r, Uniform{Lane::broadcast(t)}, dest);
+	}
+	void slerp_fast(QuatBatch const& l, QuatBatch const& r,
+			Simd::Array const& t, QuatBatch& dest) {
+		slerp_fast(l, r, Varying{t.data()}, dest);
+	}
+
+	/* l (l* r)^t as in the scalar sclerp and power, with the half angle
+	 * h taken from whichever of its sine and cosine is smaller. */
+	template<typename P>
+	static void sclerp(DualQuatBatch const& l, DualQuatBatch const& r,
+			P const& t, DualQuatBatch& dest) {
+		auto n = std::min(l.size(), r.size());
+		dest.resize(n);
+		auto zero = Lane::broadcast(0), one = Lane::broadcast(1),
+			 right = Lane::broadcast(1.57079632679f),
+			 sixth = Lane::broadcast(1.f/6), third = Lane::broadcast(1.f/3);
+		for(std::size_t i = 0, N = Simd::padded(n); i < N; i += Lane::N) {
+			auto lu = QuatLane::load(l.u, i), lv = QuatLane::load(l.v, i),
+				 ru = QuatLane::load(r.u, i), rv = QuatLane::load(r.v, i);
+			auto u = t(i), s = sign(dot(lu, ru));
+			ru = scale(ru, s);
+			rv = scale(rv, s);
+			auto cu = conjugate(lu), du = product(cu, ru),
+				 dv = sum(product(cu, rv), product(conjugate(lv), ru));
+
+			/* With r = sin(h) l, the power is (cos th, k r) + e(t k d.w,
+			 * k d + e r) for k = sin(th)/sin(h); e holds the pitch along
+			 * the axis, and is taken without dividing d by sin(h) while
+			 * the rotation is small enough for the axis to be noise. */
+			auto w = max(du.w, zero),
+				 a = du.x*dv.x + du.y*dv.y + du.z*dv.z,
+				 sn = sqrt(du.x*du.x + du.y*du.y + du.z*du.z),
+				 wide = w > sn,
+				 h = select(wide, right - acos01(min(sn, one)),
+					acos01(min(w, one))),
+				 small = h < Lane::broadcast(0.03f),
+				 // Zero lanes, the padding past n among them, stay zero
+				 inv = select(sn > zero, one / select(small, one, sn),
+					zero),
+				 th = u * h, c = cos(th), st = sin(th),
+				 uu = one - u*u, h2 = h*h,
+				 k = select(small, u * mul_add(uu, h2 * sixth, one),
+					st * inv),
+				 // (t cos(th)/cos(h) - k)/sin(h)^2, or its limit t(1 - t^2)/3
+				 g = select(small, u * uu * third,
+					(u * c / select(wide, w, one) - k) * inv * inv),
+				 // Otherwise the pitch -d.w/sin(h) and moment along l
+				 f = (-u * c * dv.w * inv - k * a * inv) * inv,
+				 e = select(wide, a * g, f);
+			QuatLane pu = {c, k*du.x, k*du.y, k*du.z},
+				 pv = {u*k*dv.w, k*dv.x + e*du.x, k*dv.y + e*du.y,
+					 k*dv.z + e*du.z};
+			product(lu, pu).store(dest.u, i);
+			sum(product(lu, pv), product(lv, pu)).store(dest.v, i);
+		}
+	}
+	void sclerp(DualQuatBatch const& l, DualQuatBatch const& r, float t,
+			DualQuatBatch& dest) {
+		sclerp(l, r, Uniform{Lane::broadcast(t)}, dest);
+	}
+	void sclerp(DualQuatBatch const& l, DualQuatBatch const& r,
+			Simd::Array const& t, DualQuatBatch& dest) {
+		sclerp(l, r, Varying{t.data()}, dest);
+	}
+}
@@ -0,0 +1,128 @@
+/*! @file src/mapped.cpp
+ *  @brief Implementation of the mapped meshes from mapped.hpp */
+
+#include "mapped.hpp"
+
+///@cond
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+///@endcond
+
+namespace Streams {
+	using std::uint32_t;
+	using std::uint64_t;
+
+	constexpr std::size_t MeshFile::alignment;
+
+	static const char magic[8] = {'M', 'E', 'S', 'H', 'B', 'I', 'N', '1'};
+	static constexpr uint32_t order = 0x01020304, version = 1;
+	static_assert(sizeof(MeshFile::Header) == MeshFile::alignment,
+			"The header fills the first section");
+
+	static uint64_t align(uint64_t offset) {
+		return (offset + MeshFile::alignment - 1)
+			/ MeshFile::alignment * MeshFile::alignment;
+	}
+
+	MeshFile::operator bool(void) const { return m_valid; }
+	MeshFile::Header const& MeshFile::header(void) const {
+		return *reinterpret_cast<Header const*>(m_map);
+	}
+	float const* MeshFile::vertices(void) const {
+		return m_valid ? reinterpret_cast<float const*>(m_map
+				+ header().vertex_offset) : nullptr;
+	}
+	uint32_t MeshFile::vertex_count(void) const {
+		return m_valid ? header().vertices : 0;
+	}
+	uint32_t const* MeshFile::indices(void) const {
+		return m_valid ? reinterpret_cast<uint32_t const*>(m_map
+				+ header().index_offset) : nullptr;
+	}
+	uint32_t MeshFile::index_count(void) const {
+		return m_valid ? header().indices : 0;
+	}
+	Geometry::Vec_t<float> MeshFile::lo(void) const {
+		if(!m_valid) return {0, 0, 0};
+		auto const& h = header();
+		return {h.lo[0], h.lo[1], h.lo[2]};
+	}
+	Geometry::Vec_t<float> MeshFile::hi(void) const {
+		if(!m_valid) return {0, 0, 0};
+		auto const& h = header();
+		return {h.hi[0], h.hi[1], h.hi[2]};
+	}
+
+	bool MeshFile::write(std::string const& path, float const *vertices,
+			uint32_t n_vertices, uint32_t const *indices,
+			uint32_t n_indices) {
+		Header h = {};
+		std::memcpy(h.magic, magic, sizeof magic);
+		h.order = order;
+		h.version = version;
+		h.vertices = n_vertices;
+		h.indices = n_indices;
+		h.vertex_offset = sizeof h;
+		h.index_offset = align(h.vertex_offset
+				+ uint64_t(n_vertices) * 4 * sizeof(float));
+		for(unsigned k = 0; k < 3; k++) {
+			h.lo[k] = n_vertices ? vertices[k] : 0;
+			h.hi[k] = h.lo[k];
+		}
+		for(uint32_t i = 1; i < n_vertices; i++)
+			for(unsigned k = 0; k < 3; k++) {
+				h.lo[k] = std::min(h.lo[k], vertices[i * 4 + k]);
+				h.hi[k] = std::max(h.hi[k], vertices[i * 4 + k]);
+			}
+		std::ofstream out(path, std::ios::binary);
+		char pad[alignment] = {};
+		out.write(reinterpret_cast<const char*>(&h), sizeof h);
+		auto vertex_bytes = uint64_t(n_vertices) * 4 * sizeof(float);
+		out.write(reinterpret_cast<const char*>(vertices), vertex_bytes);
+		out.write(pad, h.index_offset - h.vertex_offset - vertex_bytes);
+		out.write(reinterpret_cast<const char*>(indices),
+				uint64_t(n_indices) * sizeof(uint32_t));
+		return bool(out);
+	}
+
+	MeshFile::MeshFile(std::string const& path) {
+		int fd = open(path.c_str(), O_RDONLY);
+		if(fd < 0) return;
+		struct stat st;
+		if(!fstat(fd, &st) && std::size_t(st.st_size) >= sizeof(Header)) {
+			auto map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE,
+					fd, 0);
+			if(map != MAP_FAILED) {
+				m_map = static_cast<char const*>(map);
+				m_size = st.st_size;
+			}
+		}
+		// The mapping holds its own reference to the file
+		close(fd);
+		if(!m_map) return;
+		auto const& h = header();
+		// Lengths are compared with the room left, as sums could wrap
+		uint64_t vertex_bytes = uint64_t(h.vertices) * 4 * sizeof(float),
+			index_bytes = uint64_t(h.indices) * sizeof(uint32_t);
+		m_valid = !std::memcmp(h.magic, magic, sizeof magic)
+			&& h.order == order && h.version == version
+			&& !(h.vertex_offset % alignment) && !(h.index_offset % alignment)
+			&& h.vertex_offset >= sizeof h && h.vertex_offset <= m_size
+			&& h.index_offset >= h.vertex_offset && h.index_offset <= m_size
+			&& vertex_bytes <= h.index_offset - h.vertex_offset
+			&& index_bytes <= m_size - h.index_offset;
+		// The sections are usually read whole and in order, e.g. to upload
+		if(m_valid)
+			posix_madvise(const_cast<char*>(m_map), m_size,
+					POSIX_MADV_WILLNEED);
+	}
+
+	MeshFile::~MeshFile(void) {
+		if(m_map) munmap(const_cast<char*>(m_map), m_size);
+	}
+}
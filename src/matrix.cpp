@@ -0,0 +1,130 @@
+/*! @file src/matrix.cpp
+ *  @brief Bulk vertex transforms declared in matrix.hpp */
+
+#include "matrix.hpp"
+#include "batch.hpp"
+#include "pool.hpp"
+
+///@cond
+#include <algorithm>
+#include <cstdint>
+///@endcond
+
+namespace Geometry {
+	using Simd::Lane;
+	using Simd::Quad;
+
+	/* Below this many vertices the hand-off to other threads costs more
+	 * than the transform itself. */
+	static constexpr std::size_t serial = 1 << 14, grain = 1 << 12;
+
+	/* Rows of the matrix broadcast once per call, shared by every lane. */
+	struct Rows {
+		Lane m[12];
+		Rows(Matrix_t<float> const& mat) {
+			for(unsigned r = 0; r < 4; r++)
+				for(unsigned c = 0; c < 3; c++)
+					m[r*3 + c] = Lane::broadcast(mat[r*4 + c]);
+		}
+	};
+
+	static void transform(Lane const *m, Lane &x, Lane &y, Lane &z) {
+		auto ox = mul_add(x, m[0], mul_add(y, m[3], mul_add(z, m[6], m[ 9]))),
+			 oy = mul_add(x, m[1], mul_add(y, m[4], mul_add(z, m[7], m[10]))),
+			 oz = mul_add(x, m[2], mul_add(y, m[5], mul_add(z, m[8], m[11])));
+		x = ox; y = oy; z = oz;
+	}
+
+	/* Points are gathered a block at a time into aligned SoA scratch so the
+	 * twelve-byte stride of Vec_t costs nothing in the arithmetic. */
+	static void transform(Rows const& rows, Vec_t<float> const *src,
+			Vec_t<float> *dest, std::size_t n) {
+		alignas(SIMD_ALIGN) float x[Simd::block], y[Simd::block],
+			z[Simd::block];
+		for(std::size_t i = 0; i < n; i += Simd::block) {
+			std::size_t len = std::min(Simd::block, n - i);
+			for(std::size_t j = 0; j < len; j++) {
+				x[j] = src[i+j].x; y[j] = src[i+j].y; z[j] = src[i+j].z;
+			}
+			// Lanes past the last point work on zeros, not on stale floats
+			for(std::size_t j = len; j < Simd::block; j++)
+				x[j] = y[j] = z[j] = 0;
+			for(std::size_t j = 0; j < Simd::block; j += Lane::N) {
+				auto lx = Lane::load(x+j), ly = Lane::load(y+j),
+					 lz = Lane::load(z+j);
+				transform(rows.m, lx, ly, lz);
+				lx.store(x+j); ly.store(y+j); lz.store(z+j);
+			}
+			for(std::size_t j = 0; j < len; j++)
+				dest[i+j] = {x[j], y[j], z[j]};
+		}
+	}
+
+	void transform(Matrix_t<float> const& m,
+			Vec_t<float> const *src, Vec_t<float> *dest, std::size_t n) {
+		Rows rows(m);
+		if(n < serial) return transform(rows, src, dest, n);
+		Abstract::Pool::shared().parallel(n, grain,
+			[&] (std::size_t i0, std::size_t i1) {
+				transform(rows, src + i0, dest + i0, i1 - i0);
+			});
+	}
+
+	void transform(Matrix_t<float> const& m,
+			Vec_t<float> *p0, Vec_t<float> *p1) {
+		transform(m, p0, p0, p1 - p0);
+	}
+
+	void transform(Matrix_t<float> const& m,
+			float const *src, float *dest, std::size_t n) {
+		auto r0 = Quad::loadu(&m[0]), r1 = Quad::loadu(&m[4]),
+			 r2 = Quad::loadu(&m[8]), r3 = Quad::loadu(&m[12]);
+		bool stream = !(std::uintptr_t(dest) % 16)
+			&& (dest + 4*n <= src || src + 4*n <= dest);
+		auto run = [&] (std::size_t i0, std::size_t i1) {
+			for(auto i = i0; i < i1; i++) {
+				auto const *v = src + 4*i;
+				auto out = mul_add(Quad::broadcast(v[0]), r0,
+					mul_add(Quad::broadcast(v[1]), r1,
+					mul_add(Quad::broadcast(v[2]), r2,
+					Quad::broadcast(v[3]) * r3)));
+				if(stream) out.stream(dest + 4*i);
+				else out.storeu(dest + 4*i);
+			}
+			if(stream) Simd::fence();
+		};
+		if(n < serial) return run(0, n);
+		Abstract::Pool::shared().parallel(n, grain, run);
+	}
+
+	void transform(Matrix_t<float> const& m,
+			VecBatch const& src, VecBatch& dest) {
+		Rows rows(m);
+		auto n = src.size();
+		dest.resize(n);
+		auto run = [&] (std::size_t i0, std::size_t i1) {
+			for(auto i = i0; i < i1; i += Lane::N) {
+				auto x = Lane::load(&src.x[i]), y = Lane::load(&src.y[i]),
+					 z = Lane::load(&src.z[i]);
+				transform(rows.m, x, y, z);
+				x.store(&dest.x[i]); y.store(&dest.y[i]); z.store(&dest.z[i]);
+			}
+		};
+		// Chunks start on block boundaries, and the padding is processed too
+		auto N = Simd::padded(n);
+		if(N < serial) run(0, N);
+		else Abstract::Pool::shared().parallel(N, grain, run);
+		// The translation lands in the padding, which stays zero
+		for(auto *a : {&dest.x, &dest.y, &dest.z})
+			std::fill(a -> begin() + n, a -> end(), 0.f);
+	}
+
+	void product(Matrix_t<float> const *l, Matrix_t<float> const *r,
+			Matrix_t<float> *dest, std::size_t n) {
+		auto run = [&] (std::size_t i0, std::size_t i1) {
+			for(auto i = i0; i < i1; i++) dest[i] = product(l[i], r[i]);
+		};
+		if(n < serial) return run(0, n);
+		Abstract::Pool::shared().parallel(n, grain, run);
+	}
+}
@@ -0,0 +1,125 @@
+/*! @file src/mesh.cpp
+ *  @brief Implementation of the meshes from mesh.hpp */
+
+#include "mesh.hpp"
+#include "state.hpp"
+
+///@cond
+#include <algorithm>
+#include <cstring>
+///@endcond
+
+namespace View {
+	using namespace gl;
+
+	constexpr GLuint Mesh::position, Mesh::model;
+
+	GLsizei Mesh::size(void) const { return m_count; }
+	GLuint Mesh::vao(void) const { return m_vao; }
+
+	void Mesh::draw(void) const {
+		State::current().vao(m_vao);
+		if(m_instanced) {
+			for(GLuint c = 0; c < 4; c++)
+				glDisableVertexAttribArray(model + c);
+			m_instanced = false;
+		}
+		glDrawElements(GL_TRIANGLES, m_count, GL_UNSIGNED_INT, nullptr);
+	}
+
+	std::size_t Mesh::draw(StreamBuffer &stream,
+			Geometry::Matrix_t<float> const *transforms, std::size_t n) {
+		static constexpr GLsizei stride = sizeof(Geometry::Matrix_t<float>);
+		std::size_t done = 0, most = stream.region() / stride;
+		State::current().vao(m_vao);
+		// Enabled only here, so that draw() never reads stale instances
+		for(GLuint c = 0; c < 4; c++)
+			glEnableVertexAttribArray(model + c);
+		while(done < n) {
+			auto count = std::min(n - done, most);
+			auto slice = stream.allocate(count, stride);
+			if(!slice) break;
+			std::memcpy(slice.data, transforms + done, slice.size);
+			if(!stream.commit(slice)) break;
+			// The attributes follow the slice; the divisors stay set
+			State::current().buffer(GL_ARRAY_BUFFER, stream.vbo());
+			for(GLuint c = 0; c < 4; c++)
+				glVertexAttribPointer(model + c, 4, GL_FLOAT, GL_FALSE, stride,
+					reinterpret_cast<const void*>(slice.offset
+						+ c * 4 * sizeof(float)));
+			glDrawElementsInstanced(GL_TRIANGLES, m_count, GL_UNSIGNED_INT,
+				nullptr, GLsizei(count));
+			done += count;
+		}
+		for(GLuint c = 0; c < 4; c++)
+			glDisableVertexAttribArray(model + c);
+		m_instanced = false;
+		return done;
+	}
+
+	bool Mesh::draw(RenderQueue &queue, RenderQueue::Item item,
+			StreamBuffer &stream, Geometry::Matrix_t<float> const *transforms,
+			std::size_t n) {
+		static constexpr GLsizei stride = sizeof(Geometry::Matrix_t<float>);
+		if(!n || n > std::size_t(stream.region() / stride)) return false;
+		auto slice = stream.allocate(n, stride);
+		if(!slice) return false;
+		std::memcpy(slice.data, transforms, slice.size);
+		if(!stream.commit(slice)) return false;
+		// The attributes are vertex array state, so they hold until the
+		// submit unless the mesh is drawn again
+		State::current().vao(m_vao);
+		State::current().buffer(GL_ARRAY_BUFFER, stream.vbo());
+		for(GLuint c = 0; c < 4; c++) {
+			glVertexAttribPointer(model + c, 4, GL_FLOAT, GL_FALSE, stride,
+				reinterpret_cast<const void*>(slice.offset
+					+ c * 4 * sizeof(float)));
+			glEnableVertexAttribArray(model + c);
+		}
+		m_instanced = true;
+		item.vao = m_vao;
+		item.mode = GL_TRIANGLES;
+		item.type = GL_UNSIGNED_INT;
+		item.count = m_count;
+		item.offset = 0;
+		item.base = 0;
+		item.instances = GLsizei(n);
+		queue.push(item);
+		return true;
+	}
+
+	Mesh::Mesh(float const *vertices, std::size_t n_vertices,
+			GLuint const *indices, std::size_t n_indices):
+			m_count(GLsizei(n_indices)) {
+		glGenVertexArrays(1, &m_vao);
+		State::current().vao(m_vao);
+		glGenBuffers(1, &m_vbo);
+		State::current().buffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferData(GL_ARRAY_BUFFER, n_vertices * 4 * sizeof(float),
+			vertices, GL_STATIC_DRAW);
+		glEnableVertexAttribArray(position);
+		glVertexAttribPointer(position, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+		// The index buffer binding is part of the vertex array
+		glGenBuffers(1, &m_ibo);
+		State::current().buffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, n_indices * sizeof(GLuint),
+			indices, GL_STATIC_DRAW);
+		// The instance attributes stay disabled outside instanced draws
+		for(GLuint c = 0; c < 4; c++)
+			glVertexAttribDivisor(model + c, 1);
+	}
+
+	Mesh::Mesh(Streams::MeshFile const& file):
+		Mesh(file.vertices(), file.vertex_count(), file.indices(),
+			file.index_count()) {}
+
+	Mesh::~Mesh(void) {
+		auto &state = State::current();
+		state.forget_buffer(m_ibo);
+		state.forget_buffer(m_vbo);
+		state.forget_vao(m_vao);
+		if(m_ibo) glDeleteBuffers(1, &m_ibo);
+		if(m_vbo) glDeleteBuffers(1, &m_vbo);
+		if(m_vao) glDeleteVertexArrays(1, &m_vao);
+	}
+}
@@ -0,0 +1,111 @@
+/*! @file src/offscreen.cpp
+ *  @brief Implementation of the offscreen targets from offscreen.hpp */
+
+#include "offscreen.hpp"
+#include "state.hpp"
+
+namespace View {
+	constexpr unsigned Readback::buffers;
+
+	GLuint RenderTarget::fbo(void) const { return m_fbo; }
+	GLsizei RenderTarget::width(void) const { return m_width; }
+	GLsizei RenderTarget::height(void) const { return m_height; }
+
+	void RenderTarget::release(void) {
+		if(m_depth) glDeleteRenderbuffers(1, &m_depth);
+		if(m_color) glDeleteRenderbuffers(1, &m_color);
+		m_color = m_depth = 0;
+	}
+
+	bool RenderTarget::bind(GLsizei w, GLsizei h) {
+		if(w <= 0 || h <= 0) return false;
+		if(!m_fbo) glGenFramebuffers(1, &m_fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+		if(w == m_width && h == m_height) return m_complete;
+		release();
+		glGenRenderbuffers(1, &m_color);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_color);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+			GL_RENDERBUFFER, m_color);
+		glGenRenderbuffers(1, &m_depth);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+			GL_RENDERBUFFER, m_depth);
+		m_width = w;
+		m_height = h;
+		m_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER)
+			== GL_FRAMEBUFFER_COMPLETE;
+		return m_complete;
+	}
+
+	RenderTarget::~RenderTarget(void) {
+		release();
+		if(m_fbo) glDeleteFramebuffers(1, &m_fbo);
+	}
+
+	void Readback::sink(Sink sink) { m_sink = std::move(sink); }
+	unsigned Readback::delivered(void) const { return m_delivered; }
+
+	void Readback::deliver(Slot &slot) {
+		if(!slot.fence) return;
+		GLenum status;
+		do status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+				1000000);
+		while(status == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+		m_delivered++;
+		if(!m_sink) return;
+		auto size = GLsizeiptr(slot.width) * slot.height * 4;
+		State::current().buffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+		auto data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size,
+				GL_MAP_READ_BIT);
+		if(!data) return;
+		m_sink(static_cast<unsigned char const*>(data),
+				slot.width, slot.height, slot.frame);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+
+	void Readback::read(GLsizei w, GLsizei h) {
+		if(w <= 0 || h <= 0) return;
+		auto &slot = m_slots[m_next];
+		// Issued buffers frames ago, so the copy has long finished
+		deliver(slot);
+		auto &state = State::current();
+		if(!slot.pbo) glGenBuffers(1, &slot.pbo);
+		state.buffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+		auto size = GLsizeiptr(w) * h * 4;
+		if(size > slot.capacity) {
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+			slot.capacity = size;
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, GL_NONE_BIT);
+		slot.width = w;
+		slot.height = h;
+		slot.frame = m_frame++;
+		m_next = (m_next + 1) % buffers;
+		// Pack reads outside the readback go to client memory as usual
+		state.buffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	void Readback::flush(void) {
+		for(unsigned i = 0; i < buffers; i++)
+			deliver(m_slots[(m_next + i) % buffers]);
+		State::current().buffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	Readback::~Readback(void) {
+		auto &state = State::current();
+		for(auto &slot : m_slots) {
+			if(slot.fence) glDeleteSync(slot.fence);
+			if(slot.pbo) {
+				state.forget_buffer(slot.pbo);
+				glDeleteBuffers(1, &slot.pbo);
+			}
+		}
+	}
+}
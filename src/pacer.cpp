@@ -0,0 +1,87 @@
+/*! @file src/pacer.cpp
+ *  @brief Implementation of the frame pacing from pacer.hpp */
+
+#include "pacer.hpp"
+
+///@cond
+#include <algorithm>
+#include <thread>
+///@endcond
+
+namespace View {
+	using std::chrono::duration;
+	using std::chrono::duration_cast;
+	using std::chrono::microseconds;
+
+	/* Bounds of the spun stretch; the upper bound is reached only where
+	 * the scheduler is that coarse, and the lower keeps a margin for the
+	 * wake-up itself. */
+	static constexpr microseconds spin_min{50}, spin_max{4000};
+
+	void Pacer::rate(double hz) {
+		m_period = hz > 0 ? duration_cast<Clock::duration>(
+				duration<double>(1 / hz)) : Clock::duration::zero();
+		reset();
+	}
+	double Pacer::rate(void) const {
+		return m_period.count() ? 1 / duration<double>(m_period).count() : 0;
+	}
+	void Pacer::external(bool on) {
+		m_external = on;
+		reset();
+	}
+	bool Pacer::external(void) const { return m_external; }
+
+	unsigned Pacer::frames(void) const { return m_frames; }
+	unsigned Pacer::missed(void) const { return m_missed; }
+	Pacer::Clock::duration Pacer::last(void) const { return m_last; }
+	Pacer::Clock::duration Pacer::busy(void) const { return m_busy; }
+
+	void Pacer::reset(void) {
+		m_end = Clock::now();
+		m_deadline = m_end + m_period;
+		m_last = m_busy = Clock::duration::zero();
+		m_frames = m_missed = 0;
+	}
+
+	bool Pacer::end(void) {
+		auto now = Clock::now();
+		bool met = true;
+		m_busy = now - m_end;
+		if(m_period.count()) {
+			/* The swap paces external frames, so only a frame later than
+			 * a quarter period past its deadline counts as a miss. */
+			auto slack = m_external ? m_period / 4 : Clock::duration::zero();
+			if(now > m_deadline + slack) {
+				met = false;
+				m_missed++;
+				m_deadline = now;
+			} else if(m_external) {
+				m_deadline = now;
+			} else {
+				auto sleep = m_deadline - now - m_spin;
+				if(sleep > Clock::duration::zero()) {
+					std::this_thread::sleep_for(sleep);
+					// Track the worst recent oversleep, forgetting it slowly
+					auto over = Clock::now() - (now + sleep);
+					m_spin = std::min<Clock::duration>(spin_max,
+						std::max<Clock::duration>({spin_min, over + over / 4,
+							m_spin - m_spin / 16}));
+				}
+				while(Clock::now() < m_deadline)
+					std::this_thread::yield();
+			}
+			m_deadline += m_period;
+		}
+		now = Clock::now();
+		m_last = now - m_end;
+		m_end = now;
+		m_frames++;
+		return met;
+	}
+
+	Pacer::Pacer(double hz): m_spin(duration_cast<Clock::duration>(
+			microseconds{1000})) {
+		rate(hz);
+	}
+}
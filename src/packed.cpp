@@ -0,0 +1,148 @@
+/*! @file src/packed.cpp
+ *  @brief Packing and bulk conversion of the types from packed.hpp */
+
+#include "packed.hpp"
+#include "pool.hpp"
+
+///@cond
+#include <algorithm>
+#include <cmath>
+///@endcond
+
+namespace Geometry {
+
+	/* Below this many elements the hand-off to other threads costs more
+	 * than the conversion itself. */
+	static constexpr std::size_t serial = 1 << 14, grain = 1 << 12;
+
+	/* Every component but the largest is within 1/sqrt2 of zero. */
+	static constexpr float root = 0.70710678118654752f;
+
+	/* Rounds to the nearest integer in [-top, top]; truncation rounds once
+	 * the value is offset to be non-negative, without the library call
+	 * behind std::lround or a branch on the sign. */
+	static inline long quantize(float f, long top) {
+		f = std::min(float(top), std::max(-float(top), f));
+		return long(f + (top + .5f)) - top;
+	}
+
+	/* The smallest three at B bits each below the index m of the largest,
+	 * stored in the order m+1, m+2, m+3 (mod 4) so that neither direction
+	 * branches on m. Quantization is symmetric about zero so that zero,
+	 * and so the identity, survives exactly; the top code is unused. */
+	template<unsigned B>
+	static std::uint64_t pack(Quat_t<float> const& q) {
+		constexpr long half = (1l << (B-1)) - 1;
+		float c[4] = {q.w, q.x, q.y, q.z}, m2 = 0, top = 0;
+		unsigned m = 0;
+		for(unsigned i = 0; i < 4; i++) {
+			float a = std::abs(c[i]);
+			m2 += c[i] * c[i];
+			m = a > top ? i : m;
+			top = std::max(top, a);
+		}
+		// Zero packs as the identity
+		float s = m2 > 0 ? std::copysign(1 / std::sqrt(m2), c[m]) : 0;
+		std::uint64_t bits = m;
+		for(unsigned k = 1; k < 4; k++)
+			bits = bits << B | std::uint64_t(half
+				+ quantize(c[(m+k) & 3] * s * (half / root), half));
+		return bits;
+	}
+	template<unsigned B>
+	static Quat_t<float> unpack(std::uint64_t bits) {
+		constexpr long half = (1l << (B-1)) - 1;
+		constexpr std::uint64_t mask = (1ull << B) - 1;
+		constexpr float scale = root / half;
+		float e[4], sum = 0;
+		unsigned m = unsigned(bits >> 3*B) & 3;
+		for(unsigned k = 3; k > 0; k--, bits >>= B) {
+			e[k] = float(long(bits & mask) - half) * scale;
+			sum += e[k] * e[k];
+		}
+		e[0] = std::sqrt(std::max(0.f, 1 - sum));
+		return {e[(4-m) & 3], e[(5-m) & 3], e[(6-m) & 3], e[(7-m) & 3]};
+	}
+
+	Quat32::Quat32(Quat_t<float> const& q):
+		bits(std::uint32_t(pack<10>(q))) {}
+	Quat_t<float> Quat32::unpack(void) const {
+		return Geometry::unpack<10>(bits);
+	}
+
+	Quat48::Quat48(Quat_t<float> const& q) {
+		auto b = pack<15>(q);
+		bits[0] = std::uint16_t(b >> 32);
+		bits[1] = std::uint16_t(b >> 16);
+		bits[2] = std::uint16_t(b);
+	}
+	Quat_t<float> Quat48::unpack(void) const {
+		return Geometry::unpack<15>(std::uint64_t(bits[0]) << 32
+			| std::uint64_t(bits[1]) << 16 | bits[2]);
+	}
+
+	/* The translation 2 vec(v u*), as applied by transform(). */
+	static Vec_t<float> translation(DualQuat_t<float> const& dq) {
+		auto const &u = dq.u, &v = dq.v;
+		return {2 * (u.w*v.x - v.w*u.x + u.y*v.z - u.z*v.y),
+			2 * (u.w*v.y - v.w*u.y + u.z*v.x - u.x*v.z),
+			2 * (u.w*v.z - v.w*u.z + u.x*v.y - u.y*v.x)};
+	}
+
+	DualQuat96::DualQuat96(DualQuat_t<float> const& dq, float step):
+			u(dq.u) {
+		auto p = translation(dq);
+		float inv = 1 / step, c[3] = {p.x, p.y, p.z};
+		for(unsigned i = 0; i < 3; i++)
+			t[i] = std::int16_t(quantize(c[i] * inv, 32767));
+	}
+	DualQuat_t<float> DualQuat96::unpack(float step) const {
+		auto r = u.unpack();
+		float h = step / 2, x = t[0] * h, y = t[1] * h, z = t[2] * h;
+		// v = tr/2 expanded for the pure quaternion t
+		return {r, {-x*r.x - y*r.y - z*r.z, x*r.w + y*r.z - z*r.y,
+			y*r.w + z*r.x - x*r.z, z*r.w + x*r.y - y*r.x}};
+	}
+
+	float translation_step(DualQuat_t<float> const *src, std::size_t n) {
+		float top = 0;
+		for(std::size_t i = 0; i < n; i++) {
+			auto p = translation(src[i]);
+			top = std::max(top, std::max(std::abs(p.x),
+					std::max(std::abs(p.y), std::abs(p.z))));
+		}
+		// Without any translation, every step is exact
+		return top > 0 ? top / 32767 : 1;
+	}
+
+	/* Applies f to each index, across the shared pool when n is large. */
+	template<typename F>
+	static void each(std::size_t n, F const& f) {
+		auto run = [&] (std::size_t i0, std::size_t i1) {
+			for(auto i = i0; i < i1; i++) f(i);
+		};
+		if(n < serial) return run(0, n);
+		Abstract::Pool::shared().parallel(n, grain, run);
+	}
+
+	void encode(Quat_t<float> const *src, Quat32 *dest, std::size_t n) {
+		each(n, [=] (std::size_t i) { dest[i] = Quat32(src[i]); });
+	}
+	void encode(Quat_t<float> const *src, Quat48 *dest, std::size_t n) {
+		each(n, [=] (std::size_t i) { dest[i] = Quat48(src[i]); });
+	}
+	void encode(DualQuat_t<float> const *src, DualQuat96 *dest,
+			std::size_t n, float step) {
+		each(n, [=] (std::size_t i) { dest[i] = DualQuat96(src[i], step); });
+	}
+	void decode(Quat32 const *src, Quat_t<float> *dest, std::size_t n) {
+		each(n, [=] (std::size_t i) { dest[i] = src[i].unpack(); });
+	}
+	void decode(Quat48 const *src, Quat_t<float> *dest, std::size_t n) {
+		each(n, [=] (std::size_t i) { dest[i] = src[i].unpack(); });
+	}
+	void decode(DualQuat96 const *src, DualQuat_t<float> *dest,
+			std::size_t n, float step) {
+		each(n, [=] (std::size_t i) { dest[i] = src[i].unpack(step); });
+	}
+}
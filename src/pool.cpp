@@ -0,0 +1,105 @@
+/*! @file src/pool.cpp
+ *  @brief Implementation of the thread pool declared in pool.hpp */
+
+#include "pool.hpp"
+
+///@cond
+#include <algorithm>
+///@endcond
+
+namespace Abstract {
+	/* Set while the current thread is running a task, so nested calls to
+	 * parallel run inline instead of waiting on their own pool. */
+	static thread_local bool t_busy = false;
+
+	Pool& Pool::shared(void) {
+		static Pool pool;
+		return pool;
+	}
+
+	unsigned Pool::size(void) const {
+		return m_workers.size() + 1;
+	}
+
+	/* Job fields are only written while no worker is registered as active,
+	 * and workers register under the lock, so step never sees a job that
+	 * is being replaced. */
+	bool Pool::step(void) {
+		auto i = m_next.fetch_add(1);
+		if(i >= m_chunks) return false;
+		auto first = i * m_chunk, last = std::min(m_count, first + m_chunk);
+		(*m_task)(first, last);
+		if(m_left.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_done.notify_all();
+		}
+		return true;
+	}
+
+	void Pool::work(void) {
+		t_busy = true;
+		unsigned seen = 0;
+		std::unique_lock<std::mutex> lock(m_lock);
+		while(true) {
+			m_wake.wait(lock, [&] {
+				return m_quit || seen != m_generation;
+			});
+			if(m_quit) return;
+			seen = m_generation;
+			m_active++;
+			lock.unlock();
+			while(step());
+			lock.lock();
+			if(!--m_active) m_done.notify_all();
+		}
+	}
+
+	void Pool::parallel(std::size_t n, std::size_t grain, Task const& task) {
+		if(!n) return;
+		grain = std::max<std::size_t>(grain, 1);
+		// About four chunks per thread evens out uneven progress
+		auto per = (n + grain * size() * 4 - 1) / (grain * size() * 4),
+			 chunk = grain * std::max<std::size_t>(per, 1),
+			 chunks = (n + chunk - 1) / chunk;
+		if(t_busy || chunks < 2 || m_workers.empty())
+			return task(0, n);
+
+		std::lock_guard<std::mutex> submit(m_submit);
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+			m_done.wait(lock, [&] { return !m_active; });
+			m_task = &task;
+			m_count = n;
+			m_chunk = chunk;
+			m_chunks = chunks;
+			m_left = chunks;
+			m_next = 0;
+			m_generation++;
+		}
+		m_wake.notify_all();
+
+		t_busy = true;
+		while(step());
+		t_busy = false;
+
+		std::unique_lock<std::mutex> lock(m_lock);
+		m_done.wait(lock, [&] { return !m_left && !m_active; });
+		m_chunks = 0;
+		m_task = nullptr;
+	}
+
+	Pool::Pool(unsigned threads) {
+		if(!threads) threads = std::max(std::thread::hardware_concurrency(), 1u);
+		for(unsigned i = 1; i < threads; i++)
+			m_workers.emplace_back(&Pool::work, this);
+	}
+
+	Pool::~Pool(void) {
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_quit = true;
+		}
+		m_wake.notify_all();
+		for(auto &w : m_workers) w.join();
+	}
+}
@@ -0,0 +1,184 @@
+/*! @file src/queue.cpp
+ *  @brief Implementation of the render queue from queue.hpp */
+
+#include "queue.hpp"
+#include "state.hpp"
+
+///@cond
+#include <algorithm>
+///@endcond
+
+namespace View {
+	using std::uint64_t;
+	using std::uint32_t;
+
+	constexpr unsigned RenderQueue::program_bits, RenderQueue::vao_bits,
+		RenderQueue::material_bits, RenderQueue::depth_bits;
+
+	/* The layout of one glMultiDrawElementsIndirect command. */
+	struct Command {
+		GLuint count, instances, first, base, instance;
+	};
+
+	static GLsizeiptr index_size(GLenum type) {
+		return type == GL_UNSIGNED_BYTE ? 1
+			: type == GL_UNSIGNED_SHORT ? 2 : 4;
+	}
+
+	/* Issues one item on its own. */
+	static void draw(RenderQueue::Item const& item) {
+		auto offset = reinterpret_cast<const void*>(item.offset);
+		if(item.instances == 1)
+			glDrawElementsBaseVertex(item.mode, item.count, item.type, offset,
+				item.base);
+		else glDrawElementsInstancedBaseVertex(item.mode, item.count,
+				item.type, offset, item.instances, item.base);
+	}
+
+	uint64_t RenderQueue::key(Item const& item) {
+		auto field = [] (uint64_t value, unsigned bits) {
+			return value & ((uint64_t(1) << bits) - 1);
+		};
+		// In float, depths within an ulp of 1 would round up to 2^24 and
+		// carry into the material
+		auto scale = double((uint32_t(1) << depth_bits) - 1);
+		auto depth = uint64_t(std::min(std::max(double(item.depth), 0.),
+				1.) * scale + .5);
+		return field(item.program, program_bits)
+				<< (vao_bits + material_bits + depth_bits)
+			| field(item.vao, vao_bits) << (material_bits + depth_bits)
+			| field(item.material, material_bits) << depth_bits
+			| depth;
+	}
+
+	void RenderQueue::material(Bind bind) { m_bind = std::move(bind); }
+
+	void RenderQueue::push(Item const& item) {
+		m_order.push_back({key(item), uint32_t(m_items.size())});
+		m_items.push_back(item);
+	}
+
+	std::size_t RenderQueue::size(void) const { return m_items.size(); }
+
+	void RenderQueue::clear(void) {
+		m_items.clear();
+		m_order.clear();
+	}
+
+	unsigned RenderQueue::switches(void) const { return m_switches; }
+
+	bool RenderQueue::indirect(void) {
+		if(m_indirect < 0)
+			m_indirect = supports(4, 3, "GL_ARB_multi_draw_indirect");
+		return m_indirect;
+	}
+
+	void RenderQueue::sort(void) {
+		auto n = m_order.size();
+		if(n < 2) return;
+		// One histogram per byte, all counted in one pass
+		std::size_t counts[8][256] = {};
+		for(auto const& e : m_order)
+			for(unsigned b = 0; b < 8; b++)
+				counts[b][(e.key >> (b * 8)) & 0xff]++;
+		m_swap.resize(n);
+		for(unsigned b = 0; b < 8; b++) {
+			auto &count = counts[b];
+			// A byte shared by every key leaves the order as it is
+			if(count[(m_order[0].key >> (b * 8)) & 0xff] == n) continue;
+			std::size_t sum = 0;
+			for(auto &c : count) {
+				auto t = c;
+				c = sum;
+				sum += t;
+			}
+			for(auto const& e : m_order)
+				m_swap[count[(e.key >> (b * 8)) & 0xff]++] = e;
+			std::swap(m_order, m_swap);
+		}
+	}
+
+	unsigned RenderQueue::run(std::size_t first, std::size_t last) {
+		auto const& head = m_items[m_order[first].index];
+		auto n = last - first;
+		if(n == 1) {
+			draw(head);
+			return 1;
+		}
+		if(indirect()) {
+			auto slice = m_commands.allocate(n, sizeof(Command));
+			if(slice) {
+				auto commands = static_cast<Command*>(slice.data);
+				auto size = index_size(head.type);
+				for(std::size_t i = 0; i < n; i++) {
+					auto const& item = m_items[m_order[first + i].index];
+					commands[i] = {GLuint(item.count), GLuint(item.instances),
+						GLuint(item.offset / size), GLuint(item.base), 0};
+				}
+				if(m_commands.commit(slice)) {
+					State::current().buffer(GL_DRAW_INDIRECT_BUFFER,
+						m_commands.vbo());
+					glMultiDrawElementsIndirect(head.mode, head.type,
+						reinterpret_cast<const void*>(slice.offset),
+						GLsizei(n), 0);
+					return 1;
+				}
+			}
+		}
+		m_counts.clear();
+		m_offsets.clear();
+		m_bases.clear();
+		unsigned calls = 0;
+		for(auto i = first; i < last; i++) {
+			auto const& item = m_items[m_order[i].index];
+			// Direct multi-draw has no instance counts
+			if(item.instances != 1) {
+				draw(item);
+				calls++;
+				continue;
+			}
+			m_counts.push_back(item.count);
+			m_offsets.push_back(reinterpret_cast<const void*>(item.offset));
+			m_bases.push_back(item.base);
+		}
+		if(m_counts.empty()) return calls;
+		glMultiDrawElementsBaseVertex(head.mode, m_counts.data(), head.type,
+			m_offsets.data(), GLsizei(m_counts.size()), m_bases.data());
+		return calls + 1;
+	}
+
+	unsigned RenderQueue::submit(void) {
+		auto &state = State::current();
+		unsigned draws = 0;
+		m_switches = 0;
+		sort();
+		auto n = m_order.size();
+		Item const *bound = nullptr;
+		for(std::size_t first = 0, last; first < n; first = last) {
+			auto const& head = m_items[m_order[first].index];
+			for(last = first + 1; last < n; last++) {
+				auto const& item = m_items[m_order[last].index];
+				if(item.program != head.program || item.vao != head.vao
+						|| item.material != head.material
+						|| item.mode != head.mode || item.type != head.type)
+					break;
+			}
+			// The shadow also drops binds left over from before the submit
+			bool program = state.program(head.program),
+				vao = state.vao(head.vao);
+			if(m_bind && (program || vao || !bound
+					|| bound->material != head.material))
+				m_bind(head.material);
+			m_switches += program + vao;
+			bound = &head;
+			draws += run(first, last);
+		}
+		if(n && indirect()) m_commands.fence();
+		clear();
+		return draws;
+	}
+
+	RenderQueue::RenderQueue(std::size_t commands):
+		m_commands(GLsizeiptr(StreamBuffer::frames * commands
+				* sizeof(Command))) {}
+}
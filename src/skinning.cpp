@@ -0,0 +1,137 @@
+/*! @file src/skinning.cpp
+ *  @brief Implementation of the skinning kernels from skinning.hpp */
+
+#include "skinning.hpp"
+#include "pool.hpp"
+
+///@cond
+#include <algorithm>
+///@endcond
+
+namespace Model {
+	using Geometry::Simd::Lane;
+	namespace Simd = Geometry::Simd;
+
+	std::size_t Skin::size(void) const {
+		return positions.size();
+	}
+	void Skin::resize(std::size_t n) {
+		positions.resize(n);
+		normals.resize(n);
+		for(unsigned k = 0; k < influences; k++) {
+			bones[k].resize(Simd::padded(n), 0);
+			weights[k].resize(Simd::padded(n), 0.f);
+			std::fill(weights[k].begin() + n, weights[k].end(), 0.f);
+		}
+	}
+	void Skin::set(std::size_t i, Vec_t<float> const& p,
+			Vec_t<float> const& n, unsigned const *b,
+			float const *w, unsigned count) {
+		positions.set(i, p);
+		normals.set(i, n);
+		for(unsigned k = 0; k < influences; k++) {
+			bool used = k < count;
+			bones[k][i] = used ? b[k] : 0;
+			weights[k][i] = used ? w[k] : 0.f;
+		}
+	}
+	Skin::Skin(std::size_t n) { resize(n); }
+
+	/* A lane of dual quaternions, component-wise. */
+	struct DualLane {
+		Lane uw, ux, uy, uz, vw, vx, vy, vz;
+	};
+
+	/* Bones are scattered, so each lane is filled through aligned scratch;
+	 * AVX has no float gather and the loads stay in cache either way. */
+	static DualLane gather(DualQuat_t<float> const *bones,
+			unsigned const *index) {
+		alignas(SIMD_ALIGN) float c[8][Lane::N];
+		for(unsigned j = 0; j < Lane::N; j++) {
+			auto const& b = bones[index[j]];
+			c[0][j] = b.u.w; c[1][j] = b.u.x; c[2][j] = b.u.y; c[3][j] = b.u.z;
+			c[4][j] = b.v.w; c[5][j] = b.v.x; c[6][j] = b.v.y; c[7][j] = b.v.z;
+		}
+		return {Lane::load(c[0]), Lane::load(c[1]), Lane::load(c[2]),
+			Lane::load(c[3]), Lane::load(c[4]), Lane::load(c[5]),
+			Lane::load(c[6]), Lane::load(c[7])};
+	}
+
+	static void accumulate(DualLane &acc, DualLane const& b, Lane w) {
+		acc.uw = mul_add(w, b.uw, acc.uw); acc.ux = mul_add(w, b.ux, acc.ux);
+		acc.uy = mul_add(w, b.uy, acc.uy); acc.uz = mul_add(w, b.uz, acc.uz);
+		acc.vw = mul_add(w, b.vw, acc.vw); acc.vx = mul_add(w, b.vx, acc.vx);
+		acc.vy = mul_add(w, b.vy, acc.vy); acc.vz = mul_add(w, b.vz, acc.vz);
+	}
+
+	static void skin(Skin const& s, DualQuat_t<float> const *bones,
+			VecBatch& positions, VecBatch& normals,
+			std::size_t first, std::size_t last) {
+		auto zero = Lane::broadcast(0), one = Lane::broadcast(1);
+		for(auto i = first; i < last; i += Lane::N) {
+			auto q0 = gather(bones, &s.bones[0][i]);
+			auto w0 = Lane::load(&s.weights[0][i]);
+			DualLane b = {w0*q0.uw, w0*q0.ux, w0*q0.uy, w0*q0.uz,
+				w0*q0.vw, w0*q0.vx, w0*q0.vy, w0*q0.vz};
+			for(unsigned k = 1; k < Skin::influences; k++) {
+				auto qk = gather(bones, &s.bones[k][i]);
+				auto wk = Lane::load(&s.weights[k][i]),
+					 d = q0.uw*qk.uw + q0.ux*qk.ux + q0.uy*qk.uy + q0.uz*qk.uz;
+				accumulate(b, qk, select(d < zero, -wk, wk));
+			}
+			auto len = sqrt(b.uw*b.uw + b.ux*b.ux + b.uy*b.uy + b.uz*b.uz),
+				 inv = select(len > zero, one / len, zero);
+			b = {b.uw*inv, b.ux*inv, b.uy*inv, b.uz*inv,
+				b.vw*inv, b.vx*inv, b.vy*inv, b.vz*inv};
+
+			auto px = Lane::load(&s.positions.x[i]),
+				 py = Lane::load(&s.positions.y[i]),
+				 pz = Lane::load(&s.positions.z[i]),
+				 nx = Lane::load(&s.normals.x[i]),
+				 ny = Lane::load(&s.normals.y[i]),
+				 nz = Lane::load(&s.normals.z[i]);
+			// The same kernels as the batch transform() and rotate()
+			Geometry::transform(b.uw, b.ux, b.uy, b.uz, b.vw, b.vx, b.vy,
+				b.vz, px, py, pz);
+			Geometry::rotate(b.uw, b.ux, b.uy, b.uz, nx, ny, nz);
+
+			px.store(&positions.x[i]);
+			py.store(&positions.y[i]);
+			pz.store(&positions.z[i]);
+			nx.store(&normals.x[i]);
+			ny.store(&normals.y[i]);
+			nz.store(&normals.z[i]);
+		}
+	}
+
+	void skin(SkinJob const *jobs, std::size_t count) {
+		/* Blocks of every job are numbered consecutively so that many
+		 * small meshes spread across threads as well as one large one. */
+		std::vector<std::size_t> offsets(count + 1, 0);
+		for(std::size_t j = 0; j < count; j++) {
+			auto n = jobs[j].skin -> size();
+			jobs[j].positions -> resize(n);
+			jobs[j].normals -> resize(n);
+			offsets[j+1] = offsets[j] + Simd::padded(n) / Simd::block;
+		}
+		Abstract::Pool::shared().parallel(offsets.back(), 64,
+			[&] (std::size_t b0, std::size_t b1) {
+				auto j = std::upper_bound(offsets.begin(), offsets.end(), b0)
+					- offsets.begin() - 1;
+				for(; b0 < b1; j++) {
+					auto end = std::min(b1, offsets[j+1]);
+					auto const& job = jobs[j];
+					skin(*job.skin, job.bones, *job.positions, *job.normals,
+						(b0 - offsets[j]) * Simd::block,
+						(end - offsets[j]) * Simd::block);
+					b0 = end;
+				}
+			});
+	}
+
+	void skin(Skin const& s, DualQuat_t<float> const *bones,
+			VecBatch& positions, VecBatch& normals) {
+		SkinJob job = {&s, bones, &positions, &normals};
+		skin(&job, 1);
+	}
+}
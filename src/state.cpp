@@ -0,0 +1,142 @@
+/*! @file src/state.cpp
+ *  @brief Implementation of the state shadow from state.hpp */
+
+#include "state.hpp"
+
+///@cond
+#include <algorithm>
+///@endcond
+
+namespace View {
+	constexpr unsigned State::units, State::blocks, State::buffers,
+		State::textures;
+	constexpr GLuint State::unknown;
+
+	/* The slot of a tracked buffer target, or -1 */
+	static int buffer_slot(GLenum target) {
+		static const GLenum targets[] = {GL_ARRAY_BUFFER,
+			GL_ELEMENT_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_PIXEL_PACK_BUFFER,
+			GL_PIXEL_UNPACK_BUFFER, GL_DRAW_INDIRECT_BUFFER,
+			GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER};
+		auto it = std::find(std::begin(targets), std::end(targets), target);
+		return it == std::end(targets) ? -1 : int(it - targets);
+	}
+	/* The slot of a tracked texture target, or -1 */
+	static int texture_slot(GLenum target) {
+		static const GLenum targets[] = {GL_TEXTURE_1D, GL_TEXTURE_2D,
+			GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY,
+			GL_TEXTURE_RECTANGLE, GL_TEXTURE_BUFFER};
+		auto it = std::find(std::begin(targets), std::end(targets), target);
+		return it == std::end(targets) ? -1 : int(it - targets);
+	}
+
+	State& State::current(void) {
+		static thread_local State state;
+		return state;
+	}
+
+	State::Counters const& State::counters(void) const { return m_counters; }
+
+	State::Counters State::frame(void) {
+		auto out = m_counters;
+		m_counters = {};
+		return out;
+	}
+
+	void State::invalidate(void) {
+		m_program = m_vao = m_unit = unknown;
+		std::fill(std::begin(m_buffers), std::end(m_buffers), unknown);
+		std::fill(std::begin(m_ranges), std::end(m_ranges),
+				Range{unknown, 0, 0});
+		for(auto &unit : m_textures)
+			std::fill(std::begin(unit), std::end(unit), unknown);
+		m_caps.clear();
+		m_counters = {};
+	}
+
+	bool State::count(bool changed) {
+		if(changed) m_counters.issued++;
+		else m_counters.filtered++;
+		return changed;
+	}
+
+	bool State::program(GLuint id) {
+		if(!count(m_program != id)) return false;
+		glUseProgram(m_program = id);
+		return true;
+	}
+
+	bool State::vao(GLuint id) {
+		if(!count(m_vao != id)) return false;
+		glBindVertexArray(m_vao = id);
+		m_buffers[buffer_slot(GL_ELEMENT_ARRAY_BUFFER)] = unknown;
+		return true;
+	}
+
+	bool State::buffer(GLenum target, GLuint id) {
+		auto slot = buffer_slot(target);
+		if(slot < 0) {
+			glBindBuffer(target, id);
+			return count(true);
+		}
+		if(!count(m_buffers[slot] != id)) return false;
+		glBindBuffer(target, m_buffers[slot] = id);
+		return true;
+	}
+
+	bool State::range(GLenum target, GLuint index, GLuint id,
+			GLintptr offset, GLsizeiptr size) {
+		bool tracked = target == GL_UNIFORM_BUFFER && index < blocks;
+		if(tracked) {
+			auto &r = m_ranges[index];
+			if(!count(r.id != id || r.offset != offset || r.size != size))
+				return false;
+			r = {id, offset, size};
+		} else count(true);
+		glBindBufferRange(target, index, id, offset, size);
+		auto slot = buffer_slot(target);
+		if(slot >= 0) m_buffers[slot] = id;
+		return true;
+	}
+
+	bool State::texture(unsigned unit, GLenum target, GLuint id) {
+		auto slot = texture_slot(target);
+		bool tracked = slot >= 0 && unit < units;
+		if(tracked && !count(m_textures[unit][slot] != id)) return false;
+		if(count(m_unit != unit))
+			glActiveTexture(GLenum(unsigned(GL_TEXTURE0) + (m_unit = unit)));
+		glBindTexture(target, id);
+		if(tracked) m_textures[unit][slot] = id;
+		else count(true);
+		return true;
+	}
+
+	bool State::enable(GLenum cap, bool on) {
+		auto it = m_caps.find(cap);
+		if(!count(it == m_caps.end() || it -> second != on)) return false;
+		if(on) glEnable(cap);
+		else glDisable(cap);
+		m_caps[cap] = on;
+		return true;
+	}
+
+	void State::forget_program(GLuint id) {
+		if(m_program == id) m_program = unknown;
+	}
+	void State::forget_vao(GLuint id) {
+		if(m_vao == id) m_vao = unknown;
+	}
+	void State::forget_buffer(GLuint id) {
+		for(auto &b : m_buffers)
+			if(b == id) b = unknown;
+		for(auto &r : m_ranges)
+			if(r.id == id) r.id = unknown;
+	}
+	void State::forget_texture(GLuint id) {
+		for(auto &unit : m_textures)
+			for(auto &t : unit)
+				if(t == id) t = unknown;
+	}
+
+	State::State(void) { invalidate(); }
+}
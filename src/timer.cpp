@@ -0,0 +1,118 @@
+/*! @file src/timer.cpp
+ *  @brief Implementation of the GPU timer from timer.hpp */
+
+#include "timer.hpp"
+
+namespace View {
+	constexpr unsigned GpuTimer::frames, GpuTimer::passes;
+
+	static double millis(GLuint64 from, GLuint64 to) {
+		return to > from ? (to - from) / 1e6 : 0;
+	}
+
+	bool GpuTimer::collect(Slot &slot) {
+		// Queries complete in order, so the stop is the last to be ready
+		GLint available = 0;
+		glGetQueryObjectiv(slot.queries[1], GL_QUERY_RESULT_AVAILABLE,
+				&available);
+		if(!available) return false;
+		GLuint64 stamps[2 + 2 * passes];
+		for(unsigned i = 0; i < 2 + 2 * slot.count; i++)
+			glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT,
+					&stamps[i]);
+		m_last = millis(stamps[0], stamps[1]);
+		m_timings.clear();
+		for(unsigned i = 0; i < slot.count; i++)
+			m_timings.emplace_back(slot.names[i],
+				millis(stamps[2 + 2 * i], stamps[3 + 2 * i]));
+		m_samples.push_back(m_last);
+		m_sum += m_last;
+		while(m_samples.size() > m_max) {
+			m_sum -= m_samples.front();
+			m_samples.pop_front();
+		}
+		m_collected++;
+		slot.pending = false;
+		return true;
+	}
+
+	void GpuTimer::start(void) {
+		if(m_started) return;
+		if(!m_created) {
+			for(auto &slot : m_slots)
+				glGenQueries(2 + 2 * passes, slot.queries);
+			m_created = true;
+		}
+		// Oldest first; a frame still in flight holds back the newer ones
+		for(unsigned i = 0; i < frames; i++) {
+			auto &slot = m_slots[(m_frame + i) % frames];
+			if(slot.pending && !collect(slot)) break;
+		}
+		auto &slot = m_slots[m_frame];
+		if(slot.pending) {
+			slot.pending = false;
+			m_dropped++;
+		}
+		slot.count = slot.depth = slot.overflow = 0;
+		glQueryCounter(slot.queries[0], GL_TIMESTAMP);
+		m_started = true;
+	}
+
+	void GpuTimer::begin(const char *name) {
+		if(!m_started) return;
+		auto &slot = m_slots[m_frame];
+		if(slot.depth == passes) {
+			slot.overflow++;
+			return;
+		}
+		if(slot.count == passes) {
+			slot.open[slot.depth++] = passes;
+			return;
+		}
+		slot.names[slot.count] = name;
+		glQueryCounter(slot.queries[2 + 2 * slot.count], GL_TIMESTAMP);
+		slot.open[slot.depth++] = slot.count++;
+	}
+
+	void GpuTimer::end(void) {
+		if(!m_started) return;
+		auto &slot = m_slots[m_frame];
+		if(slot.overflow) {
+			slot.overflow--;
+			return;
+		}
+		if(!slot.depth) return;
+		auto pass = slot.open[--slot.depth];
+		if(pass < passes)
+			glQueryCounter(slot.queries[3 + 2 * pass], GL_TIMESTAMP);
+	}
+
+	void GpuTimer::stop(void) {
+		if(!m_started) return;
+		auto &slot = m_slots[m_frame];
+		slot.overflow = 0;
+		while(slot.depth) end();
+		glQueryCounter(slot.queries[1], GL_TIMESTAMP);
+		slot.pending = true;
+		m_frame = (m_frame + 1) % frames;
+		m_started = false;
+	}
+
+	double GpuTimer::last(void) const { return m_last; }
+	double GpuTimer::average(void) const {
+		return m_samples.size() ? m_sum / m_samples.size() : 0;
+	}
+	std::vector<std::pair<const char*, double>> const&
+	GpuTimer::timings(void) const { return m_timings; }
+	unsigned GpuTimer::collected(void) const { return m_collected; }
+	unsigned GpuTimer::dropped(void) const { return m_dropped; }
+
+	GpuTimer::GpuTimer(unsigned max_samples):
+		m_max(max_samples ? max_samples : 1) {}
+
+	GpuTimer::~GpuTimer(void) {
+		if(!m_created) return;
+		for(auto &slot : m_slots)
+			glDeleteQueries(2 + 2 * passes, slot.queries);
+	}
+}
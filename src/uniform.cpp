@@ -0,0 +1,48 @@
+/*! @file src/uniform.cpp
+ *  @brief Implementation of the uniform buffers from uniform.hpp */
+
+#include "uniform.hpp"
+#include "state.hpp"
+
+namespace View {
+	GLsizeiptr UniformBuffer::alignment(void) {
+		if(!m_alignment) {
+			GLint align = 0;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+			// The limit is at most 256, so this is only a guard
+			m_alignment = align > 0 ? align : 256;
+		}
+		return m_alignment;
+	}
+
+	UniformBuffer::Blocks UniformBuffer::allocate(std::size_t count,
+			GLsizeiptr size) {
+		Blocks blocks;
+		if(!count || size <= 0) return blocks;
+		auto align = alignment(),
+			stride = (size + align - 1) / align * align;
+		// The stream aligns slices to the stride, a multiple of the limit
+		blocks.slice = m_stream.allocate(count, GLsizei(stride));
+		if(!blocks.slice) return blocks;
+		blocks.size = size;
+		blocks.stride = stride;
+		blocks.count = count;
+		return blocks;
+	}
+
+	bool UniformBuffer::commit(Blocks &blocks) {
+		return m_stream.commit(blocks.slice);
+	}
+
+	void UniformBuffer::bind(GLuint binding, Blocks const& blocks,
+			std::size_t i) {
+		if(i >= blocks.count) return;
+		State::current().range(GL_UNIFORM_BUFFER, binding, m_stream.vbo(),
+			blocks.slice.offset + i * blocks.stride, blocks.size);
+	}
+
+	void UniformBuffer::fence(void) { m_stream.fence(); }
+
+	UniformBuffer::UniformBuffer(GLsizeiptr capacity):
+		m_stream(capacity) {}
+}
@@ -3,8 +3,12 @@
 
 #include "window.hpp"
 #include "view.hpp"
+#include "culling.hpp"
+#include "glsl.hpp"
 
 ///@cond
+#include <algorithm>
+#include <cstring>
 #include <SDL.h>
 #include <glbinding/Binding.h>
 #include <glbinding/ContextInfo.h>
@@ -34,13 +38,39 @@ FSignal Window::validate(void) {
 	return m_live;
 }
 
+void Window::pick(int x, int y, unsigned w, unsigned h,
+		Geometry::Hit *hits) const {
+	std::fill(hits, hits + w * h, Geometry::Hit{});
+	if (!m_scene || !m_width || !m_height || !m_invertible) return;
+	// Rays through pixel centers, rows adjacent so packets stay coherent;
+	// a batch on the stack spares the allocation of every mouse motion
+	static constexpr std::size_t batch = 64;
+	Geometry::Ray rays[batch];
+	std::size_t n = std::size_t(w) * h;
+	for (std::size_t first = 0; first < n; first += batch) {
+		auto count = std::min(batch, n - first);
+		for (std::size_t k = 0; k < count; k++) {
+			auto i = unsigned((first + k) % w), j = unsigned((first + k) / w);
+			rays[k] = Geometry::unproject(m_unproject,
+				2 * (x + i + .5f) / m_width - 1,
+				1 - 2 * (y + j + .5f) / m_height);
+		}
+		m_scene -> intersect(rays, hits + first, count);
+	}
+}
+
 template <>
 FSignal Window::handle(SDL_MouseMotionEvent const& ev) {
+	if (!m_live) return m_live;
+	pick(ev.x, ev.y, 1, 1, &m_hover);
 	return m_live;
 }
 
 template <>
 FSignal Window::handle(SDL_MouseButtonEvent const& ev) {
+	if (!m_live) return m_live;
+	if (ev.type == SDL_MOUSEBUTTONDOWN)
+		pick(ev.x, ev.y, 1, 1, &m_pick);
 	return m_live;
 }
 
@@ -84,22 +114,34 @@ FSignal Window::update(unsigned frame) {
 	}
 	return validate();
 }
-FSignal Window::draw(unsigned frame, GLint id_mvp) {
-	static constexpr unsigned mspf60 = 100 / 6 + 1;
+StreamBuffer& Window::stream(void) { return m_stream; }
+bool Window::swap_interval(int interval) {
+	bool set = !SDL_GL_SetSwapInterval(interval)
+		|| (interval < 0 && !SDL_GL_SetSwapInterval(1));
+	m_pacer.external(SDL_GL_GetSwapInterval() != 0);
+	return set;
+}
+FSignal Window::draw(unsigned frame) {
 	if (!m_live) return m_live;
-	if (id_mvp == -1) return m_live = {FSignal::Code::err};
 	if (!update(frame)) return m_live;
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	int l_width = 0, l_height = 0;
 	SDL_GetWindowSize(m_win, &l_width, &l_height);
 	if (l_width <= 0 || l_height <= 0) {
 		return m_live = {FSignal::Code::err};
 	}
+	// Headless frames go to a framebuffer the size of the window
+	if (m_headless && !m_target.bind(l_width, l_height))
+		return m_live = {FSignal::Code::err, "Incomplete framebuffer"};
 	glViewport(0, 0, l_width, l_height);
 	m_width = l_width;
 	m_height = l_height;
 
+	m_gpu.start();
+	m_gpu.begin("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	m_gpu.end();
+
 	// FOVy is fixed; FOVx compensates for aspect ratio
 	float asp = float(m_width) / m_height, x0 = -asp, x1 = asp, dx = x1 - x0,
 		y0 = -1, y1 = 1, dy = y1 - y0, z0 = 1, z1 = 10, dz = z0 - z1,
@@ -116,36 +158,67 @@ FSignal Window::draw(unsigned frame, GLint id_mvp) {
 			+1,  +1,  -2,  +1,
 			-1,  +1,  -2,  +1
 		};
-	static unsigned indices[] = {0, 1, 2, 0, 3, 2};
-
-	/* From app/release.cpp */
-	// TODO Move to sub
-	static bool once = false;
-	static GLuint vbo = 0, vao = 0;
-	if (!once) {
-		once = true;
-		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
-
-		glGenBuffers(1, &vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof vertices, vertices,
-			GL_DYNAMIC_DRAW);
-
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, NULL);
+
+	// Only geometry whose bounds reach the frustum is submitted
+	Geometry::Matrix_t<float> proj;
+	std::copy(mvp, mvp + 16, proj.data);
+	m_mvp = proj;
+	m_unproject = proj.inverse(&m_invertible);
+	Geometry::Vec_t<float> lo = {vertices[0], vertices[1], vertices[2]},
+		hi = lo;
+	for (unsigned i = 4; i < sizeof vertices / sizeof *vertices; i += 4) {
+		lo = {std::min(lo.x, vertices[i]), std::min(lo.y, vertices[i+1]),
+			std::min(lo.z, vertices[i+2])};
+		hi = {std::max(hi.x, vertices[i]), std::max(hi.y, vertices[i+1]),
+			std::max(hi.z, vertices[i+2])};
 	}
-	glUniformMatrix4fv(id_mvp, 1, GL_FALSE, mvp);
-	glBindVertexArray(vao);
+	bool visible = Geometry::Frustum(proj).visible(lo, hi);
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, NULL);
-	glBindVertexArray(vao);
-	glDrawElements(GL_TRIANGLES, sizeof indices, GL_UNSIGNED_INT, indices);
-	glDisableVertexAttribArray(0);
+	// The quad is streamed every frame, as dynamic geometry would be
+	auto slice = m_stream.allocate(4, 4 * sizeof(float));
+	bool streamed = bool(slice);
+	if (streamed) {
+		std::memcpy(slice.data, vertices, sizeof vertices);
+		streamed = m_stream.commit(slice);
+	}
+	// Camera data is written once per frame, for every program to share
+	static const GLuint frame_binding = Shaders::blockBinding("Frame"),
+		object_binding = Shaders::blockBinding("Object");
+	FrameBlock camera;
+	std::copy(mvp, mvp + 16, camera.mvp);
+	ObjectBlock object = {{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+	auto frame_block = m_uniforms.push(camera),
+		object_block = m_uniforms.push(object);
+	m_uniforms.bind(frame_binding, frame_block);
+	m_uniforms.bind(object_binding, object_block);
+	m_gpu.begin("scene");
+	// The indices were uploaded with the stream's attributes
+	if (m_program && visible && streamed && frame_block && object_block) {
+		RenderQueue::Item quad;
+		quad.program = m_program;
+		quad.vao = m_stream.vao();
+		// Window depth of the quad's plane, which has w = -z
+		quad.depth = ((mz * vertices[2] + tz) / -vertices[2] + 1) / 2;
+		quad.count = 6;
+		quad.base = slice.first;
+		m_queue.push(quad);
+	}
+	if (frame_block && m_draw) m_draw();
+	m_queue.submit();
+	m_gpu.end();
+	m_stream.fence();
+	m_uniforms.fence();
 
-	SDL_GL_SwapWindow(m_win);
-	SDL_Delay(mspf60);
+	if (m_headless || m_record) {
+		// Without a target, this reads the back buffer before the swap
+		m_gpu.begin("readback");
+		m_readback.read(m_width, m_height);
+		m_gpu.end();
+	}
+	m_gpu.stop();
+	if (!m_headless) SDL_GL_SwapWindow(m_win);
+	m_calls = State::current().frame();
+	m_pacer.end();
 	return m_live;
 }
 
@@ -171,10 +244,11 @@ Window::Window(const char* title, int w, int h, Uint32 flags,
 		int i = 0;
 		for (auto const& attr : attribs)
 			SDL_GL_SetAttribute(attr.first, attr.second);
+		m_headless = flags & SDL_WINDOW_HIDDEN;
 		m_win = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED,
 				SDL_WINDOWPOS_CENTERED, w, h,
-				flags | SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN |
-						SDL_WINDOW_RESIZABLE);
+				flags | SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE |
+						(m_headless ? 0 : SDL_WINDOW_SHOWN));
 		if (m_errors() || !m_win) {
 			m_live = {err, "SDL window could not be created."};
 			//m_errors.emplace_back("SDL window could not be created.");
@@ -191,6 +265,10 @@ Window::Window(const char* title, int w, int h, Uint32 flags,
 		m_width = l_width;
 		m_height = l_height;
 		SDL_GL_MakeCurrent(m_win, m_ctx);
+		// The shadow may hold the state of another context
+		State::current().invalidate();
+		// Drivers differ in whether the swap waits for vsync by default
+		m_pacer.external(SDL_GL_GetSwapInterval() != 0);
 		Binding::initialize(false);
 		for (auto const& attr : attribs) {
 			i++;
@@ -205,6 +283,10 @@ Window::Window(const char* title, int w, int h, Uint32 flags,
 				break;
 			}
 		}
+		m_stream.attribute(0, 4, GL_FLOAT, 4 * sizeof(float));
+		// Core contexts draw indices from a buffer, never client memory
+		static const GLuint indices[] = {0, 1, 2, 0, 3, 2};
+		m_stream.elements(indices, sizeof indices / sizeof *indices);
 		m_live = {FSignal::Code::ok};
 		return;
 	} while (0);